@@ -26,7 +26,10 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <algorithm>
+#include <map>
 #include <sstream>
+#include <utility>
 
 /**
  * \file
@@ -150,6 +153,10 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 /**
  * \ingroup config-impl
  * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into the sorted and disjoint ranges
+ * of the indexes it matches, so that matching an index does not parse
+ * strings and the matching indexes of a vector can be visited directly.
  */
 class ArrayMatcher
 {
@@ -167,7 +174,25 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * Test if every index matches the Config Path.
+   *
+   * \returns \c true if the specification is "*".
+   */
+  bool MatchesAll (void) const;
+  /**
+   * Get the matching indexes.
+   *
+   * \returns The sorted, disjoint, inclusive ranges of the matching indexes.
+   */
+  const std::vector<std::pair<uint32_t, uint32_t> > & GetRanges (void) const;
 private:
+  /**
+   * Add the indexes matched by one alternative of the specification.
+   *
+   * \param [in] element The alternative, without any '|'.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,78 +203,111 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether every index matches. */
+  bool m_all;
+  /** The sorted, disjoint, inclusive ranges of the matching indexes. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 
 };  // class ArrayMatcher
 
 
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
-}
-bool
-ArrayMatcher::Matches (std::size_t i) const
-{
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  std::string::size_type start = 0;
+  std::string::size_type bar;
+  while ((bar = element.find ("|", start)) != std::string::npos)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      Parse (element.substr (start, bar - start));
+      start = bar + 1;
     }
-  std::string::size_type tmp;
-  tmp = m_element.find ("|");
-  if (tmp != std::string::npos)
+  Parse (element.substr (start));
+
+  // merge the overlapping and adjacent ranges
+  std::sort (m_ranges.begin (), m_ranges.end ());
+  std::vector<std::pair<uint32_t, uint32_t> > merged;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = m_ranges.begin ();
+       i != m_ranges.end (); ++i)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
+      if (!merged.empty ()
+          && static_cast<uint64_t> (i->first) <= static_cast<uint64_t> (merged.back ().second) + 1)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
+          merged.back ().second = std::max (merged.back ().second, i->second);
         }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
+      else
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
+          merged.push_back (*i);
         }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  m_ranges.swap (merged);
+}
+void
+ArrayMatcher::Parse (std::string element)
+{
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
+    {
+      m_all = true;
+      return;
+    }
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  uint32_t min;
+  uint32_t max;
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
-      uint32_t min;
-      uint32_t max;
-      if (StringToUint32 (lowerBound, &min) && 
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
+      if (StringToUint32 (lowerBound, &min) &&
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
-  uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &min))
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      m_ranges.push_back (std::make_pair (min, min));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
+    {
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); ++j)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
+bool
+ArrayMatcher::MatchesAll (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_all;
+}
+const std::vector<std::pair<uint32_t, uint32_t> > &
+ArrayMatcher::GetRanges (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_ranges;
+}
 
 bool
 ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
@@ -264,6 +322,17 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * The path is split into its elements, and the array specifications
+ * and the TypeIds of its elements are parsed, once per path.  The
+ * pointer and container attributes an element can follow from an
+ * object are looked up once per TypeId, in an index shared by all the
+ * resolvers.  When the indexes of a container are its positions, as
+ * for every ObjectVector, the matching objects are fetched directly
+ * rather than by copying and scanning the whole container; so
+ * resolving /NodeList/3/... no longer costs time proportional to the
+ * number of nodes.  Objects themselves are never cached, so adding or
+ * removing objects needs no invalidation.
  */
 class Resolver
 {
@@ -285,25 +354,48 @@ public:
    *                  in the Config path.
    */
   void Resolve (Ptr<Object> root);
-  
+
 private:
+  /** An attribute a path element can follow from an object. */
+  struct Edge
+  {
+    std::string name;   //!< The attribute name.
+    bool isContainer;   //!< Whether it is a container rather than a pointer.
+    /** The accessor of a container, to fetch its objects one at a time. */
+    Ptr<const ObjectPtrContainerAccessor> container;
+  };
+  /** The attributes a path element can follow from an object. */
+  typedef std::vector<struct Edge> Edges;
+
+  /**
+   * Get the attributes a path element can follow from an object.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The path element.
+   * \returns The pointer and container attributes of \p tid and its
+   *          parents named \p item (or all of them, if \p item is "*"),
+   *          in the order of the TypeId hierarchy.
+   */
+  static const Edges & GetEdges (TypeId tid, std::string const &item);
+
   /** Ensure the Config path starts and ends with a '/'. */
   void Canonicalize (void);
   /**
    * Parse the next element in the Config path.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] i The index of the next element of the Config path.
    * \param [in] root The object corresponding to the current positon
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t i, Ptr<Object> root);
   /**
    * Parse an index on the Config path.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] i The index of the next element of the Config path.
+   * \param [in] root The object holding the container.
+   * \param [in] edge The container attribute.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (std::size_t i, Ptr<Object> root, struct Edge const &edge);
   /**
    * Handle one object found on the path.
    *
@@ -328,6 +420,12 @@ private:
   std::vector<std::string> m_workStack;
   /** The Config path. */
   std::string m_path;
+  /** The elements of the Config path. */
+  std::vector<std::string> m_elements;
+  /** The elements of the Config path, as array specifications. */
+  std::vector<ArrayMatcher> m_matchers;
+  /** The TypeIds of the "$" elements, once looked up. */
+  std::vector<TypeId> m_tids;
 
 };  // class Resolver
 
@@ -336,6 +434,16 @@ Resolver::Resolver (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
   Canonicalize ();
+
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = m_path.find ("/", start)) != std::string::npos)
+    {
+      m_elements.push_back (m_path.substr (start, next - start));
+      m_matchers.push_back (ArrayMatcher (m_elements.back ()));
+      start = next + 1;
+    }
+  m_tids.resize (m_elements.size ());
 }
 Resolver::~Resolver ()
 {
@@ -361,12 +469,12 @@ Resolver::Canonicalize (void)
     }
 }
 
-void 
+void
 Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -382,7 +490,7 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
-void 
+void
 Resolver::DoResolveOne (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
@@ -391,46 +499,87 @@ Resolver::DoResolveOne (Ptr<Object> object)
   DoOne (object, GetResolvedPath ());
 }
 
+const Resolver::Edges &
+Resolver::GetEdges (TypeId tid, std::string const &item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  static std::map<std::pair<uint16_t, std::string>, Edges> index;
+
+  std::pair<uint16_t, std::string> key (tid.GetUid (), item);
+  std::map<std::pair<uint16_t, std::string>, Edges>::iterator found = index.find (key);
+  if (found != index.end ())
+    {
+      return found->second;
+    }
+  Edges &edges = index[key];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tid.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          struct Edge edge;
+          edge.name = info.name;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              edge.isContainer = false;
+              edges.push_back (edge);
+            }
+          if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              edge.isContainer = true;
+              edge.container = DynamicCast<const ObjectPtrContainerAccessor> (info.accessor);
+              edges.push_back (edge);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return edges;
+}
+
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::DoResolve (std::size_t i, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  NS_LOG_FUNCTION (this << i << root);
 
-  if (next == std::string::npos)
+  if (i == m_elements.size ())
     {
       //
-      // If root is zero, we're beginning to see if we can use the object name 
-      // service to resolve this path.  It is impossible to have a object name 
+      // If root is zero, we're beginning to see if we can use the object name
+      // service to resolve this path.  It is impossible to have a object name
       // associated with the root of the object name service since that root
       // is not an object.  This path must be referring to something in another
       // namespace and it will have been found already since the name service
       // is always consulted last.
-      // 
+      //
       if (root)
         {
           DoResolveOne (root);
         }
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  std::string const &item = m_elements[i];
 
   //
-  // If root is zero, we're beginning to see if we can use the object name 
-  // service to resolve this path.  In this case, we must see the name space 
-  // "/Names" on the front of this path.  There is no object associated with 
-  // the root of the "/Names" namespace, so we just ignore it and move on to 
+  // If root is zero, we're beginning to see if we can use the object name
+  // service to resolve this path.  In this case, we must see the name space
+  // "/Names" on the front of this path.  There is no object associated with
+  // the root of the "/Names" namespace, so we just ignore it and move on to
   // the next segment.
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (i + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -440,14 +589,19 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   // We have an item (possibly a segment of a namespace path.  Check to see if
   // we can determine that this segment refers to a named object.  If root is
   // zero, this means to look in the root of the "/Names" name space, otherwise
-  // it refers to a name space context (level).
+  // it refers to a name space context (level).  Most objects on a path have
+  // no names defined under them, which Names::HasChildren tells cheaply.
   //
-  Ptr<Object> namedObject = Names::Find<Object> (root, item);
+  Ptr<Object> namedObject;
+  if (Names::HasChildren (root))
+    {
+      namedObject = Names::Find<Object> (root, item);
+    }
   if (namedObject)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (i + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -467,79 +621,55 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   if (dollarPos == 0)
     {
       // This is a call to GetObject
-      std::string tidString = item.substr (1, item.size () - 1);
-      NS_LOG_DEBUG ("GetObject="<<tidString<<" on path="<<GetResolvedPath ());
-      TypeId tid = TypeId::LookupByName (tidString);
-      Ptr<Object> object = root->GetObject<Object> (tid);
+      if (m_tids[i].GetUid () == 0)
+        {
+          std::string tidString = item.substr (1, item.size () - 1);
+          m_tids[i] = TypeId::LookupByName (tidString);
+        }
+      NS_LOG_DEBUG ("GetObject="<<item<<" on path="<<GetResolvedPath ());
+      Ptr<Object> object = root->GetObject<Object> (m_tids[i]);
       if (object == 0)
         {
-          NS_LOG_DEBUG ("GetObject ("<<tidString<<") failed on path="<<GetResolvedPath ());
+          NS_LOG_DEBUG ("GetObject ("<<item<<") failed on path="<<GetResolvedPath ());
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (i + 1, object);
       m_workStack.pop_back ();
     }
-  else 
+  else
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const Edges &edges = GetEdges (root->GetInstanceTypeId (), item);
+      for (Edges::const_iterator edge = edges.begin (); edge != edges.end (); ++edge)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!edge->isContainer)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<edge->name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              root->GetAttribute (edge->name, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (edge->name);
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<edge->name<<" on path="<<GetResolvedPath ());
+              m_workStack.push_back (edge->name);
+              DoArrayResolve (i + 1, root, *edge);
+              m_workStack.pop_back ();
             }
+        }
 
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
+      if (edges.empty ())
         {
           NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
           return;
@@ -547,21 +677,56 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     }
 }
 
-void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+void
+Resolver::DoArrayResolve (std::size_t i, Ptr<Object> root, struct Edge const &edge)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION (this << i << root << edge.name);
+  if (i == m_elements.size ())
     {
       return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  ArrayMatcher const &matcher = m_matchers[i];
 
-  ArrayMatcher matcher = ArrayMatcher (item);
+  //
+  // If the last object of the container has its position as index, so do all
+  // the others, and the matching objects can be fetched by position.
+  //
+  bool positional = false;
+  std::size_t n = 0;
+  std::size_t index;
+  if (edge.container != 0 && edge.container->GetN (PeekPointer (root), &n))
+    {
+      if (n == 0)
+        {
+          return;
+        }
+      edge.container->Get (PeekPointer (root), n - 1, &index);
+      positional = index == n - 1;
+    }
+  if (positional)
+    {
+      std::vector<std::pair<uint32_t, uint32_t> > all (1, std::make_pair (0, 0xffffffff));
+      std::vector<std::pair<uint32_t, uint32_t> > const &ranges =
+        matcher.MatchesAll () ? all : matcher.GetRanges ();
+      for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator range = ranges.begin ();
+           range != ranges.end () && range->first < n; ++range)
+        {
+          std::size_t last = std::min<std::size_t> (range->second, n - 1);
+          for (std::size_t j = range->first; j <= last; ++j)
+            {
+              Ptr<Object> object = edge.container->Get (PeekPointer (root), j, &index);
+              std::ostringstream oss;
+              oss << j;
+              m_workStack.push_back (oss.str ());
+              DoResolve (i + 1, object);
+              m_workStack.pop_back ();
+            }
+        }
+      return;
+    }
+
+  ObjectPtrContainerValue container;
+  root->GetAttribute (edge.name, container);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
@@ -570,7 +735,7 @@ Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &conta
           std::ostringstream oss;
           oss << (*it).first;
           m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
+          DoResolve (i + 1, (*it).second);
           m_workStack.pop_back ();
         }
     }
@@ -593,6 +758,12 @@ public:
   void DisconnectWithoutContext (std::string path, const CallbackBase &cb);
   /** \copydoc Config::Disconnect() */
   void Disconnect (std::string path, const CallbackBase &cb);
+  /** \copydoc Config::ConnectMany() */
+  void ConnectMany (std::string path,
+                    const std::vector<std::pair<std::string, CallbackBase> > &sinks);
+  /** \copydoc Config::ConnectManyWithoutContext() */
+  void ConnectManyWithoutContext (std::string path,
+                                  const std::vector<std::pair<std::string, CallbackBase> > &sinks);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
 
@@ -684,6 +855,32 @@ ConfigImpl::Disconnect (std::string path, const CallbackBase &cb)
   MatchContainer container = LookupMatches (root);
   container.Disconnect (leaf, cb);
 }
+void
+ConfigImpl::ConnectMany (std::string path,
+                         const std::vector<std::pair<std::string, CallbackBase> > &sinks)
+{
+  NS_LOG_FUNCTION (this << path << sinks.size ());
+
+  MatchContainer container = LookupMatches (path);
+  for (std::vector<std::pair<std::string, CallbackBase> >::const_iterator i = sinks.begin ();
+       i != sinks.end (); ++i)
+    {
+      container.Connect (i->first, i->second);
+    }
+}
+void
+ConfigImpl::ConnectManyWithoutContext (std::string path,
+                                       const std::vector<std::pair<std::string, CallbackBase> > &sinks)
+{
+  NS_LOG_FUNCTION (this << path << sinks.size ());
+
+  MatchContainer container = LookupMatches (path);
+  for (std::vector<std::pair<std::string, CallbackBase> >::const_iterator i = sinks.begin ();
+       i != sinks.end (); ++i)
+    {
+      container.ConnectWithoutContext (i->first, i->second);
+    }
+}
 
 MatchContainer 
 ConfigImpl::LookupMatches (std::string path)
@@ -851,6 +1048,20 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   ConfigImpl::Get ()->Disconnect (path, cb);
 }
+void
+ConnectMany (std::string path,
+             const std::vector<std::pair<std::string, CallbackBase> > &sinks)
+{
+  NS_LOG_FUNCTION (path << sinks.size ());
+  ConfigImpl::Get ()->ConnectMany (path, sinks);
+}
+void
+ConnectManyWithoutContext (std::string path,
+                           const std::vector<std::pair<std::string, CallbackBase> > &sinks)
+{
+  NS_LOG_FUNCTION (path << sinks.size ());
+  ConfigImpl::Get ()->ConnectManyWithoutContext (path, sinks);
+}
 MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
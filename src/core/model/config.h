@@ -22,6 +22,7 @@
 
 #include "ptr.h"
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -139,6 +140,30 @@ void Connect (std::string path, const CallbackBase &cb);
  * This function undoes the work of Config::ConnectWithContext.
  */
 void Disconnect (std::string path, const CallbackBase &cb);
+/**
+ * \ingroup config
+ * \param [in] path A path to match objects, without the trace source name.
+ * \param [in] sinks Pairs of a trace source name and the callback to
+ *            connect to that trace source.
+ *
+ * This function resolves \p path once and connects every callback to
+ * its trace source in each matching object, with the context
+ * Config::Connect would give.  Connecting many trace sources of the
+ * same objects this way is cheaper than one Config::Connect for each.
+ */
+void ConnectMany (std::string path,
+                  const std::vector<std::pair<std::string, CallbackBase> > &sinks);
+/**
+ * \ingroup config
+ * \param [in] path A path to match objects, without the trace source name.
+ * \param [in] sinks Pairs of a trace source name and the callback to
+ *            connect to that trace source.
+ *
+ * This function is the equivalent of Config::ConnectMany for
+ * Config::ConnectWithoutContext.
+ */
+void ConnectManyWithoutContext (std::string path,
+                                const std::vector<std::pair<std::string, CallbackBase> > &sinks);
 
 /**
  * \ingroup config
@@ -25,10 +25,12 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <iostream>
 
 
 /**
@@ -46,6 +48,24 @@ NS_LOG_COMPONENT_DEFINE ("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (DefaultSimulatorImpl);
 
+namespace {
+
+/**
+ * \ingroup simulator
+ * Number of events from a different context which can be queued
+ * without taking a lock.
+ */
+const uint32_t EVENTS_WITH_CONTEXT_CAPACITY = 4096;
+
+/**
+ * \ingroup simulator
+ * Minimum number of cancelled events before they are removed from
+ * the scheduler, to amortize the cost of a pass over the scheduler.
+ */
+const int MIN_CANCELLED_EVENTS_TO_RECLAIM = 256;
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId (void)
 {
@@ -53,11 +73,25 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("Profile",
+                   "Attribute the wall-clock time of the events to their "
+                   "handler, and print the profile at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_profile),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ReclaimCancelled",
+                   "Remove the cancelled events from the scheduler when "
+                   "they make up more than half of the scheduled events.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_reclaimCancelled),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl ()
+  : m_eventsWithContext (EVENTS_WITH_CONTEXT_CAPACITY),
+    m_overflowing (false)
 {
   NS_LOG_FUNCTION (this);
   m_stop = false;
@@ -71,7 +105,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
+  m_cancelledEvents = 0;
   m_main = SystemThread::Self();
 }
 
@@ -108,6 +142,11 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profile)
+    {
+      m_profiler.Print (std::cout);
+      m_profiler.Clear ();
+    }
 }
 
 void
@@ -115,6 +154,7 @@ DefaultSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
 {
   NS_LOG_FUNCTION (this << schedulerFactory);
   Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+  m_schedulerFactory = schedulerFactory;
 
   if (m_events != 0)
     {
@@ -141,12 +181,23 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
 
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
+  if (next.impl->IsCancelled () && m_cancelledEvents > 0)
+    {
+      m_cancelledEvents--;
+    }
 
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profile)
+    {
+      m_profiler.Invoke (next.impl);
+    }
+  else
+    {
+      next.impl->Invoke ();
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -161,31 +212,65 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
     {
-      return;
+      InsertEventWithContext (event);
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
+  if (!m_overflowing.load (std::memory_order_acquire))
+    {
+      return;
+    }
+  // The events of m_overflow were queued after those of
+  // m_eventsWithContext by their thread, so they come last.
+  EventsWithContext overflow;
   {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
+    CriticalSection cs (m_overflowMutex);
+    m_overflow.swap (overflow);
+    m_overflowing.store (false, std::memory_order_relaxed);
   }
-  while (!eventsWithContext.empty ())
+  for (EventsWithContext::const_iterator i = overflow.begin (); i != overflow.end (); ++i)
+    {
+      InsertEventWithContext (*i);
+    }
+}
+
+void
+DefaultSimulatorImpl::InsertEventWithContext (const EventWithContext &event)
+{
+  Scheduler::Event ev;
+  ev.impl = event.event;
+  ev.key.m_ts = m_currentTs + event.timestamp;
+  ev.key.m_context = event.context;
+  ev.key.m_uid = m_uid;
+  m_uid++;
+  m_unscheduledEvents++;
+  m_events->Insert (ev);
+}
+
+void
+DefaultSimulatorImpl::ReclaimCancelledEvents (void)
+{
+  NS_LOG_FUNCTION (this << m_cancelledEvents << m_unscheduledEvents);
+  // The schedulers expect the events to be inserted after the last
+  // one removed: move the events left to a new scheduler.
+  Ptr<Scheduler> events = m_schedulerFactory.Create<Scheduler> ();
+  while (!m_events->IsEmpty ())
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
-       Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
-       ev.key.m_uid = m_uid;
-       m_uid++;
-       m_unscheduledEvents++;
-       m_events->Insert (ev);
+      Scheduler::Event next = m_events->RemoveNext ();
+      if (next.impl->IsCancelled ())
+        {
+          next.impl->Unref ();
+          m_unscheduledEvents--;
+        }
+      else
+        {
+          events->Insert (next);
+        }
     }
+  m_events = events;
+  m_cancelledEvents = 0;
 }
 
 void
@@ -269,11 +354,13 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      if (m_overflowing.load (std::memory_order_acquire)
+          || !m_eventsWithContext.Push (ev))
+        {
+          CriticalSection cs (m_overflowMutex);
+          m_overflow.push_back (ev);
+          m_overflowing.store (true, std::memory_order_release);
+        }
     }
 }
 
@@ -360,9 +447,22 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
+    {
+      return;
+    }
+  id.PeekEventImpl ()->Cancel ();
+  if (id.GetUid () == 2)
+    {
+      // destroy events are not in the scheduler.
+      return;
+    }
+  m_cancelledEvents++;
+  if (m_reclaimCancelled
+      && m_cancelledEvents >= MIN_CANCELLED_EVENTS_TO_RECLAIM
+      && 2 * m_cancelledEvents > m_unscheduledEvents)
     {
-      id.PeekEventImpl ()->Cancel ();
+      ReclaimCancelledEvents ();
     }
 }
 
@@ -26,9 +26,12 @@
 #include "event-impl.h"
 #include "system-thread.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -43,6 +46,17 @@ namespace ns3 {
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the \c Profile attribute is set, the wall-clock time of the
+ * events is attributed to their handler by an EventProfiler, whose
+ * ranked table is printed on the standard output by
+ * Simulator::Destroy.
+ *
+ * Cancelling an event only marks it as cancelled: it stays in the
+ * scheduler until its timestamp comes up.  When the cancelled events
+ * make up more than half of the scheduled events, they are removed
+ * from the scheduler in one pass, so that reschedule-heavy timers
+ * do not fill the scheduler with dead events.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -95,17 +109,36 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
+  /**
+   * Insert an event from a different context in the main event queue.
+   * \param [in] event The event.
+   */
+  void InsertEventWithContext (const EventWithContext &event);
+  /**
+   * Remove the cancelled events from the scheduler, and release them.
+   */
+  void ReclaimCancelledEvents (void);
+
   /** Container type for the events from a different context. */
   typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The lock-free queue of events from a different context, which
+   * the other threads fill without allocating memory or taking a lock.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  MpscQueue<EventWithContext> m_eventsWithContext;
+  /**
+   * The events from a different context which did not fit in
+   * m_eventsWithContext.
+   */
+  EventsWithContext m_overflow;
+  /**
+   * Flag \c true while m_overflow is not empty.  The other threads
+   * then append to m_overflow rather than to m_eventsWithContext,
+   * so that the events of each thread are kept in order.
+   */
+  std::atomic<bool> m_overflowing;
+  /** Mutex to control access to m_overflow. */
+  SystemMutex m_overflowMutex;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -115,6 +148,8 @@ private:
   bool m_stop;
   /** The event priority queue. */
   Ptr<Scheduler> m_events;
+  /** The factory of m_events, to create an empty scheduler. */
+  ObjectFactory m_schedulerFactory;
 
   /** Next event unique id. */
   uint32_t m_uid;
@@ -129,9 +164,22 @@ private:
    *  not counting the Destroy events; this is used for validation
    */
   int m_unscheduledEvents;
+  /**
+   * Number of events of the scheduler which have been cancelled
+   * through Cancel.  EventImpl::Cancel can also be called directly,
+   * so this is only an estimate.
+   */
+  int m_cancelledEvents;
+  /** Flag \c true to remove the cancelled events from the scheduler. */
+  bool m_reclaimCancelled;
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Flag \c true to profile the events. */
+  bool m_profile;
+  /** The profile of the events, if enabled. */
+  EventProfiler m_profiler;
 };
 
 } // namespace ns3
@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
 
 /**
  * \file
@@ -66,4 +67,178 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+const ObjectBase *
+EventImpl::PeekObject (void) const
+{
+  return 0;
+}
+
+#ifdef ENABLE_EVENT_POOL
+
+namespace {
+
+/**
+ * \ingroup events
+ * Events are pooled in size classes which are multiples of this size.
+ */
+const std::size_t POOL_GRANULARITY = 16;
+/** \ingroup events Number of size classes; larger events use the heap. */
+const std::size_t POOL_CLASSES = 16;
+/** \ingroup events Maximum number of free blocks kept per size class. */
+const uint32_t POOL_MAX_FREE = 4096;
+
+/**
+ * \ingroup events
+ * Per-thread free lists of event memory blocks.
+ *
+ * The blocks are individually allocated from the heap and kept here
+ * when released, so an event may be freed by another thread than the
+ * one which allocated it: the block just moves to the free list of
+ * that thread.
+ */
+class EventPool
+{
+public:
+  EventPool ()
+  {
+    for (std::size_t i = 0; i < POOL_CLASSES; i++)
+      {
+        m_free[i] = 0;
+        m_nFree[i] = 0;
+      }
+  }
+  ~EventPool ()
+  {
+    for (std::size_t i = 0; i < POOL_CLASSES; i++)
+      {
+        while (m_free[i] != 0)
+          {
+            Block *block = m_free[i];
+            m_free[i] = block->next;
+            ::operator delete (block);
+          }
+      }
+  }
+  /**
+   * \param [in] sizeClass The size class.
+   * \returns A free block, or zero if there is none.
+   */
+  void * Pop (std::size_t sizeClass)
+  {
+    Block *block = m_free[sizeClass];
+    if (block != 0)
+      {
+        m_free[sizeClass] = block->next;
+        m_nFree[sizeClass]--;
+      }
+    return block;
+  }
+  /**
+   * \param [in] p A block.
+   * \param [in] sizeClass The size class of \p p.
+   * \returns \c false if the free list is full.
+   */
+  bool Push (void *p, std::size_t sizeClass)
+  {
+    if (m_nFree[sizeClass] >= POOL_MAX_FREE)
+      {
+        return false;
+      }
+    Block *block = static_cast<Block *> (p);
+    block->next = m_free[sizeClass];
+    m_free[sizeClass] = block;
+    m_nFree[sizeClass]++;
+    return true;
+  }
+
+private:
+  /** A free block. */
+  struct Block
+  {
+    Block *next;  /**< The next free block. */
+  };
+  Block *m_free[POOL_CLASSES];    /**< The free lists. */
+  uint32_t m_nFree[POOL_CLASSES]; /**< The length of the free lists. */
+};
+
+/**
+ * \ingroup events
+ * The pool of the calling thread.
+ *
+ * Its destructor runs before the static destructors, which can
+ * still release events: it is constructed on first use and tracked
+ * with g_poolState so that it is never used after its destruction.
+ */
+thread_local EventPool g_pool;
+/** \ingroup events State of g_pool: 0 before use, 1 alive, 2 destroyed. */
+thread_local int g_poolState = 0;
+
+/**
+ * \ingroup events
+ * Mark g_pool as destroyed when the calling thread exits.
+ */
+struct EventPoolGuard
+{
+  ~EventPoolGuard ()
+  {
+    g_poolState = 2;
+  }
+};
+/** \ingroup events The guard of g_pool, destroyed right before it. */
+thread_local EventPoolGuard g_poolGuard;
+
+/**
+ * \ingroup events
+ * \returns The pool of the calling thread, or zero if it is destroyed.
+ */
+EventPool *
+GetPool (void)
+{
+  if (g_poolState == 0)
+    {
+      // Thread-local objects are destroyed in reverse order of
+      // construction: the guard must be constructed after the pool.
+      (void) &g_pool;
+      (void) &g_poolGuard;
+      g_poolState = 1;
+    }
+  return g_poolState == 1 ? &g_pool : 0;
+}
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass >= POOL_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  EventPool *pool = GetPool ();
+  void *p = pool != 0 ? pool->Pop (sizeClass) : 0;
+  if (p == 0)
+    {
+      p = ::operator new ((sizeClass + 1) * POOL_GRANULARITY);
+    }
+  return p;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / POOL_GRANULARITY;
+  if (sizeClass < POOL_CLASSES)
+    {
+      EventPool *pool = GetPool ();
+      if (pool != 0 && pool->Push (p, sizeClass))
+        {
+          return;
+        }
+    }
+  ::operator delete (p);
+}
+
+#endif /* ENABLE_EVENT_POOL */
+
 } // namespace ns3
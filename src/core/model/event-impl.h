@@ -21,6 +21,8 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
+#include "ns3/core-config.h"
 #include "simple-ref-count.h"
 
 /**
@@ -31,6 +33,8 @@
 
 namespace ns3 {
 
+class ObjectBase;
+
 /**
  * \ingroup events
  * \brief A simulation event.
@@ -40,6 +44,12 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Unless ns-3 is configured with \c --disable-event-pool (which
+ * is useful to track event leaks with valgrind), the events are
+ * allocated from per-thread free lists of fixed-size blocks, so that
+ * scheduling an event does not hit the global heap once the
+ * simulation has reached its steady state.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -65,6 +75,33 @@ public:
    * Checked by the simulation engine before calling Invoke().
    */
   bool IsCancelled (void);
+  /**
+   * Get the object this event will be invoked on, if any.
+   *
+   * This is used by the EventProfiler to attribute the execution
+   * time of the event to the TypeId of its target.
+   *
+   * \returns The target object of the event if it derives from
+   *          ObjectBase, or zero.
+   */
+  virtual const ObjectBase * PeekObject (void) const;
+
+#ifdef ENABLE_EVENT_POOL
+  /**
+   * Allocate an event from the free list of the calling thread.
+   *
+   * \param [in] size The size of the event.
+   * \returns The memory of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return an event to the free list of the calling thread.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event.
+   */
+  static void operator delete (void *p, std::size_t size);
+#endif /* ENABLE_EVENT_POOL */
 
 protected:
   /**
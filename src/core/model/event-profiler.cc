@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "object-base.h"
+#include "log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace {
+
+/**
+ * \ingroup events
+ * Compare two profile entries by decreasing time.
+ *
+ * \param [in] a The first entry.
+ * \param [in] b The second entry.
+ * \returns \c true if \p a took more time than \p b.
+ */
+bool
+EntryIsSlower (const EventProfiler::Entry &a, const EventProfiler::Entry &b)
+{
+  return a.seconds > b.seconds;
+}
+
+} // unnamed namespace
+
+void
+EventProfiler::Invoke (EventImpl *event)
+{
+  if (event->IsCancelled ())
+    {
+      // The target of a cancelled event may be gone.
+      return;
+    }
+  const ObjectBase *object = event->PeekObject ();
+  Key key (&typeid (*event), object != 0 ? object->GetInstanceTypeId () : TypeId ());
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  event->Invoke ();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+
+  Counters &counters = m_counters[key];
+  counters.count++;
+  counters.seconds += elapsed.count ();
+}
+
+std::vector<EventProfiler::Entry>
+EventProfiler::GetEntries (void) const
+{
+  NS_LOG_FUNCTION (this);
+  // The same EventImpl type can have several type_info objects, one
+  // per shared library: merge them by name.
+  std::map<std::pair<std::string, std::string>, Entry> merged;
+  for (std::map<Key, Counters>::const_iterator i = m_counters.begin (); i != m_counters.end (); ++i)
+    {
+      std::string handler = GetHandlerName (*i->first.first);
+      TypeId tid = i->first.second;
+      std::string typeId = tid.GetUid () != 0 ? tid.GetName () : "";
+      Entry &entry = merged[std::make_pair (handler, typeId)];
+      entry.handler = handler;
+      entry.typeId = typeId;
+      entry.count += i->second.count;
+      entry.seconds += i->second.seconds;
+    }
+  std::vector<Entry> entries;
+  for (std::map<std::pair<std::string, std::string>, Entry>::const_iterator i = merged.begin ();
+       i != merged.end (); ++i)
+    {
+      entries.push_back (i->second);
+    }
+  std::stable_sort (entries.begin (), entries.end (), EntryIsSlower);
+  return entries;
+}
+
+void
+EventProfiler::Print (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  std::vector<Entry> entries = GetEntries ();
+  uint64_t count = 0;
+  double seconds = 0;
+  for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i)
+    {
+      count += i->count;
+      seconds += i->seconds;
+    }
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << "Event profile: " << count << " events, " << seconds << " s" << std::endl;
+  os << std::right
+     << std::setw (5) << "Rank"
+     << std::setw (12) << "Events"
+     << std::setw (12) << "Time (s)"
+     << std::setw (9) << "Time %"
+     << std::setw (12) << "ns/event"
+     << "  TypeId: Handler" << std::endl;
+  uint32_t rank = 1;
+  for (std::vector<Entry>::const_iterator i = entries.begin (); i != entries.end (); ++i, ++rank)
+    {
+      os << std::setw (5) << rank
+         << std::setw (12) << i->count
+         << std::fixed << std::setprecision (6)
+         << std::setw (12) << i->seconds
+         << std::setprecision (2)
+         << std::setw (9) << (seconds > 0 ? 100 * i->seconds / seconds : 0)
+         << std::setprecision (0)
+         << std::setw (12) << 1e9 * i->seconds / i->count
+         << "  " << (i->typeId.empty () ? "-" : i->typeId) << ": " << i->handler
+         << std::endl;
+      os.flags (flags);
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_counters.clear ();
+}
+
+std::string
+EventProfiler::GetHandlerName (const std::type_info &type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status != 0)
+    {
+      return name;
+    }
+  name = demangled;
+  std::free (demangled);
+
+  // The events created by MakeEvent are local classes of MakeEvent:
+  // their name ends with the parameters of MakeEvent, the first of
+  // which is the type of the function or method of the handler,
+  // "... MakeEvent<...>(void (ns3::A::*)(int), ns3::A*, int)::EventMemberImpl1"
+  std::string::size_type end = name.rfind (")::");
+  if (end == std::string::npos
+      || name.find ("MakeEvent") == std::string::npos)
+    {
+      return name;
+    }
+  int depth = 0;
+  std::string::size_type comma = end;
+  std::string::size_type start = end;
+  while (start > 0)
+    {
+      --start;
+      char c = name[start];
+      if (c == ')' || c == '>')
+        {
+          depth++;
+        }
+      else if ((c == '(' || c == '<') && depth > 0)
+        {
+          depth--;
+        }
+      else if (c == '(')
+        {
+          break;
+        }
+      else if (c == ',' && depth == 0)
+        {
+          comma = start;
+        }
+    }
+  if (name[start] != '(')
+    {
+      return name;
+    }
+  return name.substr (start + 1, comma - start - 1);
+#else
+  return name;
+#endif
+}
+
+} // namespace ns3
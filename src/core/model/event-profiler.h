@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include "type-id.h"
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup events
+ * \brief Attribute the wall-clock time of the simulation events to
+ * their handler.
+ *
+ * The events are grouped by handler, that is by the type of the
+ * EventImpl subclass (for the events created by MakeEvent, this
+ * identifies the signature of the function or class method bound
+ * to the event), and by the TypeId of the object the event is invoked
+ * on, when it derives from ObjectBase.
+ *
+ * The DefaultSimulatorImpl runs its events through a profiler when
+ * its \c Profile attribute is set, and prints the profile when the
+ * simulation is destroyed:
+ * \code
+ *   Config::SetDefault ("ns3::DefaultSimulatorImpl::Profile", BooleanValue (true));
+ * \endcode
+ * or, from the command line of a script which uses CommandLine,
+ * \c --ns3::DefaultSimulatorImpl::Profile=true
+ */
+class EventProfiler
+{
+public:
+  /** The profile of a handler. */
+  struct Entry
+  {
+    std::string handler;   /**< The handler, as a C++ type. */
+    std::string typeId;    /**< The TypeId name of the target object, or empty. */
+    uint64_t count;        /**< The number of events. */
+    double seconds;        /**< The wall-clock time spent in the events. */
+  };
+
+  /**
+   * Invoke an event and add its execution time to the profile.
+   *
+   * \param [in] event The event.
+   */
+  void Invoke (EventImpl *event);
+  /**
+   * \returns The profile of each handler, by decreasing time.
+   */
+  std::vector<Entry> GetEntries (void) const;
+  /**
+   * Print the profile as a table ranked by decreasing time.
+   *
+   * \param [in] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+  /** Reset the profile. */
+  void Clear (void);
+
+private:
+  /**
+   * \param [in] type The type of an EventImpl subclass.
+   * \returns The handler of the events of \p type, as a C++ type.
+   */
+  static std::string GetHandlerName (const std::type_info &type);
+
+  /** The time and number of the events of a handler. */
+  struct Counters
+  {
+    uint64_t count;        /**< The number of events. */
+    double seconds;        /**< The wall-clock time spent in the events. */
+  };
+  /**
+   * The handler key: the EventImpl type, and the TypeId of the
+   * target object (a default TypeId if there is none).
+   */
+  typedef std::pair<const std::type_info *, TypeId> Key;
+
+  /** The counters of each handler. */
+  std::map<Key, Counters> m_counters;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
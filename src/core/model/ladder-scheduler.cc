@@ -0,0 +1,350 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Maximum number of events sorted at once in the bottom before
+ * they are spread over a new rung.
+ */
+const uint32_t THRESHOLD = 50;
+/** \ingroup scheduler Maximum number of rungs in the ladder. */
+const uint32_t MAX_RUNGS = 8;
+/** \ingroup scheduler Maximum number of buckets in a rung. */
+const uint32_t MAX_BUCKETS = 65536;
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events by EventKey, to keep the
+ * bottom sorted in decreasing order.
+ */
+struct EventIsLater
+{
+  /**
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \returns \c true if \c b < \c a
+   */
+  bool operator () (const Scheduler::Event &a, const Scheduler::Event &b) const
+  {
+    return b.key < a.key;
+  }
+};
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (UINT64_MAX),
+    m_topMax (0),
+    m_topStart (0),
+    m_qSize (0)
+{
+  NS_LOG_FUNCTION (this);
+  // AddRung takes references to the rungs across push_back
+  m_rungs.reserve (MAX_RUNGS);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+LadderScheduler::CurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+uint32_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  NS_LOG_FUNCTION (this << ts);
+  uint32_t i;
+  for (i = 0; i < m_rungs.size (); i++)
+    {
+      if (ts >= CurrentStart (m_rungs[i]))
+        {
+          break;
+        }
+    }
+  return i;
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      m_qSize++;
+      Refill ();
+      return;
+    }
+  uint32_t i = FindRung (ts);
+  if (i < m_rungs.size ())
+    {
+      Rung &rung = m_rungs[i];
+      uint64_t bucket = (ts - rung.start) / rung.width;
+      NS_ASSERT (bucket < rung.buckets.size ());
+      NS_LOG_LOGIC ("insert in rung=" << i << ", bucket=" << bucket);
+      rung.buckets[bucket].push_back (ev);
+      rung.count++;
+      m_qSize++;
+      // the rung may have been left over by the last RemoveNext
+      Refill ();
+      return;
+    }
+  m_qSize++;
+  InsertBottom (ev);
+}
+
+void
+LadderScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_bottom.insert (std::upper_bound (m_bottom.begin (), m_bottom.end (),
+                                     ev, EventIsLater ()),
+                   ev);
+  if (m_bottom.size () > THRESHOLD
+      && m_rungs.size () < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      uint64_t end = m_rungs.empty () ? m_topStart : CurrentStart (m_rungs.back ());
+      NS_LOG_LOGIC ("spill " << m_bottom.size () << " events from bottom");
+      Bucket events;
+      events.swap (m_bottom);
+      AddRung (events, events.back ().key.m_ts, end);
+      Refill ();
+    }
+}
+
+void
+LadderScheduler::AddRung (Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (end > start);
+  NS_ASSERT (m_rungs.size () < MAX_RUNGS);
+  uint64_t range = end - start;
+  uint64_t nBuckets = std::min<uint64_t> (events.size (), MAX_BUCKETS);
+  nBuckets = std::max<uint64_t> (nBuckets, 1);
+  uint64_t width = (range + nBuckets - 1) / nBuckets;
+  nBuckets = (range + width - 1) / width;
+
+  m_rungs.push_back (Rung ());
+  Rung &rung = m_rungs.back ();
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.count = events.size ();
+  rung.buckets.resize (nBuckets);
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint64_t bucket = (i->key.m_ts - start) / width;
+      NS_ASSERT (bucket < nBuckets);
+      rung.buckets[bucket].push_back (*i);
+    }
+  NS_LOG_LOGIC ("rung=" << m_rungs.size () - 1 << ", nBuckets=" << nBuckets <<
+                ", width=" << width);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size ());
+  NS_ASSERT (m_rungs.empty () && !m_top.empty ());
+  uint64_t nBuckets = std::min<uint64_t> (m_top.size (), MAX_BUCKETS);
+  uint64_t width = (m_topMax - m_topMin) / nBuckets + 1;
+  nBuckets = (m_topMax - m_topMin) / width + 1;
+  m_topStart = m_topMin + nBuckets * width;
+
+  Bucket events;
+  events.swap (m_top);
+  AddRung (events, m_topMin, m_topStart);
+  m_topMin = UINT64_MAX;
+  m_topMax = 0;
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty () && m_qSize > 0)
+    {
+      if (m_rungs.empty ())
+        {
+          TransferTop ();
+        }
+      Rung &rung = m_rungs.back ();
+      if (rung.count == 0)
+        {
+          m_rungs.pop_back ();
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = CurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+
+      bool spawn = bucket.size () > THRESHOLD
+        && rung.width > 1
+        && m_rungs.size () < MAX_RUNGS;
+      if (spawn)
+        {
+          // Do not split a bucket whose events all share the same
+          // timestamp: they would just end up in a single child bucket.
+          spawn = false;
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+            {
+              if (i->key.m_ts != bucket.front ().key.m_ts)
+                {
+                  spawn = true;
+                  break;
+                }
+            }
+        }
+      if (spawn)
+        {
+          Bucket events;
+          events.swap (bucket);
+          AddRung (events, bucketStart, CurrentStart (rung));
+        }
+      else
+        {
+          m_bottom.swap (bucket);
+          std::sort (m_bottom.begin (), m_bottom.end (), EventIsLater ());
+        }
+    }
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event next = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_qSize--;
+  Refill ();
+  return next;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket;
+  if (ts >= m_topStart)
+    {
+      bucket = &m_top;
+    }
+  else
+    {
+      uint32_t i = FindRung (ts);
+      if (i == m_rungs.size ())
+        {
+          Bucket::iterator end = m_bottom.end ();
+          for (Bucket::iterator j = std::lower_bound (m_bottom.begin (), end, ev, EventIsLater ());
+               j != end; ++j)
+            {
+              if (j->key.m_uid == ev.key.m_uid)
+                {
+                  NS_ASSERT (j->impl == ev.impl);
+                  m_bottom.erase (j);
+                  m_qSize--;
+                  Refill ();
+                  return;
+                }
+            }
+          NS_ASSERT (false);
+          return;
+        }
+      Rung &rung = m_rungs[i];
+      bucket = &rung.buckets[(ts - rung.start) / rung.width];
+      rung.count--;
+    }
+  for (Bucket::iterator j = bucket->begin (); j != bucket->end (); ++j)
+    {
+      if (j->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (j->impl == ev.impl);
+          // buckets are unsorted
+          *j = bucket->back ();
+          bucket->pop_back ();
+          m_qSize--;
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler is an implementation of the ladder queue
+ * described in "Ladder Queue: An O(1) Priority Queue Structure for
+ * Large-Scale Discrete Event Simulation" by Wai Teng Tang, Rick Siow
+ * Mong Goh and Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The event list is split in three tiers:
+ *  - Top: an unsorted vector which receives all the events scheduled
+ *    beyond the time range currently covered by the ladder.
+ *  - Ladder: a stack of rungs, each of which is an array of unsorted
+ *    buckets of equal width.  A rung spawned from a bucket of the
+ *    rung above covers exactly the time range of that bucket.
+ *  - Bottom: a small sorted vector which holds the earliest events.
+ *
+ * Events are only sorted once they reach the bottom, which happens
+ * one bucket at a time, and the bucket widths adapt to the event-time
+ * distribution every time the top is transferred to the ladder, so
+ * both Insert and RemoveNext run in amortized O(1) time.
+ *
+ * Because the tiers are partitioned by timestamp only, all the events
+ * which share a timestamp always end up in the same bucket and are
+ * sorted together, which preserves the ordering defined by
+ * Scheduler::EventKey.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Ladder bucket type: an unsorted vector of Events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               /**< Timestamp of the start of the first bucket. */
+    uint64_t width;               /**< Duration of a bucket, in dimensionless time units. */
+    uint32_t current;             /**< Index of the first bucket not yet dequeued. */
+    uint64_t count;               /**< Number of events held by this rung. */
+    std::vector<Bucket> buckets;  /**< The buckets. */
+  };
+
+  /**
+   * Get the start of the first bucket of a rung not yet dequeued.
+   *
+   * Events at or past this timestamp belong to the rung (or to
+   * a rung above it).
+   *
+   * \param [in] rung The rung.
+   * \returns The current start timestamp of \p rung.
+   */
+  static uint64_t CurrentStart (const Rung &rung);
+  /**
+   * Find the rung an event with a given timestamp belongs to.
+   *
+   * The timestamp must be lower than m_topStart.
+   *
+   * \param [in] ts The dimensionless timestamp.
+   * \returns The index of the rung, or the number of rungs if
+   *          the event belongs to the bottom.
+   */
+  uint32_t FindRung (uint64_t ts) const;
+  /**
+   * Insert an event in the sorted bottom list, and spill the
+   * bottom into a new rung if it becomes too large.
+   *
+   * \param [in] ev The new Event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Append a new rung below the current lowest rung and distribute
+   * a set of events in its buckets.
+   *
+   * \param [in] events The events to distribute.
+   * \param [in] start The timestamp of the start of the new rung.
+   * \param [in] end The timestamp of the end of the new rung.
+   */
+  void AddRung (Bucket &events, uint64_t start, uint64_t end);
+  /** Move the content of the top to a fresh first rung. */
+  void TransferTop (void);
+  /**
+   * Make sure the bottom holds the earliest events if the
+   * event list is not empty.
+   */
+  void Refill (void);
+
+  /** Unsorted events scheduled at or after m_topStart. */
+  Bucket m_top;
+  /** Smallest timestamp stored in the top. */
+  uint64_t m_topMin;
+  /** Largest timestamp stored in the top. */
+  uint64_t m_topMax;
+  /** Smallest timestamp which goes to the top. */
+  uint64_t m_topStart;
+  /** The rungs of the ladder, from the earliest to the latest spawned. */
+  std::vector<Rung> m_rungs;
+  /** The earliest events, sorted in decreasing order. */
+  Bucket m_bottom;
+  /** Total number of events. */
+  uint64_t m_qSize;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,317 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include "low-jitter-synchronizer.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>       // clock_gettime, clock_nanosleep: glibc < 2.17, link with librt
+
+#if defined (HAVE_SYS_TIMERFD_H) && defined (HAVE_SYS_EVENTFD_H) && defined (HAVE_POLL_H)
+#define LOW_JITTER_SYNCHRONIZER_TIMERFD
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup realtime
+ * ns3::LowJitterSynchronizer implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LowJitterSynchronizer");
+
+NS_OBJECT_ENSURE_REGISTERED (LowJitterSynchronizer);
+
+namespace {
+
+/** Conversion constant between ns and s. */
+const uint64_t NS_PER_SEC = 1000000000;
+
+/**
+ * \ingroup realtime
+ * Convert a time in ns to a \c timespec.
+ *
+ * \param [in] ns The time, in ns.
+ * \returns The \c timespec.
+ */
+struct timespec
+NsToTimespec (uint64_t ns)
+{
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t> (ns / NS_PER_SEC);
+  ts.tv_nsec = static_cast<long> (ns % NS_PER_SEC);
+  return ts;
+}
+
+} // unnamed namespace
+
+TypeId
+LowJitterSynchronizer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LowJitterSynchronizer")
+    .SetParent<Synchronizer> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LowJitterSynchronizer> ()
+    .AddAttribute ("SpinThreshold",
+                   "The part of each wait spent spinning rather than sleeping.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::m_spinThreshold),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("MaxSleepSlice",
+                   "The longest sleep between two checks for a signal, "
+                   "on the systems without timerfd.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&LowJitterSynchronizer::m_maxSleepSlice),
+                   MakeTimeChecker (NanoSeconds (1)))
+  ;
+  return tid;
+}
+
+LowJitterSynchronizer::LowJitterSynchronizer ()
+  : m_nsEventStart (0),
+    m_condition (false),
+    m_timerFd (-1),
+    m_eventFd (-1)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef LOW_JITTER_SYNCHRONIZER_TIMERFD
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+  m_eventFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_timerFd < 0 || m_eventFd < 0)
+    {
+      NS_FATAL_ERROR ("LowJitterSynchronizer: can't create the timer: " << std::strerror (errno));
+    }
+#endif
+}
+
+LowJitterSynchronizer::~LowJitterSynchronizer ()
+{
+  NS_LOG_FUNCTION (this);
+#ifdef LOW_JITTER_SYNCHRONIZER_TIMERFD
+  close (m_timerFd);
+  close (m_eventFd);
+#endif
+}
+
+bool
+LowJitterSynchronizer::DoRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return true;
+}
+
+uint64_t
+LowJitterSynchronizer::DoGetCurrentRealtime (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime ();
+}
+
+void
+LowJitterSynchronizer::DoSetOrigin (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  m_realtimeOriginNano = GetRealtime ();
+  NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+}
+
+int64_t
+LowJitterSynchronizer::DoGetDrift (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  uint64_t nsNow = GetNormalizedRealtime ();
+  if (nsNow > ns)
+    {
+      return (int64_t)(nsNow - ns);
+    }
+  else
+    {
+      return -(int64_t)(ns - nsNow);
+    }
+}
+
+bool
+LowJitterSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
+{
+  NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  // nsCurrent is the real time at which the simulator computed
+  // nsDelay: waiting until their sum, rather than for nsDelay,
+  // makes up for the time spent since.
+  uint64_t ns = nsCurrent + nsDelay;
+  uint64_t spin = m_spinThreshold.GetNanoSeconds ();
+  if (ns > spin && GetNormalizedRealtime () < ns - spin)
+    {
+      if (!SleepUntil (ns - spin))
+        {
+          NS_LOG_INFO ("SleepUntil interrupted");
+          return false;
+        }
+    }
+  return SpinUntil (ns);
+}
+
+void
+LowJitterSynchronizer::DoSignal (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_condition.store (true, std::memory_order_release);
+#ifdef LOW_JITTER_SYNCHRONIZER_TIMERFD
+  uint64_t one = 1;
+  if (write (m_eventFd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+    {
+      NS_FATAL_ERROR ("LowJitterSynchronizer: can't signal: " << std::strerror (errno));
+    }
+#endif
+}
+
+void
+LowJitterSynchronizer::DoSetCondition (bool cond)
+{
+  NS_LOG_FUNCTION (this << cond);
+  m_condition.store (cond, std::memory_order_release);
+#ifdef LOW_JITTER_SYNCHRONIZER_TIMERFD
+  if (!cond)
+    {
+      // Drop the signals already received.
+      uint64_t count;
+      while (read (m_eventFd, &count, sizeof (count)) > 0)
+        {
+        }
+    }
+#endif
+}
+
+void
+LowJitterSynchronizer::DoEventStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_nsEventStart = GetNormalizedRealtime ();
+}
+
+uint64_t
+LowJitterSynchronizer::DoEventEnd (void)
+{
+  NS_LOG_FUNCTION (this);
+  return GetNormalizedRealtime () - m_nsEventStart;
+}
+
+bool
+LowJitterSynchronizer::SleepUntil (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+#ifdef LOW_JITTER_SYNCHRONIZER_TIMERFD
+  struct itimerspec spec;
+  std::memset (&spec, 0, sizeof (spec));
+  spec.it_value = NsToTimespec (m_realtimeOriginNano + ns);
+  if (timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &spec, 0) < 0)
+    {
+      NS_FATAL_ERROR ("LowJitterSynchronizer: can't arm the timer: " << std::strerror (errno));
+    }
+  struct pollfd fds[2];
+  fds[0].fd = m_timerFd;
+  fds[0].events = POLLIN;
+  fds[1].fd = m_eventFd;
+  fds[1].events = POLLIN;
+  for (;;)
+    {
+      if (m_condition.load (std::memory_order_acquire))
+        {
+          return false;
+        }
+      if (poll (fds, 2, -1) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("LowJitterSynchronizer: can't wait: " << std::strerror (errno));
+        }
+      if (fds[1].revents & POLLIN)
+        {
+          return false;
+        }
+      if (fds[0].revents & POLLIN)
+        {
+          uint64_t expirations;
+          if (read (m_timerFd, &expirations, sizeof (expirations)) < 0)
+            {
+              NS_LOG_LOGIC ("timer read failed: " << std::strerror (errno));
+            }
+          return true;
+        }
+    }
+#else
+  uint64_t slice = m_maxSleepSlice.GetNanoSeconds ();
+  for (;;)
+    {
+      if (m_condition.load (std::memory_order_acquire))
+        {
+          return false;
+        }
+      uint64_t now = GetNormalizedRealtime ();
+      if (now >= ns)
+        {
+          return true;
+        }
+      struct timespec ts = NsToTimespec (m_realtimeOriginNano + std::min (ns, now + slice));
+      clock_nanosleep (CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, 0);
+    }
+#endif
+}
+
+bool
+LowJitterSynchronizer::SpinUntil (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+  for (;;)
+    {
+      if (GetNormalizedRealtime () >= ns)
+        {
+          return true;
+        }
+      if (m_condition.load (std::memory_order_acquire))
+        {
+          return false;
+        }
+    }
+}
+
+uint64_t
+LowJitterSynchronizer::GetRealtime (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+uint64_t
+LowJitterSynchronizer::GetNormalizedRealtime (void)
+{
+  return GetRealtime () - m_realtimeOriginNano;
+}
+
+} // namespace ns3
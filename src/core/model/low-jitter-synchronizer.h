@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOW_JITTER_SYNCHRONIZER_H
+#define LOW_JITTER_SYNCHRONIZER_H
+
+#include "synchronizer.h"
+#include "nstime.h"
+
+#include <atomic>
+
+/**
+ * \file
+ * \ingroup realtime
+ * ns3::LowJitterSynchronizer declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup realtime
+ * \brief A real-time synchronizer which sleeps on a timer and spins
+ * for the last part of each wait.
+ *
+ * The WallClockSynchronizer sleeps on a condition variable with a
+ * relative timeout, reads the time with \c gettimeofday, and only
+ * spins when the wait is shorter than a few jiffies, which leaves
+ * tens to hundreds of microseconds of jitter on the events.  This
+ * synchronizer reads the monotonic clock to the nanosecond, sleeps
+ * until an absolute deadline \c SpinThreshold before the event is
+ * due, and then spins until the event is due.
+ *
+ * On Linux, the sleep is a \c poll on a \c timerfd armed with the
+ * absolute deadline and on an \c eventfd, which Signal writes to
+ * interrupt the sleep.  Elsewhere, the sleep is a sequence of
+ * \c clock_nanosleep of at most \c MaxSleepSlice, with a check for
+ * Signal between them.
+ *
+ * To use this synchronizer:
+ * \code
+ *   GlobalValue::Bind ("SimulatorImplementationType",
+ *                      StringValue ("ns3::RealtimeSimulatorImpl"));
+ *   Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+ *                       TypeIdValue (LowJitterSynchronizer::GetTypeId ()));
+ * \endcode
+ *
+ * A larger \c SpinThreshold trades CPU time for accuracy: it should
+ * exceed the wake-up latency of the sleeping thread, which depends
+ * on the kernel, the load and the power management of the host.
+ */
+class LowJitterSynchronizer : public Synchronizer
+{
+public:
+  /**
+   * Get the registered TypeId for this class.
+   * \returns The TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LowJitterSynchronizer ();
+  /** Destructor. */
+  virtual ~LowJitterSynchronizer ();
+
+protected:
+  // Inherited from Synchronizer
+  virtual void DoSetOrigin (uint64_t ns);
+  virtual bool DoRealtime (void);
+  virtual uint64_t DoGetCurrentRealtime (void);
+  virtual bool DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay);
+  virtual void DoSignal (void);
+  virtual void DoSetCondition (bool cond);
+  virtual int64_t DoGetDrift (uint64_t ns);
+  virtual void DoEventStart (void);
+  virtual uint64_t DoEventEnd (void);
+
+private:
+  /**
+   * Sleep until a normalized real time, or until Signal is called.
+   *
+   * \param [in] ns The normalized real time to wake up at.
+   * \returns \c true if we reached the time,
+   *          \c false if we returned because the condition was set.
+   */
+  bool SleepUntil (uint64_t ns);
+  /**
+   * Spin until a normalized real time, or until Signal is called.
+   *
+   * \param [in] ns The normalized real time to wait for.
+   * \returns \c true if we reached the time,
+   *          \c false if we returned because the condition was set.
+   */
+  bool SpinUntil (uint64_t ns);
+  /**
+   * \returns The current time of the monotonic clock, in ns.
+   */
+  static uint64_t GetRealtime (void);
+  /**
+   * \returns The current normalized real time, in ns.
+   */
+  uint64_t GetNormalizedRealtime (void);
+
+  /** The part of each wait spent spinning. */
+  Time m_spinThreshold;
+  /** The longest \c clock_nanosleep, when there is no \c timerfd. */
+  Time m_maxSleepSlice;
+  /** Time recorded by DoEventStart. */
+  uint64_t m_nsEventStart;
+  /** Flag \c true when the current wait must be interrupted. */
+  std::atomic<bool> m_condition;
+  /** The \c timerfd of the sleeps, or -1. */
+  int m_timerFd;
+  /** The \c eventfd written by DoSignal, or -1. */
+  int m_eventFd;
+};
+
+} // namespace ns3
+
+#endif /* LOW_JITTER_SYNCHRONIZER_H */
@@ -20,6 +20,9 @@
 #ifndef MAKE_EVENT_H
 #define MAKE_EVENT_H
 
+#include "object-base.h"
+#include <type_traits>
+
 /**
  * \file
  * \ingroup events
@@ -355,6 +358,43 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This helper converts an object pointer to an ObjectBase pointer,
+ * for the classes which derive from ObjectBase.
+ *
+ * \tparam T \deduced The class type.
+ * \param [in] p Object pointer.
+ * \return \p p as an ObjectBase pointer.
+ */
+template <typename T>
+typename std::enable_if<std::is_convertible<T *, const ObjectBase *>::value,
+                        const ObjectBase *>::type
+EventMemberImplPeekObject (T *p)
+{
+  return p;
+}
+
+/**
+ * \ingroup makeeventmemptr
+ * Helper for the MakeEvent functions which take a class method.
+ *
+ * This is the overload for the classes which do not derive from
+ * ObjectBase.
+ *
+ * \tparam T \deduced The class type.
+ * \return Zero.
+ */
+template <typename T>
+typename std::enable_if<!std::is_convertible<T *, const ObjectBase *>::value,
+                        const ObjectBase *>::type
+EventMemberImplPeekObject (T *)
+{
+  return 0;
+}
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -375,6 +415,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -405,6 +449,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -436,6 +484,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -469,6 +521,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -504,6 +560,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -542,6 +602,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -582,6 +646,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5, m_a6);
     }
+    virtual const ObjectBase * PeekObject (void) const
+    {
+      return EventMemberImplPeekObject (&EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
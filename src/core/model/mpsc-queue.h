@@ -0,0 +1,221 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "assert.h"
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \brief A bounded lock-free multiple-producer single-consumer queue.
+ *
+ * The items are stored in a ring of preallocated cells, each tagged
+ * with a sequence number which tells whether the cell is ready to be
+ * written by a producer or read by the consumer (this is the bounded
+ * queue of Dmitry Vyukov, restricted to a single consumer).  Push
+ * and Pop never allocate memory and never block: Push fails when the
+ * ring is full, and Pop fails when it is empty.
+ *
+ * Push can be called from any thread, concurrently.  Pop and IsEmpty
+ * must only be called from a single consumer thread at a time.
+ *
+ * \tparam T The item type, which must be copyable and
+ *         default constructible.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The number of cells of the ring, which is
+   *             rounded up to a power of two.
+   */
+  MpscQueue (uint32_t capacity);
+  /** Destructor. */
+  ~MpscQueue ();
+
+  /**
+   * Append an item to the queue.
+   *
+   * \param [in] item The item.
+   * \returns \c false if the queue is full.
+   */
+  bool Push (const T &item);
+  /**
+   * Remove the item at the head of the queue.
+   *
+   * \param [out] item The item removed.
+   * \returns \c false if the queue is empty.
+   */
+  bool Pop (T &item);
+  /**
+   * \returns \c true if there is no item ready to be removed.
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \returns The capacity of the queue.
+   */
+  uint32_t GetCapacity (void) const;
+
+private:
+  /**
+   * Copy constructor.
+   * Defined and unimplemented to avoid misuse.
+   */
+  MpscQueue (const MpscQueue &);
+  /**
+   * Copy assignment operator.
+   * Defined and unimplemented to avoid misuse.
+   * \returns
+   */
+  MpscQueue & operator = (const MpscQueue &);
+
+  /** A cell of the ring. */
+  struct Cell
+  {
+    /**
+     * Equal to the position of the cell when it is free, and to
+     * the position plus one when it holds an item.
+     */
+    std::atomic<uint64_t> sequence;
+    T item;  /**< The item. */
+  };
+
+  Cell *m_cells;                 /**< The ring. */
+  uint64_t m_mask;               /**< The capacity minus one. */
+  /** The position of the next cell to write, shared by the producers. */
+  std::atomic<uint64_t> m_tail;
+  /** The position of the next cell to read, owned by the consumer. */
+  uint64_t m_head;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_tail (0),
+    m_head (0)
+{
+  NS_ASSERT (capacity > 0);
+  uint64_t size = 1;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_cells = new Cell [size];
+  m_mask = size - 1;
+  for (uint64_t i = 0; i < size; i++)
+    {
+      m_cells[i].sequence.store (i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpscQueue<T>::~MpscQueue ()
+{
+  delete [] m_cells;
+  m_cells = 0;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Push (const T &item)
+{
+  uint64_t pos = m_tail.load (std::memory_order_relaxed);
+  for (;;)
+    {
+      Cell &cell = m_cells[pos & m_mask];
+      uint64_t sequence = cell.sequence.load (std::memory_order_acquire);
+      int64_t diff = (int64_t)(sequence - pos);
+      if (diff == 0)
+        {
+          // The cell is free: try to claim it.
+          if (m_tail.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed))
+            {
+              cell.item = item;
+              cell.sequence.store (pos + 1, std::memory_order_release);
+              return true;
+            }
+          // pos has been reloaded by compare_exchange_weak
+        }
+      else if (diff < 0)
+        {
+          // The cell still holds the item pushed one lap earlier.
+          return false;
+        }
+      else
+        {
+          // Another producer claimed the cell first.
+          pos = m_tail.load (std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &item)
+{
+  Cell &cell = m_cells[m_head & m_mask];
+  if (cell.sequence.load (std::memory_order_acquire) != m_head + 1)
+    {
+      return false;
+    }
+  item = cell.item;
+  cell.sequence.store (m_head + m_mask + 1, std::memory_order_release);
+  m_head++;
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  const Cell &cell = m_cells[m_head & m_mask];
+  return cell.sequence.load (std::memory_order_acquire) != m_head + 1;
+}
+
+template <typename T>
+uint32_t
+MpscQueue<T>::GetCapacity (void) const
+{
+  return m_mask + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
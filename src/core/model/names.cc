@@ -16,7 +16,10 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <map>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 #include "object.h"
 #include "log.h"
 #include "assert.h"
@@ -34,6 +37,31 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Names");
 
+namespace {
+
+/**
+ * Grow a hash table ahead of many insertions.
+ *
+ * The table is only grown when the insertions would exceed its
+ * capacity, and then at least doubled, so that a sequence of small
+ * batches does not rehash the table for each batch.
+ *
+ * \param [in,out] map The hash table.
+ * \param [in] n The number of insertions.
+ */
+template <typename Map>
+void
+Reserve (Map &map, std::size_t n)
+{
+  std::size_t size = map.size () + n;
+  if (size > map.bucket_count () * map.max_load_factor ())
+    {
+      map.reserve (std::max (size, 2 * map.size ()));
+    }
+}
+
+} // anonymous namespace
+
 /**
  * \ingroup config
  *  Node in the naming tree.
@@ -53,10 +81,10 @@ public:
    * Constructor.
    *
    * \param [in] parent The parent NameNode.
-   * \param [in] name The name of this NameNode
+   * \param [in] name The interned name of this NameNode
    * \param [in] object The object corresponding to this NameNode.
    */
-  NameNode (NameNode *parent, std::string name, Ptr<Object> object);
+  NameNode (NameNode *parent, const std::string *name, Ptr<Object> object);
   /**
    * Assignment operator.
    *
@@ -70,17 +98,16 @@ public:
 
   /** The parent NameNode. */
   NameNode *m_parent;
-  /** The name of this NameNode. */
-  std::string m_name;
+  /** The name of this NameNode, interned by NamesPriv. */
+  const std::string *m_name;
   /** The object corresponding to this NameNode. */
   Ptr<Object> m_object;
-
-  /** Children of this NameNode. */
-  std::map<std::string, NameNode *> m_nameMap;
+  /** The number of children of this NameNode. */
+  uint32_t m_nChildren;
 };
 
 NameNode::NameNode ()
-  : m_parent (0), m_name (""), m_object (0)
+  : m_parent (0), m_name (0), m_object (0), m_nChildren (0)
 {
 }
 
@@ -89,7 +116,7 @@ NameNode::NameNode (const NameNode &nameNode)
   m_parent = nameNode.m_parent;
   m_name = nameNode.m_name;
   m_object = nameNode.m_object;
-  m_nameMap = nameNode.m_nameMap;
+  m_nChildren = nameNode.m_nChildren;
 }
 
 NameNode &
@@ -98,14 +125,14 @@ NameNode::operator = (const NameNode &rhs)
   m_parent = rhs.m_parent;
   m_name = rhs.m_name;
   m_object = rhs.m_object;
-  m_nameMap = rhs.m_nameMap;
+  m_nChildren = rhs.m_nChildren;
   return *this;
 }
 
-NameNode::NameNode (NameNode *parent, std::string name, Ptr<Object> object)
-  : m_parent (parent), m_name (name), m_object (object)
+NameNode::NameNode (NameNode *parent, const std::string *name, Ptr<Object> object)
+  : m_parent (parent), m_name (name), m_object (object), m_nChildren (0)
 {
-  NS_LOG_FUNCTION (this << parent << name << object);
+  NS_LOG_FUNCTION (this << parent << *name << object);
 }
 
 NameNode::~NameNode ()
@@ -116,6 +143,13 @@ NameNode::~NameNode ()
 /**
  * \ingroup config
  * The singleton root Names object.
+ *
+ * The naming tree is indexed by two hash tables: one from a parent
+ * NameNode and a child name to the child NameNode, and one from an
+ * object to its NameNode.  The names are interned, so that the many
+ * NameNodes sharing a name (such as "eth0") share a single string, and
+ * the child index is keyed by the address of the interned string.
+ * Interned names are only released by Clear().
  */
 class NamesPriv : public Singleton<NamesPriv>
 {
@@ -157,6 +191,29 @@ public:
    * \return \c true if the object was named successfully.
    */
   bool Add (Ptr<Object> context, std::string name, Ptr<Object> object);
+  /**
+   * Internal implementation for
+   * Names::AddMany(std::string,const std::vector<std::pair<std::string,Ptr<Object> > >&)
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined.
+   * \param [in] names The names and the objects to associate.
+   * \return The number of names added, which stops at the first name
+   *          which could not be added.
+   */
+  std::size_t AddMany (std::string path, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
+  /**
+   * Internal implementation for
+   * Names::AddMany(Ptr<Object>,const std::vector<std::pair<std::string,Ptr<Object> > >&)
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined.
+   * \param [in] names The names and the objects to associate.
+   * \return The number of names added, which stops at the first name
+   *          which could not be added.
+   */
+  std::size_t AddMany (Ptr<Object> context, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
 
   /**
    * Internal implementation for Names::Rename(std::string,std::string)
@@ -248,6 +305,14 @@ public:
    *          the requested type.
    */
   Ptr<Object> Find (Ptr<Object> context, std::string name);
+  /**
+   * Internal implementation for ns3::Names::HasChildren(Ptr<Object>)
+   *
+   * \param [in] context The object standing for a level of the name
+   *             space, or 0 for the root of the name space.
+   * \returns \c true if at least one name is defined under \c context.
+   */
+  bool HasChildren (Ptr<Object> context);
 
 private:
   friend class Names;
@@ -267,12 +332,88 @@ private:
    * \returns \c true if \c name already exists as a child of \c node.
    */
   bool IsDuplicateName (NameNode *node, std::string name);
+  /**
+   * Find a child of a NameNode.
+   *
+   * \param [in] node The parent NameNode.
+   * \param [in] name The name of the child.
+   * \returns The child NameNode, or 0 if \c node has no such child.
+   */
+  NameNode *FindChild (NameNode *node, std::string const &name) const;
+  /**
+   * Get the NameNode under which names are defined for a context.
+   *
+   * \param [in] context The context object, or 0 for the root of the
+   *             name space.
+   * \returns The NameNode of the context, or 0 if the context is not
+   *          named.
+   */
+  NameNode *GetContextNode (Ptr<Object> context);
+  /**
+   * Create a new name under a NameNode.
+   *
+   * \param [in] node The parent NameNode.
+   * \param [in] name The name of the object.
+   * \param [in] object The object.
+   * \return \c true if the object was named successfully.
+   */
+  bool Insert (NameNode *node, std::string const &name, Ptr<Object> object);
+  /**
+   * Intern a name.
+   *
+   * \param [in] name The name.
+   * \returns The shared copy of \c name.
+   */
+  const std::string *Intern (std::string const &name);
+
+  /**
+   * A child in the naming tree: the parent NameNode and the name.
+   *
+   * The keys stored in the index point to the interned names, while
+   * the keys of the lookups point to the names searched for, so the
+   * names are hashed and compared by value.
+   */
+  typedef std::pair<const NameNode *, const std::string *> ChildKey;
+  /** Hash of a ChildKey. */
+  struct ChildKeyHash
+  {
+    /**
+     * \param [in] key The ChildKey.
+     * \returns The hash of \c key.
+     */
+    std::size_t operator () (ChildKey const &key) const
+    {
+      std::size_t h = std::hash<const void *> () (key.first);
+      return h ^ (std::hash<std::string> () (*key.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+  /** Equality of two ChildKeys. */
+  struct ChildKeyEqual
+  {
+    /**
+     * \param [in] a The first ChildKey.
+     * \param [in] b The second ChildKey.
+     * \returns \c true if \c a and \c b name the same child.
+     */
+    bool operator () (ChildKey const &a, ChildKey const &b) const
+    {
+      return a.first == b.first && *a.second == *b.second;
+    }
+  };
+  /** Index of the children of all the NameNodes. */
+  typedef std::unordered_map<ChildKey, NameNode *, ChildKeyHash, ChildKeyEqual> ChildMap;
+  /** Index of the NameNodes of the named objects. */
+  typedef std::unordered_map<const Object *, NameNode *> ObjectMap;
 
   /** The root NameNode. */
   NameNode m_root;
 
+  /** The interned names. */
+  std::unordered_set<std::string> m_strings;
+  /** Map from a parent NameNode and a name to the child NameNode. */
+  ChildMap m_childMap;
   /** Map from object pointers to their NameNodes. */
-  std::map<Ptr<Object>, NameNode *> m_objectMap;
+  ObjectMap m_objectMap;
 };
 
 NamesPriv::NamesPriv ()
@@ -280,7 +421,7 @@ NamesPriv::NamesPriv ()
   NS_LOG_FUNCTION (this);
 
   m_root.m_parent = 0;
-  m_root.m_name = "Names";
+  m_root.m_name = Intern ("Names");
   m_root.m_object = 0;
 }
 
@@ -288,7 +429,66 @@ NamesPriv::~NamesPriv ()
 {
   NS_LOG_FUNCTION (this);
   Clear ();
-  m_root.m_name = "";
+}
+
+const std::string *
+NamesPriv::Intern (std::string const &name)
+{
+  return &*m_strings.insert (name).first;
+}
+
+NameNode *
+NamesPriv::FindChild (NameNode *node, std::string const &name) const
+{
+  ChildMap::const_iterator i = m_childMap.find (ChildKey (node, &name));
+  if (i == m_childMap.end ())
+    {
+      return 0;
+    }
+  return i->second;
+}
+
+NameNode *
+NamesPriv::GetContextNode (Ptr<Object> context)
+{
+  if (context == 0)
+    {
+      return &m_root;
+    }
+  return IsNamed (context);
+}
+
+bool
+NamesPriv::Insert (NameNode *node, std::string const &name, Ptr<Object> object)
+{
+  //
+  // Claim the object and the name with the insertions themselves, so that
+  // each index is searched once.
+  //
+  std::pair<ObjectMap::iterator, bool> o =
+    m_objectMap.insert (std::make_pair (PeekPointer (object), static_cast<NameNode *> (0)));
+  if (!o.second)
+    {
+      NS_LOG_LOGIC ("Object is already named");
+      return false;
+    }
+
+  const std::string *interned = Intern (name);
+  std::pair<ChildMap::iterator, bool> c =
+    m_childMap.insert (std::make_pair (ChildKey (node, interned), static_cast<NameNode *> (0)));
+  if (!c.second)
+    {
+      NS_LOG_LOGIC ("Name is already taken");
+      m_objectMap.erase (o.first);
+      return false;
+    }
+
+  NameNode *newNode = new NameNode (node, interned, object);
+  c.first->second = newNode;
+  o.first->second = newNode;
+  ++node->m_nChildren;
+
+  return true;
 }
 
 void
@@ -299,18 +499,20 @@ NamesPriv::Clear (void)
   // Every name is associated with an object in the object map, so freeing the
   // NameNodes in this map will free all of the memory allocated for the NameNodes
   //
-  for (std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
+  for (ObjectMap::iterator i = m_objectMap.begin (); i != m_objectMap.end (); ++i)
     {
       delete i->second;
       i->second = 0;
     }
 
   m_objectMap.clear ();
+  m_childMap.clear ();
+  m_strings.clear ();
 
   m_root.m_parent = 0;
-  m_root.m_name = "Names";
+  m_root.m_name = Intern ("Names");
   m_root.m_object = 0;
-  m_root.m_nameMap.clear ();
+  m_root.m_nChildren = 0;
 }
 
 bool
@@ -391,34 +593,50 @@ NamesPriv::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << context << name << object);
 
-  if (IsNamed (object))
-    {
-      NS_LOG_LOGIC ("Object is already named");
-      return false;
-    }
+  NameNode *node = GetContextNode (context);
+  NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
+  return Insert (node, name, object);
+}
 
-  NameNode *node = 0;
-  if (context)
+std::size_t
+NamesPriv::AddMany (std::string path, const std::vector<std::pair<std::string, Ptr<Object> > > &names)
+{
+  NS_LOG_FUNCTION (this << path << names.size ());
+  if (path == "/Names")
     {
-      node = IsNamed (context);
-      NS_ASSERT_MSG (node, "NamesPriv::Name(): context must point to a previously named node");
+      return AddMany (Ptr<Object> (0, false), names);
     }
-  else
+  Ptr<Object> context = Find (path);
+  if (context == 0)
     {
-      node = &m_root;
+      NS_LOG_LOGIC ("Path does not exist in the name space");
+      return 0;
     }
+  return AddMany (context, names);
+}
+
+std::size_t
+NamesPriv::AddMany (Ptr<Object> context, const std::vector<std::pair<std::string, Ptr<Object> > > &names)
+{
+  NS_LOG_FUNCTION (this << context << names.size ());
 
-  if (IsDuplicateName (node, name))
+  NameNode *node = GetContextNode (context);
+  if (node == 0)
     {
-      NS_LOG_LOGIC ("Name is already taken");
-      return false;
+      NS_LOG_LOGIC ("Context does not point to a previously named node");
+      return 0;
     }
 
-  NameNode *newNode = new NameNode (node, name, object);
-  node->m_nameMap[name] = newNode;
-  m_objectMap[object] = newNode;
+  Reserve (m_childMap, names.size ());
+  Reserve (m_objectMap, names.size ());
 
-  return true;
+  std::size_t added = 0;
+  for (std::vector<std::pair<std::string, Ptr<Object> > >::const_iterator i = names.begin ();
+       i != names.end () && Insert (node, i->first, i->second); ++i)
+    {
+      ++added;
+    }
+  return added;
 }
 
 bool
@@ -518,8 +736,8 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       return false;
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (oldname);
-  if (i == node->m_nameMap.end ())
+  NameNode *changeNode = FindChild (node, oldname);
+  if (changeNode == 0)
     {
       NS_LOG_LOGIC ("Old name does not exist in name map");
       return false;
@@ -535,10 +753,9 @@ NamesPriv::Rename (Ptr<Object> context, std::string oldname, std::string newname
       // 3.  Changing the name string in the name node;
       // 4.  Adding the name node back in the map under the newname.
       //
-      NameNode *changeNode = i->second;
-      node->m_nameMap.erase (i);
-      changeNode->m_name = newname;
-      node->m_nameMap[newname] = changeNode;
+      m_childMap.erase (ChildKey (node, changeNode->m_name));
+      changeNode->m_name = Intern (newname);
+      m_childMap[ChildKey (node, changeNode->m_name)] = changeNode;
       return true;
     }
 }
@@ -548,8 +765,8 @@ NamesPriv::FindName (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *node = IsNamed (object);
+  if (node == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
@@ -557,7 +774,7 @@ NamesPriv::FindName (Ptr<Object> object)
   else
     {
       NS_LOG_LOGIC ("Object exists in object map");
-      return i->second->m_name;
+      return *node->m_name;
     }
 }
 
@@ -566,21 +783,20 @@ NamesPriv::FindPath (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
-  if (i == m_objectMap.end ())
+  NameNode *p = IsNamed (object);
+  if (p == 0)
     {
       NS_LOG_LOGIC ("Object does not exist in object map");
       return "";
     }
 
-  NameNode *p = i->second;
   NS_ASSERT_MSG (p, "NamesPriv::FindFullName(): Internal error: Invalid NameNode pointer from map");
 
   std::string path;
 
   do
     {
-      path = "/" + p->m_name + path;
+      path = "/" + *p->m_name + path;
       NS_LOG_LOGIC ("path is " << path);
     }
   while ((p = p->m_parent) != 0);
@@ -642,8 +858,8 @@ NamesPriv::Find (std::string path)
           // There are no remaining slashes so this is the last segment of the 
           // specified name.  We're done when we find it
           //
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (remaining);
-          if (i == node->m_nameMap.end ())
+          NameNode *child = FindChild (node, remaining);
+          if (child == 0)
             {
               NS_LOG_LOGIC ("Name does not exist in name map");
               return 0;
@@ -651,7 +867,7 @@ NamesPriv::Find (std::string path)
           else
             {
               NS_LOG_LOGIC ("Name parsed, found object");
-              return i->second->m_object;
+              return child->m_object;
             }
         }
       else
@@ -663,15 +879,15 @@ NamesPriv::Find (std::string path)
           offset = remaining.find ("/");
           std::string segment = remaining.substr (0, offset);
 
-          std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (segment);
-          if (i == node->m_nameMap.end ())
+          NameNode *child = FindChild (node, segment);
+          if (child == 0)
             {
               NS_LOG_LOGIC ("Name does not exist in name map");
               return 0;
             }
           else
             {
-              node = i->second;
+              node = child;
               remaining = remaining.substr (offset + 1);
               NS_LOG_LOGIC ("Intermediate segment parsed");
               continue;
@@ -717,8 +933,8 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
         }
     }
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  NameNode *child = FindChild (node, name);
+  if (child == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return 0;
@@ -726,8 +942,20 @@ NamesPriv::Find (Ptr<Object> context, std::string name)
   else
     {
       NS_LOG_LOGIC ("Name exists in name map");
-      return i->second->m_object;
+      return child->m_object;
+    }
+}
+
+bool
+NamesPriv::HasChildren (Ptr<Object> context)
+{
+  NS_LOG_FUNCTION (this << context);
+  if (m_objectMap.empty ())
+    {
+      return false;
     }
+  NameNode *node = GetContextNode (context);
+  return node != 0 && node->m_nChildren != 0;
 }
 
 NameNode *
@@ -735,7 +963,7 @@ NamesPriv::IsNamed (Ptr<Object> object)
 {
   NS_LOG_FUNCTION (this << object);
 
-  std::map<Ptr<Object>, NameNode *>::iterator i = m_objectMap.find (object);
+  ObjectMap::iterator i = m_objectMap.find (PeekPointer (object));
   if (i == m_objectMap.end ())
     {
       NS_LOG_LOGIC ("Object does not exist in object map, returning NameNode 0");
@@ -753,8 +981,7 @@ NamesPriv::IsDuplicateName (NameNode *node, std::string name)
 {
   NS_LOG_FUNCTION (this << node << name);
 
-  std::map<std::string, NameNode *>::iterator i = node->m_nameMap.find (name);
-  if (i == node->m_nameMap.end ())
+  if (FindChild (node, name) == 0)
     {
       NS_LOG_LOGIC ("Name does not exist in name map");
       return false;
@@ -806,6 +1033,23 @@ Names::Add (Ptr<Object> context, std::string name, Ptr<Object> object)
   NS_ABORT_MSG_UNLESS (result, "Names::Add(): Error adding name " << name << " under context " << &context);
 }
 
+void
+Names::AddMany (std::string path, const std::vector<std::pair<std::string, Ptr<Object> > > &names)
+{
+  NS_LOG_FUNCTION (path << names.size ());
+  std::size_t added = NamesPriv::Get ()->AddMany (path, names);
+  NS_ABORT_MSG_UNLESS (added == names.size (), "Names::AddMany(): Error adding " << path << " " << names[added].first);
+}
+
+void
+Names::AddMany (Ptr<Object> context, const std::vector<std::pair<std::string, Ptr<Object> > > &names)
+{
+  NS_LOG_FUNCTION (context << names.size ());
+  std::size_t added = NamesPriv::Get ()->AddMany (context, names);
+  NS_ABORT_MSG_UNLESS (added == names.size (), "Names::AddMany(): Error adding name " << names[added].first << " under context " <<
+                       &context);
+}
+
 void
 Names::Rename (Ptr<Object> context, std::string oldname, std::string newname)
 {
@@ -829,6 +1073,13 @@ Names::FindPath (Ptr<Object> object)
   return NamesPriv::Get ()->FindPath (object);
 }
 
+bool
+Names::HasChildren (Ptr<Object> context)
+{
+  NS_LOG_FUNCTION (context);
+  return NamesPriv::Get ()->HasChildren (context);
+}
+
 void
 Names::Clear (void)
 {
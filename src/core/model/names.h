@@ -19,6 +19,9 @@
 #ifndef OBJECT_NAMES_H
 #define OBJECT_NAMES_H
 
+#include <string>
+#include <utility>
+#include <vector>
 #include "ptr.h"
 #include "object.h"
 
@@ -171,6 +174,42 @@ public:
    */
   static void Add (Ptr<Object> context, std::string name, Ptr<Object> object);
 
+  /**
+   * \brief Add many names under the same parent object, given by a
+   * name path string.
+   *
+   * This behaves like calling Names::Add (path, name, object) for
+   * each of the names, but the path is resolved once and the name
+   * space indices are grown once, which makes it the method of choice
+   * to register the names of a large topology.  The names are added
+   * in order, and the program aborts on the first one which cannot be
+   * added (an object which is already named, or a duplicate name).
+   *
+   * \param [in] path A path name describing a previously named object
+   *             under which you want the new names to be defined, or
+   *             "/Names" for the root of the name space.
+   * \param [in] names The names and the objects to associate.
+   *
+   * \see Names::Add (std::string,std::string,Ptr<Object>);
+   */
+  static void AddMany (std::string path, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
+
+  /**
+   * \brief Add many names under the same parent object.
+   *
+   * This is the context form of
+   * Names::AddMany (std::string,const std::vector<std::pair<std::string,Ptr<Object> > >&).
+   *
+   * \param [in] context A smart pointer to an object that is used
+   *             in place of the path under which you want the new
+   *             names to be defined, or 0 for the root of the name
+   *             space.
+   * \param [in] names The names and the objects to associate.
+   *
+   * \see Names::Add (Ptr<Object>,std::string,Ptr<Object>);
+   */
+  static void AddMany (Ptr<Object> context, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
+
   /**
    * \brief Rename a previously associated name.
    *
@@ -315,6 +354,19 @@ public:
    */
   static std::string FindPath (Ptr<Object> object);
 
+  /**
+   * \brief Check whether any name is defined under an object.
+   *
+   * This is a constant time test, which the Config path resolver uses
+   * to skip the name lookups of the unnamed objects it walks through.
+   *
+   * \param [in] context A smart pointer to an object standing for a
+   *             level of the name space, or 0 for the root of the
+   *             name space.
+   * \returns \c true if at least one name is defined under \c context.
+   */
+  static bool HasChildren (Ptr<Object> context);
+
   /**
    * \brief Clear the list of objects associated with names.
    */
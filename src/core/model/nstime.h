@@ -447,6 +447,10 @@ public:
       {
         value *= info->factor;
       }
+    else if (value <= static_cast<uint64_t> (std::numeric_limits<int64_t>::max ()))
+      {
+        value = DivideByFactor (static_cast<int64_t> (value), info);
+      }
     else
       {
         value /= info->factor;
@@ -496,6 +500,10 @@ public:
       {
         v *= info->factor;
       }
+    else if (v != std::numeric_limits<int64_t>::min ())
+      {
+        v = DivideByFactor (v, info);
+      }
     else
       {
         v /= info->factor;
@@ -504,6 +512,15 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
+    // The integers of up to 53 bits and the factors are exact
+    // doubles, so one multiply or divide gives the nearest double.
+    const int64_t exact = (int64_t)1 << 53;
+    if (m_data > -exact && m_data < exact)
+      {
+        struct Information *info = PeekInformation (unit);
+        double v = static_cast<double> (m_data);
+        return info->toMul ? v * info->doubleFactor : v / info->doubleFactor;
+      }
     return To (unit).GetDouble ();
   }
   inline int64x64_t To (enum Unit unit) const
@@ -554,6 +571,9 @@ private:
     int64_t factor;                 //!< Ratio of this unit / current unit
     int64x64_t timeTo;              //!< Multiplier to convert to this unit
     int64x64_t timeFrom;            //!< Multiplier to convert from this unit
+    uint64_t divMagic;              //!< Reciprocal of factor, see DivideByFactor()
+    int divShift;                   //!< Shift to apply after multiplying by divMagic
+    double doubleFactor;            //!< factor as a double
   };
   /** Current time unit, and conversion info. */
   struct Resolution
@@ -583,6 +603,32 @@ private:
     return & (PeekResolution ()->info[timeUnit]);
   }
 
+  /**
+   *  Divide by the factor of a unit.
+   *
+   *  Where 128-bit integers are available, the quotient is the high
+   *  part of the product by a precomputed reciprocal (Granlund and
+   *  Montgomery, "Division by invariant integers using
+   *  multiplication", 1994), rather than a hardware division.  The
+   *  product rounds down, and is always below the true quotient for
+   *  the negative dividends: adding their sign bit rounds it toward
+   *  zero, like the division, without a branch.
+   *
+   *  \param [in] value The dividend, above \f$-2^{63}\f$.
+   *  \param [in] info The Information record of the unit.
+   *  \return \p value divided by the factor of the unit, rounded toward zero.
+   */
+  static inline int64_t DivideByFactor (int64_t value, const struct Information *info)
+  {
+#if defined (INT64X64_USE_128) && !defined (PYTHON_SCAN)
+    int128_t product = static_cast<int128_t> (value) * static_cast<int128_t> (info->divMagic);
+    return static_cast<int64_t> (product >> info->divShift)
+      + static_cast<int64_t> (static_cast<uint64_t> (value) >> 63);
+#else
+    return value / info->factor;
+#endif
+  }
+
   /**
    *  Set the default resolution
    *
@@ -598,6 +644,12 @@ private:
    */
   static void SetResolution (enum Unit unit, struct Resolution *resolution,
                              const bool convert = true);
+  /**
+   *  Compute the reciprocal of the factor of a unit, for DivideByFactor().
+   *
+   *  \param [in,out] info The Information record to update.
+   */
+  static void SetReciprocal (struct Information *info);
 
   /**
    *  Record all instances of Time, so we can rescale them when
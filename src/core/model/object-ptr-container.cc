@@ -127,6 +127,18 @@ ObjectPtrContainerAccessor::Get (const ObjectBase * object, AttributeValue &valu
     }
   return true;
 }
+bool
+ObjectPtrContainerAccessor::GetN (const ObjectBase *object, std::size_t *n) const
+{
+  NS_LOG_FUNCTION (this << object << n);
+  return DoGetN (object, n);
+}
+Ptr<Object>
+ObjectPtrContainerAccessor::Get (const ObjectBase *object, std::size_t i, std::size_t *index) const
+{
+  NS_LOG_FUNCTION (this << object << i << index);
+  return DoGet (object, i, index);
+}
 bool 
 ObjectPtrContainerAccessor::HasGetter (void) const
 {
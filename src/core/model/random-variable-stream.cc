@@ -73,7 +73,9 @@ RandomVariableStream::GetTypeId (void)
 }
 
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_rngStream (0),
+    m_rngResetCount (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -108,9 +110,7 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t nextStream = RngSeedManager::GetNextStreamIndex ();
       NS_ASSERT(nextStream <= ((1ULL)<<63));
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             nextStream,
-                             RngSeedManager::GetRun ());
+      m_rngStream = nextStream;
     }
   else
     {
@@ -118,10 +118,12 @@ RandomVariableStream::SetStream (int64_t stream)
       // number assignment.
       uint64_t base = ((1ULL)<<63);
       uint64_t target = base + stream;
-      m_rng = new RngStream (RngSeedManager::GetSeed (),
-                             target,
-                             RngSeedManager::GetRun ());
+      m_rngStream = target;
     }
+  m_rng = new RngStream (RngSeedManager::GetSeed (),
+                         m_rngStream,
+                         RngSeedManager::GetRun ());
+  m_rngResetCount = RngSeedManager::GetResetCount ();
   m_stream = stream;
 }
 int64_t
@@ -135,6 +137,14 @@ RngStream *
 RandomVariableStream::Peek(void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_rngResetCount != RngSeedManager::GetResetCount ())
+    {
+      delete m_rng;
+      m_rng = new RngStream (RngSeedManager::GetSeed (),
+                             m_rngStream,
+                             RngSeedManager::GetRun ());
+      m_rngResetCount = RngSeedManager::GetResetCount ();
+    }
   return m_rng;
 }
 
@@ -178,8 +178,17 @@ private:
    */
   RandomVariableStream &operator = (const RandomVariableStream &o);
 
-  /** Pointer to the underlying RngStream. */
-  RngStream *m_rng;
+  /**
+   * Pointer to the underlying RngStream.
+   * It is recreated by Peek after RngSeedManager::ResetStreams.
+   */
+  mutable RngStream *m_rng;
+
+  /** The index of the underlying RngStream. */
+  uint64_t m_rngStream;
+
+  /** The value of RngSeedManager::GetResetCount when m_rng was created. */
+  mutable uint64_t m_rngResetCount;
 
   /** Indicates if antithetic values should be generated by this RNG stream. */
   bool m_isAntithetic;
@@ -31,9 +31,14 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "object-factory.h"
 
 
+#include <algorithm>
 #include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
 
 
 /**
@@ -69,6 +74,19 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("SynchronizerType",
+                   "The type of the Synchronizer which waits for the real "
+                   "time of the events.",
+                   TypeIdValue (WallClockSynchronizer::GetTypeId ()),
+                   MakeTypeIdAccessor (&RealtimeSimulatorImpl::SetSynchronizerType,
+                                       &RealtimeSimulatorImpl::GetSynchronizerType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("PrintLateness",
+                   "Print the histogram of the lateness of the events "
+                   "at Simulator::Destroy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RealtimeSimulatorImpl::m_printLateness),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
@@ -96,6 +114,10 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   // Be very careful not to do anything that would cause a change or assignment
   // of the underlying reference counts of m_synchronizer or you will be sorry.
   m_synchronizer = CreateObject<WallClockSynchronizer> ();
+
+  // One range per bit of the lateness, plus the on time events.
+  m_lateness.resize (65, 0);
+  m_maxLateness = 0;
 }
 
 RealtimeSimulatorImpl::~RealtimeSimulatorImpl ()
@@ -140,6 +162,10 @@ RealtimeSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_printLateness)
+    {
+      PrintLateness (std::cout);
+    }
 }
 
 void
@@ -359,20 +385,29 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     // We check the simulation time against the current real time to make this
     // judgement.
     //
-    if (m_synchronizationMode == SYNC_HARD_LIMIT)
-      {
-        uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
-        uint64_t tsJitter;
+    uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
+    uint64_t tsJitter;
 
-        if (tsFinal >= m_currentTs)
-          {
-            tsJitter = tsFinal - m_currentTs;
-          }
-        else
+    if (tsFinal >= m_currentTs)
+      {
+        tsJitter = tsFinal - m_currentTs;
+        // Like the real time, the timesteps are in ns here.
+        uint32_t range = 0;
+        while (range < 64 && (tsJitter >> range) != 0)
           {
-            tsJitter = m_currentTs - tsFinal;
+            range++;
           }
+        m_lateness[range]++;
+        m_maxLateness = std::max (m_maxLateness, tsJitter);
+      }
+    else
+      {
+        tsJitter = m_currentTs - tsFinal;
+        m_lateness[0]++;
+      }
 
+    if (m_synchronizationMode == SYNC_HARD_LIMIT)
+      {
         if (tsJitter > static_cast<uint64_t> (m_hardLimit.GetTimeStep ()))
           {
             NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
@@ -846,4 +881,86 @@ RealtimeSimulatorImpl::GetHardLimit (void) const
   return m_hardLimit;
 }
 
+void
+RealtimeSimulatorImpl::SetSynchronizerType (TypeId tid)
+{
+  NS_LOG_FUNCTION (this << tid);
+  NS_ASSERT_MSG (!m_running, "RealtimeSimulatorImpl::SetSynchronizerType(): Simulator running");
+  if (!tid.IsChildOf (Synchronizer::GetTypeId ()))
+    {
+      NS_FATAL_ERROR ("RealtimeSimulatorImpl::SetSynchronizerType(): " <<
+                      tid.GetName () << " is not a Synchronizer");
+    }
+  ObjectFactory factory;
+  factory.SetTypeId (tid);
+  m_synchronizer = factory.Create<Synchronizer> ();
+}
+
+TypeId
+RealtimeSimulatorImpl::GetSynchronizerType (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_synchronizer->GetInstanceTypeId ();
+}
+
+std::vector<uint64_t>
+RealtimeSimulatorImpl::GetLatenessHistogram (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lateness;
+}
+
+Time
+RealtimeSimulatorImpl::GetMaxLateness (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return NanoSeconds (m_maxLateness);
+}
+
+void
+RealtimeSimulatorImpl::PrintLateness (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this << &os);
+  uint64_t count = 0;
+  for (std::vector<uint64_t>::const_iterator i = m_lateness.begin (); i != m_lateness.end (); ++i)
+    {
+      count += *i;
+    }
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::setprecision (2);
+  os << "Event lateness: " << count << " events, max " << m_maxLateness << " ns ("
+     << (m_hardLimit.IsStrictlyPositive () ?
+         100.0 * m_maxLateness / m_hardLimit.GetNanoSeconds () : 0)
+     << "% of HardLimit)" << std::endl;
+  os << std::right
+     << std::setw (24) << "Lateness (ns)"
+     << std::setw (12) << "Events"
+     << std::setw (10) << "Cumul. %" << std::endl;
+  uint64_t cumulative = 0;
+  for (uint32_t range = 0; range < m_lateness.size (); range++)
+    {
+      if (m_lateness[range] == 0)
+        {
+          continue;
+        }
+      cumulative += m_lateness[range];
+      std::ostringstream bounds;
+      if (range == 0)
+        {
+          bounds << "0";
+        }
+      else
+        {
+          bounds << (uint64_t (1) << (range - 1)) << " - "
+                 << ((uint64_t (1) << (range - 1)) * 2 - 1);
+        }
+      os << std::setw (24) << bounds.str ()
+         << std::setw (12) << m_lateness[range]
+         << std::setw (10) << 100.0 * cumulative / count << std::endl;
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
 } // namespace ns3
@@ -32,6 +32,8 @@
 #include "system-mutex.h"
 
 #include <list>
+#include <ostream>
+#include <vector>
 
 /**
  * \file
@@ -52,6 +54,12 @@ namespace ns3 {
  * \ingroup realtime
  *
  * Realtime version of SimulatorImpl.
+ *
+ * The simulator waits for the real time of each event through a
+ * Synchronizer, selected by the \c SynchronizerType attribute.  It
+ * keeps a histogram of how late the events are executed, which
+ * GetLatenessHistogram returns, and which is printed by
+ * Simulator::Destroy when the \c PrintLateness attribute is set.
  */
 class RealtimeSimulatorImpl : public SimulatorImpl
 {
@@ -154,6 +162,45 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /**
+   * Set the type of the Synchronizer, which replaces the current one.
+   * This can't be done while the simulator is running.
+   *
+   * \param [in] tid The TypeId of a subclass of Synchronizer.
+   */
+  void SetSynchronizerType (TypeId tid);
+  /**
+   * Get the type of the Synchronizer.
+   *
+   * \returns The TypeId of the Synchronizer.
+   */
+  TypeId GetSynchronizerType (void) const;
+
+  /**
+   * Get the histogram of the lateness of the events, that is of the
+   * difference between the real time at which each event was
+   * executed and its simulation time.
+   *
+   * Element 0 counts the events executed on time (or early), and
+   * element \c k > 0 the events late by \c 2^(k-1) to \c 2^k - 1 ns.
+   *
+   * \returns The number of events in each lateness range.
+   */
+  std::vector<uint64_t> GetLatenessHistogram (void) const;
+  /**
+   * Get the largest lateness of an event.
+   *
+   * \returns The largest lateness.
+   */
+  Time GetMaxLateness (void) const;
+  /**
+   * Print the histogram of the lateness of the events, and how the
+   * largest lateness compares with the hard limit.
+   *
+   * \param [in] os The output stream.
+   */
+  void PrintLateness (std::ostream &os) const;
+
 private:
   /**
    * Is the simulator running?
@@ -216,6 +263,16 @@ private:
   /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
   Time m_hardLimit;
 
+  /**
+   * The histogram of the event lateness, in power of two ranges of ns.
+   * \see GetLatenessHistogram
+   */
+  std::vector<uint64_t> m_lateness;
+  /** The largest event lateness, in ns. */
+  uint64_t m_maxLateness;
+  /** Flag \c true to print the lateness histogram at Destroy. */
+  bool m_printLateness;
+
   /** Main SystemThread. */
   SystemThread::ThreadId m_main;
 };
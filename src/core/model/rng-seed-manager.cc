@@ -40,6 +40,11 @@ NS_LOG_COMPONENT_DEFINE ("RngSeedManager");
  * for automatic assignment.
  */
 static uint64_t g_nextStreamIndex = 0;
+/**
+ * \relates RngSeedManager
+ * The number of calls to RngSeedManager::ResetStreams.
+ */
+static uint64_t g_resetCount = 0;
 /**
  * \relates RngSeedManager
  * The random number generator seed number global value.  This is used to
@@ -105,4 +110,15 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+void RngSeedManager::ResetStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_resetCount++;
+}
+
+uint64_t RngSeedManager::GetResetCount (void)
+{
+  return g_resetCount;
+}
+
 } // namespace ns3
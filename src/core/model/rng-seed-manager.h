@@ -105,6 +105,30 @@ public:
    */
   static uint64_t GetNextStreamIndex(void);
 
+  /**
+   * \brief Restart the existing RandomVariableStream objects with the
+   * current seed and run number.
+   *
+   * SetSeed and SetRun only apply to the streams instantiated
+   * afterwards.  After this call, each existing stream draws its next
+   * values as if it had just been instantiated with its stream number
+   * and the current seed and run number.  This is useful to give
+   * different runs to the processes forked by Simulator::ForkAt:
+   * \code
+   *   uint32_t i = Simulator::ForkAt (Seconds (10), 4);
+   *   RngSeedManager::SetRun (i + 1);
+   *   RngSeedManager::ResetStreams ();
+   * \endcode
+   */
+  static void ResetStreams (void);
+
+  /**
+   * \internal
+   * Get the number of calls to ResetStreams.
+   * \returns The number of resets.
+   */
+  static uint64_t GetResetCount (void);
+
 };
 
 /** Alias for compatibility. */
@@ -32,13 +32,21 @@
 #include "assert.h"
 #include "log.h"
 
+#include <cerrno>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <list>
 #include <vector>
 #include <iostream>
 #include <iomanip>
 
+#if defined (HAVE_UNISTD_H) && defined (HAVE_SYS_WAIT_H)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 /**
  * \file
  * \ingroup simulator
@@ -245,6 +253,57 @@ Simulator::Stop (Time const &delay)
   GetImpl ()->Stop (delay);
 }
 
+uint32_t
+Simulator::ForkAt (Time const &time, uint32_t n)
+{
+  NS_LOG_FUNCTION (time << n);
+  NS_ASSERT_MSG (time >= Now (), "Simulator::ForkAt: checkpoint in the past");
+  Stop (time - Now ());
+  Run ();
+
+#if defined (HAVE_UNISTD_H) && defined (HAVE_SYS_WAIT_H)
+  // Do not let the children write again what the parent has buffered.
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  std::vector<pid_t> children;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("Simulator::ForkAt: fork failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          NS_LOG_LOGIC ("child " << i << " continues at " << Now ());
+          return i;
+        }
+      children.push_back (pid);
+    }
+  for (std::vector<pid_t>::const_iterator i = children.begin (); i != children.end (); ++i)
+    {
+      int status;
+      while (waitpid (*i, &status, 0) < 0)
+        {
+          if (errno != EINTR)
+            {
+              NS_FATAL_ERROR ("Simulator::ForkAt: waitpid failed: " << std::strerror (errno));
+            }
+        }
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          NS_LOG_WARN ("child process " << *i << " failed");
+        }
+    }
+  return n;
+#else
+  NS_FATAL_ERROR ("Simulator::ForkAt is not supported on this platform");
+  return n;
+#endif
+}
+
 Time
 Simulator::Now (void)
 {
@@ -166,6 +166,44 @@ public:
    */
   static void Stop (const Time &delay);
 
+  /**
+   * Run the simulation up to a checkpoint, then fork child processes
+   * which each continue it from there.
+   *
+   * This lets a parameter sweep share the warm-up of its scenario
+   * (association, address resolution, routing convergence, TCP slow
+   * start): the events up to \p time run once, in the calling process,
+   * which then forks \p n copies of itself.  Each child returns from
+   * ForkAt with its index, changes whatever its sweep point needs, and
+   * calls Simulator::Run again to continue.  The parent process
+   * waits for all the children to exit, and then returns \p n.
+   *
+   * \code
+   *   uint32_t i = Simulator::ForkAt (Seconds (10), 4);
+   *   if (i == 4)
+   *     {
+   *       return 0;  // the parent: all the sweep points are done
+   *     }
+   *   RngSeedManager::SetRun (i + 1);
+   *   RngSeedManager::ResetStreams ();
+   *   Config::Set ("/NodeList/0/DeviceList/0/DataRate", StringValue (rates[i]));
+   *   Simulator::Run ();
+   *   Simulator::Destroy ();
+   * \endcode
+   *
+   * The events scheduled at \p time itself run in the children.
+   * Output streams and files are shared with the parent, so each
+   * child should write its results to its own files.  This relies on
+   * the POSIX fork, and must not be used with the simulator
+   * implementations which use threads or MPI.
+   *
+   * \param [in] time The checkpoint time, absolute.
+   * \param [in] n The number of child processes.
+   * \returns The index of the child process, in [0, \p n), in the
+   *          children, or \p n in the parent.
+   */
+  static uint32_t ForkAt (const Time &time, uint32_t n);
+
   /**
    * Get the current simulation context.
    *
@@ -184,6 +184,29 @@ Time::SetResolution (enum Unit resolution)
 }
 
 
+// static
+void
+Time::SetReciprocal (struct Information *info)
+{
+  NS_LOG_FUNCTION (info);
+  // With l = ceil (log2 (factor)) and N = 63 bits of dividend,
+  // m = floor (2^(N+l) / factor) + 1 fits in 64 bits, and
+  // floor (n / factor) == floor (n * m / 2^(N+l)) for all n < 2^N;
+  // for -2^N < n < 0, the product is just below n / factor.
+  uint64_t d = static_cast<uint64_t> (info->factor);
+  int l = 0;
+  while (l < 64 && (static_cast<uint64_t> (1) << l) < d)
+    {
+      l++;
+    }
+  info->divShift = 63 + l;
+#if defined (INT64X64_USE_128) && !defined (PYTHON_SCAN)
+  info->divMagic = static_cast<uint64_t> ((static_cast<uint128_t> (1) << info->divShift) / d) + 1;
+#else
+  info->divMagic = 0;
+#endif
+}
+
 // static
 void
 Time::SetResolution (enum Unit unit, struct Resolution *resolution,
@@ -222,6 +245,8 @@ Time::SetResolution (enum Unit unit, struct Resolution *resolution,
       NS_LOG_DEBUG ("SetResolution factor " << factor << " real factor " << realFactor);
       struct Information *info = &resolution->info[i];
       info->factor = factor;
+      info->doubleFactor = static_cast<double> (factor);
+      SetReciprocal (info);
       // here we could equivalently check for realFactor == 1.0 but it's better
       // to avoid checking equality of doubles
       if (shift == 0 && quotient == 1)
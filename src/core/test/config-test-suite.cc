@@ -830,6 +830,127 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the resolution of vector indexes and Config::ConnectMany.
+ */
+class ConnectManyConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  ConnectManyConfigTestCase ();
+  /** Destructor. */
+  virtual ~ConnectManyConfigTestCase () {}
+
+  /**
+   * First trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void Trace1 (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    NS_UNUSED (newValue);
+    m_count1++;
+    m_path = path;
+  }
+  /**
+   * Second trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void Trace2 (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (path);
+    NS_UNUSED (old);
+    NS_UNUSED (newValue);
+    m_count2++;
+  }
+  /**
+   * Trace callback without context.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void Trace3 (int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    NS_UNUSED (newValue);
+    m_count3++;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  uint32_t m_count1; //!< Calls of Trace1.
+  uint32_t m_count2; //!< Calls of Trace2.
+  uint32_t m_count3; //!< Calls of Trace3.
+  std::string m_path; //!< The context path of Trace1.
+};
+
+ConnectManyConfigTestCase::ConnectManyConfigTestCase ()
+  : TestCase ("Check the resolution of vector indexes and Config::ConnectMany")
+{
+}
+
+void
+ConnectManyConfigTestCase::DoRun (void)
+{
+  //
+  // Name the object holding the vector, so that the objects which earlier
+  // test cases left under the root namespace don't match.
+  //
+  Ptr<ConfigTestObject> b = CreateObject<ConfigTestObject> ();
+  Names::Add ("ConnectManyConfigTestCase", b);
+  std::vector<Ptr<ConfigTestObject> > objects;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      objects.push_back (CreateObject<ConfigTestObject> ());
+      b->AddNodeB (objects.back ());
+    }
+
+  //
+  // Overlapping and out of range indexes match each object once, in order.
+  //
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/ConnectManyConfigTestCase/NodesB/[3-4]|4|0|[1-1]|9|[7-20]");
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 4, "Unexpected number of matches");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (0), "/Names/ConnectManyConfigTestCase/NodesB/0/", "Unexpected match");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (1), "/Names/ConnectManyConfigTestCase/NodesB/1/", "Unexpected match");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (2), "/Names/ConnectManyConfigTestCase/NodesB/3/", "Unexpected match");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetMatchedPath (3), "/Names/ConnectManyConfigTestCase/NodesB/4/", "Unexpected match");
+  NS_TEST_EXPECT_MSG_EQ (matches.Get (2), objects[3], "Unexpected object");
+  matches = Config::LookupMatches ("/Names/ConnectManyConfigTestCase/NodesB/*");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 6, "Unexpected number of matches");
+  matches = Config::LookupMatches ("/Names/ConnectManyConfigTestCase/NodesB/6");
+  NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 0, "Unexpected number of matches");
+
+  //
+  // Connect two callbacks with context and one without, in one resolution.
+  //
+  std::vector<std::pair<std::string, CallbackBase> > sinks;
+  sinks.push_back (std::make_pair ("Source", MakeCallback (&ConnectManyConfigTestCase::Trace1, this)));
+  sinks.push_back (std::make_pair ("Source", MakeCallback (&ConnectManyConfigTestCase::Trace2, this)));
+  Config::ConnectMany ("/Names/ConnectManyConfigTestCase/NodesB/[0-1]|5", sinks);
+  sinks.clear ();
+  sinks.push_back (std::make_pair ("Source", MakeCallback (&ConnectManyConfigTestCase::Trace3, this)));
+  Config::ConnectManyWithoutContext ("/Names/ConnectManyConfigTestCase/NodesB/5", sinks);
+
+  m_count1 = 0;
+  m_count2 = 0;
+  m_count3 = 0;
+  objects[2]->SetAttribute ("Source", IntegerValue (-1));
+  NS_TEST_EXPECT_MSG_EQ (m_count1 + m_count2 + m_count3, 0, "Trace 2 fired unexpectedly");
+  objects[5]->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_EXPECT_MSG_EQ (m_count1, 1, "Trace 5 did not fire the first callback");
+  NS_TEST_EXPECT_MSG_EQ (m_count2, 1, "Trace 5 did not fire the second callback");
+  NS_TEST_EXPECT_MSG_EQ (m_count3, 1, "Trace 5 did not fire the callback without context");
+  NS_TEST_EXPECT_MSG_EQ (m_path, "/Names/ConnectManyConfigTestCase/NodesB/5/Source",
+                         "Trace 5 did not provide expected context");
+
+  Names::Clear ();
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +969,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new ConnectManyConfigTestCase);
 }
 
 /**
@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/event-profiler.h"
+#include "ns3/make-event.h"
+#include "ns3/event-impl.h"
+#include "ns3/object.h"
+
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup events
+ * \ingroup event-profiler-tests
+ * EventProfiler test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup event-profiler-tests EventProfiler test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup event-profiler-tests
+ * An Object with event handlers.
+ */
+class EventProfilerTestObject : public Object
+{
+public:
+  /**
+   * \brief Register this type.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::tests::EventProfilerTestObject")
+      .SetParent<Object> ()
+      .SetGroupName ("Core")
+      .HideFromDocumentation ()
+    ;
+    return tid;
+  }
+  /** Handler without argument. */
+  void Tick (void)
+  {
+  }
+  /** Handler with an argument. */
+  void Tock (int)
+  {
+  }
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * A class which does not derive from ObjectBase.
+ */
+class EventProfilerTestPlain
+{
+public:
+  /** Handler without argument. */
+  void Tick (void)
+  {
+  }
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * Function handler.
+ */
+void
+EventProfilerTestFunction (int)
+{
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * Check the grouping of the events by handler and TypeId.
+ */
+class EventProfilerTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Invoke an event through the profiler, and release it.
+   * \param [in] event The event.
+   */
+  void Invoke (EventImpl *event);
+  /**
+   * Find the count of a profile entry.
+   * \param [in] entries The profile.
+   * \param [in] handler The handler name.
+   * \param [in] typeId The TypeId name.
+   * \returns The count of the entry, or zero if there is none.
+   */
+  uint64_t GetCount (const std::vector<EventProfiler::Entry> &entries,
+                     std::string handler, std::string typeId);
+
+  EventProfiler m_profiler;  //!< The profiler under test.
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the event profile")
+{
+}
+
+void
+EventProfilerTestCase::Invoke (EventImpl *event)
+{
+  m_profiler.Invoke (event);
+  event->Unref ();
+}
+
+uint64_t
+EventProfilerTestCase::GetCount (const std::vector<EventProfiler::Entry> &entries,
+                                 std::string handler, std::string typeId)
+{
+  for (std::vector<EventProfiler::Entry>::const_iterator i = entries.begin ();
+       i != entries.end (); ++i)
+    {
+      if (i->handler == handler && i->typeId == typeId)
+        {
+          return i->count;
+        }
+    }
+  return 0;
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  Ptr<EventProfilerTestObject> object = CreateObject<EventProfilerTestObject> ();
+  EventProfilerTestPlain plain;
+  for (int i = 0; i < 3; i++)
+    {
+      Invoke (MakeEvent (&EventProfilerTestObject::Tick, object));
+    }
+  for (int i = 0; i < 2; i++)
+    {
+      Invoke (MakeEvent (&EventProfilerTestObject::Tock, PeekPointer (object), i));
+    }
+  Invoke (MakeEvent (&EventProfilerTestPlain::Tick, &plain));
+  Invoke (MakeEvent (&EventProfilerTestFunction, 1));
+  EventImpl *cancelled = MakeEvent (&EventProfilerTestObject::Tick, object);
+  cancelled->Cancel ();
+  Invoke (cancelled);
+
+  std::vector<EventProfiler::Entry> entries = m_profiler.GetEntries ();
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), 4, "Wrong number of handlers");
+  NS_TEST_EXPECT_MSG_EQ (GetCount (entries, "void (ns3::tests::EventProfilerTestObject::*)()",
+                                   "ns3::tests::EventProfilerTestObject"),
+                         3, "Wrong count for a method of an Object");
+  NS_TEST_EXPECT_MSG_EQ (GetCount (entries, "void (ns3::tests::EventProfilerTestObject::*)(int)",
+                                   "ns3::tests::EventProfilerTestObject"),
+                         2, "Wrong count for a method of an Object with a raw pointer");
+  NS_TEST_EXPECT_MSG_EQ (GetCount (entries, "void (ns3::tests::EventProfilerTestPlain::*)()", ""),
+                         1, "Wrong count for a method of another class");
+  NS_TEST_EXPECT_MSG_EQ (GetCount (entries, "void (*)(int)", ""),
+                         1, "Wrong count for a function");
+  for (std::size_t i = 1; i < entries.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (entries[i - 1].seconds, entries[i].seconds,
+                                   "Profile not ranked by time");
+    }
+
+  std::ostringstream os;
+  m_profiler.Print (os);
+  NS_TEST_EXPECT_MSG_NE (os.str ().find ("ns3::tests::EventProfilerTestObject: void"),
+                         std::string::npos, "Handler missing from the table");
+
+  m_profiler.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (m_profiler.GetEntries ().size (), 0, "Profile not cleared");
+}
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfiler test suite.
+ */
+class EventProfilerTestSuite : public TestSuite
+{
+public:
+  EventProfilerTestSuite ()
+    : TestSuite ("event-profiler")
+  {
+    AddTestCase (new EventProfilerTestCase ());
+  }
+};
+
+/**
+ * \ingroup event-profiler-tests
+ * EventProfilerTestSuite instance variable.
+ */
+static EventProfilerTestSuite g_eventProfilerTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
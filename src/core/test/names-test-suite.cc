@@ -14,6 +14,7 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
 #include "ns3/test.h"
 #include "ns3/names.h"
 
@@ -154,6 +155,81 @@ BasicAddTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (found, "Child", "Could not Names::Add and Names::FindName a child Object");
 }
 
+/**
+ * \ingroup names-tests
+ * Test the Object Name Service can add many names at once.
+ *
+ *     AddMany (std::string path, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
+ *     AddMany (Ptr<Object> context, const std::vector<std::pair<std::string, Ptr<Object> > > &names);
+ */
+class AddManyTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  AddManyTestCase ();
+  /** Destructor. */
+  virtual ~AddManyTestCase ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+AddManyTestCase::AddManyTestCase ()
+  : TestCase ("Check Names::AddMany and Names::HasChildren functionality")
+{
+}
+
+AddManyTestCase::~AddManyTestCase ()
+{
+}
+
+void
+AddManyTestCase::DoTeardown (void)
+{
+  Names::Clear ();
+}
+
+void
+AddManyTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (Names::HasChildren (Ptr<Object> (0, false)), false, "Unexpected names in an empty name space");
+
+  std::vector<std::pair<std::string, Ptr<Object> > > nodes;
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      std::ostringstream oss;
+      oss << "Node" << i;
+      nodes.push_back (std::make_pair (oss.str (), CreateObject<TestObject> ()));
+    }
+  Names::AddMany ("/Names", nodes);
+  NS_TEST_ASSERT_MSG_EQ (Names::HasChildren (Ptr<Object> (0, false)), true, "No names in the root name space");
+
+  std::vector<std::pair<std::string, Ptr<Object> > > devices;
+  devices.push_back (std::make_pair ("eth0", CreateObject<TestObject> ()));
+  devices.push_back (std::make_pair ("eth1", CreateObject<TestObject> ()));
+  Names::AddMany ("Node7", devices);
+  NS_TEST_ASSERT_MSG_EQ (Names::HasChildren (nodes[7].second), true, "No names under Node7");
+  NS_TEST_ASSERT_MSG_EQ (Names::HasChildren (nodes[8].second), false, "Unexpected names under Node8");
+
+  devices.clear ();
+  devices.push_back (std::make_pair ("eth0", CreateObject<TestObject> ()));
+  Names::AddMany (nodes[8].second, devices);
+
+  for (uint32_t i = 0; i < nodes.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> (nodes[i].first), nodes[i].second, "Could not Names::AddMany and Names::Find an Object");
+      NS_TEST_ASSERT_MSG_EQ (Names::FindName (nodes[i].second), nodes[i].first, "Could not Names::AddMany and Names::FindName an Object");
+    }
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (devices[0].second), "/Names/Node8/eth0", "Could not Names::AddMany and Names::FindPath a child Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/Node7/eth1"), Names::Find<TestObject> (nodes[7].second, "eth1"), "Could not find a child Object");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("/Names/Node9/eth0"), 0, "Unexpectedly found a non-existent Object");
+
+  Names::Rename ("Node8/eth0", "eth1");
+  NS_TEST_ASSERT_MSG_EQ (Names::FindPath (devices[0].second), "/Names/Node8/eth1", "Could not Names::Rename an Object added by Names::AddMany");
+  NS_TEST_ASSERT_MSG_EQ (Names::Find<TestObject> ("Node8/eth0"), 0, "Unexpectedly found a renamed Object");
+}
+
 /**
  * \ingroup names-tests
  * Test the Object Name Service can correctly use a string context.
@@ -1019,6 +1095,7 @@ NamesTestSuite::NamesTestSuite ()
   AddTestCase (new StringContextAddTestCase);
   AddTestCase (new FullyQualifiedAddTestCase);
   AddTestCase (new RelativeAddTestCase);
+  AddTestCase (new AddManyTestCase);
   AddTestCase (new BasicRenameTestCase);
   AddTestCase (new StringContextRenameTestCase);
   AddTestCase (new FullyQualifiedRenameTestCase);
@@ -0,0 +1,192 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/wall-clock-synchronizer.h"
+#include "ns3/low-jitter-synchronizer.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/system-thread.h"
+
+#include <chrono>  // milliseconds
+#include <sstream>
+#include <thread>  // sleep_for
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup realtime
+ * \ingroup realtime-tests
+ * RealtimeSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup realtime-tests RealtimeSimulatorImpl test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup realtime-tests
+ * Check the event lateness histogram, and the interruption of the
+ * waits by the events scheduled from another thread, with a
+ * synchronizer.
+ */
+class RealtimeSynchronizerTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param [in] synchronizer The TypeId of the synchronizer.
+   */
+  RealtimeSynchronizerTestCase (TypeId synchronizer);
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /** A periodic event. */
+  void Tick (void);
+  /** An event scheduled from another thread. */
+  void Inserted (void);
+  /** Schedule Inserted from another thread, after a while. */
+  void InsertingThread (void);
+
+  TypeId m_synchronizer;   //!< The TypeId of the synchronizer.
+  uint32_t m_ticks;        //!< The number of Tick events.
+  Time m_insertedAt;       //!< The real time of the Inserted event.
+};
+
+RealtimeSynchronizerTestCase::RealtimeSynchronizerTestCase (TypeId synchronizer)
+  : TestCase ("Check the realtime simulator with " + synchronizer.GetName ()),
+    m_synchronizer (synchronizer)
+{
+}
+
+void
+RealtimeSynchronizerTestCase::DoSetup (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType", TypeIdValue (m_synchronizer));
+}
+
+void
+RealtimeSynchronizerTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::SynchronizerType",
+                      TypeIdValue (WallClockSynchronizer::GetTypeId ()));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+RealtimeSynchronizerTestCase::Tick (void)
+{
+  m_ticks++;
+  if (m_ticks < 50)
+    {
+      Simulator::Schedule (MilliSeconds (2), &RealtimeSynchronizerTestCase::Tick, this);
+    }
+}
+
+void
+RealtimeSynchronizerTestCase::Inserted (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  m_insertedAt = impl->RealtimeNow ();
+  Simulator::Stop ();
+}
+
+void
+RealtimeSynchronizerTestCase::InsertingThread (void)
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (150));
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, Seconds (0),
+                                  &RealtimeSynchronizerTestCase::Inserted, this);
+}
+
+void
+RealtimeSynchronizerTestCase::DoRun (void)
+{
+  m_ticks = 0;
+  m_insertedAt = Seconds (0);
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_NE (impl, 0, "Not a realtime simulator");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetSynchronizerType (), m_synchronizer, "Wrong synchronizer");
+
+  // The ticks are over after 100 ms: the simulator then waits for
+  // the event at 10 s, until the other thread interrupts it.
+  Simulator::Schedule (MilliSeconds (2), &RealtimeSynchronizerTestCase::Tick, this);
+  Simulator::Schedule (Seconds (10), &Simulator::Stop);
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&RealtimeSynchronizerTestCase::InsertingThread, this));
+  thread->Start ();
+  Simulator::Run ();
+  thread->Join ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_ticks, 50, "Wrong number of ticks");
+  NS_TEST_EXPECT_MSG_GT (m_insertedAt, MilliSeconds (100), "Inserted event too early");
+  NS_TEST_EXPECT_MSG_LT (m_insertedAt, Seconds (5), "Wait not interrupted");
+
+  std::vector<uint64_t> histogram = impl->GetLatenessHistogram ();
+  uint64_t count = 0;
+  for (std::vector<uint64_t>::const_iterator i = histogram.begin (); i != histogram.end (); ++i)
+    {
+      count += *i;
+    }
+  // the ticks and the inserted event
+  NS_TEST_EXPECT_MSG_EQ (count, 51, "Events missing from the histogram");
+  // A loaded test machine can be late, but not by much of a tick.
+  NS_TEST_EXPECT_MSG_LT (impl->GetMaxLateness (), MilliSeconds (50), "Events very late");
+  std::ostringstream os;
+  impl->PrintLateness (os);
+  NS_TEST_EXPECT_MSG_NE (os.str ().find ("51 events"), std::string::npos, "Wrong lateness summary");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup realtime-tests
+ * RealtimeSimulatorImpl test suite.
+ */
+class RealtimeTestSuite : public TestSuite
+{
+public:
+  RealtimeTestSuite ()
+    : TestSuite ("realtime-simulator")
+  {
+    AddTestCase (new RealtimeSynchronizerTestCase (WallClockSynchronizer::GetTypeId ()));
+    AddTestCase (new RealtimeSynchronizerTestCase (LowJitterSynchronizer::GetTypeId ()));
+  }
+};
+
+/**
+ * \ingroup realtime-tests
+ * RealtimeTestSuite instance variable.
+ */
+static RealtimeTestSuite g_realtimeTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -19,10 +19,21 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/event-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/core-config.h"
+#include <algorithm>
+#include <vector>
+
+#if defined (HAVE_UNISTD_H) && defined (HAVE_SYS_WAIT_H)
+#include <unistd.h>
+#endif
 
 using namespace ns3;
 
@@ -170,6 +181,174 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SchedulerOrderingTestCase : public TestCase
+{
+public:
+  SchedulerOrderingTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderingTestCase::SchedulerOrderingTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that events come out in (ts, uid) order with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+void
+SchedulerOrderingTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // Interleave inserts and removals so that the events spread over
+  // very different time scales and share timestamps, as in a
+  // simulation with both timers and packet events.
+  std::vector<Scheduler::EventKey> expected;
+  std::vector<Scheduler::Event> removable;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          switch (rng->GetInteger (0, 3))
+            {
+            case 0:
+              ev.key.m_ts = now;
+              break;
+            case 1:
+              ev.key.m_ts = now + rng->GetInteger (0, 10);
+              break;
+            case 2:
+              ev.key.m_ts = now + rng->GetInteger (0, 100000);
+              break;
+            default:
+              ev.key.m_ts = now + rng->GetInteger (0, 1000000000);
+              break;
+            }
+          scheduler->Insert (ev);
+          if (i % 7 == 0)
+            {
+              removable.push_back (ev);
+            }
+          else
+            {
+              expected.push_back (ev.key);
+            }
+        }
+      for (std::vector<Scheduler::Event>::const_iterator i = removable.begin ();
+           i != removable.end (); ++i)
+        {
+          scheduler->Remove (*i);
+        }
+      removable.clear ();
+      std::sort (expected.begin (), expected.end ());
+      std::reverse (expected.begin (), expected.end ());
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          Scheduler::Event next = scheduler->PeekNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.back ().m_uid, "Unexpected event peeked");
+          next = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.back ().m_uid, "Unexpected event removed");
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_ts, expected.back ().m_ts, "Unexpected timestamp");
+          now = next.key.m_ts;
+          expected.pop_back ();
+        }
+      std::reverse (expected.begin (), expected.end ());
+    }
+  while (!expected.empty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "Scheduler lost events");
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.front ().m_uid, "Unexpected event removed");
+      expected.erase (expected.begin ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler should be empty");
+}
+
+class SimulatorCancelTestCase : public TestCase
+{
+public:
+  SimulatorCancelTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+  std::vector<uint32_t> m_invoked;
+  uint32_t m_released;
+
+  /// An event which records when it is invoked and released.
+  class Event : public EventImpl
+  {
+  public:
+    Event (SimulatorCancelTestCase *test, uint32_t i)
+      : m_test (test), m_i (i) {}
+    virtual ~Event ()
+    {
+      m_test->m_released++;
+    }
+  protected:
+    virtual void Notify (void)
+    {
+      m_test->m_invoked.push_back (m_i);
+    }
+  private:
+    SimulatorCancelTestCase *m_test;
+    uint32_t m_i;
+  };
+};
+
+SimulatorCancelTestCase::SimulatorCancelTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that cancelled events are reclaimed with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+void
+SimulatorCancelTestCase::DoRun (void)
+{
+  const uint32_t n = 1000;
+  m_invoked.clear ();
+  m_released = 0;
+  Simulator::SetScheduler (m_schedulerFactory);
+
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      ids.push_back (Simulator::Schedule (Seconds (1) + NanoSeconds (i), Create<Event> (this, i)));
+    }
+  for (uint32_t i = 0; i < n; i++)
+    {
+      if (i % 5 != 0)
+        {
+          ids[i].Cancel ();
+          if (i != 1)
+            {
+              // drop the last reference held outside of the simulator
+              ids[i] = EventId ();
+            }
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (m_released, n / 2, "Cancelled events not released");
+  NS_TEST_EXPECT_MSG_EQ (m_invoked.size (), 0, "Events invoked too early");
+  NS_TEST_EXPECT_MSG_EQ (ids[1].IsExpired (), true, "Cancelled event should have expired");
+  NS_TEST_EXPECT_MSG_EQ (ids[5].IsRunning (), true, "Event should still be running");
+
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_invoked.size (), n / 5, "Wrong number of events invoked");
+  for (uint32_t i = 0; i < m_invoked.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_invoked[i], 5 * i, "Events invoked out of order");
+    }
+  Simulator::Destroy ();
+  ids.clear ();
+  NS_TEST_EXPECT_MSG_EQ (m_released, n, "Events leaked");
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -461,6 +640,94 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+#if defined (HAVE_UNISTD_H) && defined (HAVE_SYS_WAIT_H)
+class SimulatorForkTestCase : public TestCase
+{
+public:
+  SimulatorForkTestCase ();
+  virtual void DoRun (void);
+  void Tick (void);
+  uint32_t m_ticks;
+
+  /// What a child process reports to its parent.
+  struct Report
+  {
+    uint32_t child;
+    int64_t now;
+    uint32_t ticksAtFork;
+    uint32_t ticksAtEnd;
+    double value;
+  };
+};
+
+SimulatorForkTestCase::SimulatorForkTestCase ()
+  : TestCase ("Check Simulator::ForkAt")
+{
+}
+void
+SimulatorForkTestCase::Tick (void)
+{
+  m_ticks++;
+  Simulator::Schedule (Seconds (1), &SimulatorForkTestCase::Tick, this);
+}
+void
+SimulatorForkTestCase::DoRun (void)
+{
+  const uint32_t n = 3;
+  int fds[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (fds), 0, "Can't create a pipe");
+
+  m_ticks = 0;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  Simulator::Schedule (Seconds (1), &SimulatorForkTestCase::Tick, this);
+  uint64_t run = RngSeedManager::GetRun ();
+
+  uint32_t child = Simulator::ForkAt (Seconds (5.5), n);
+  if (child < n)
+    {
+      close (fds[0]);
+      Report report;
+      report.child = child;
+      report.now = Simulator::Now ().GetTimeStep ();
+      report.ticksAtFork = m_ticks;
+      // children 0 and 2 share a run
+      RngSeedManager::SetRun (run + 1 + child % 2);
+      RngSeedManager::ResetStreams ();
+      report.value = rng->GetValue ();
+      Simulator::Stop (Seconds (2));
+      Simulator::Run ();
+      report.ticksAtEnd = m_ticks;
+      if (write (fds[1], &report, sizeof (report)) != (ssize_t)sizeof (report))
+        {
+          _exit (1);
+        }
+      _exit (0);
+    }
+  close (fds[1]);
+  std::vector<Report> reports (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Report report;
+      NS_TEST_ASSERT_MSG_EQ (read (fds[0], &report, sizeof (report)), (ssize_t)sizeof (report),
+                             "Missing child report");
+      NS_TEST_ASSERT_MSG_LT (report.child, n, "Bad child index");
+      reports[report.child] = report;
+    }
+  close (fds[0]);
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (reports[i].child, i, "Missing child " << i);
+      NS_TEST_EXPECT_MSG_EQ (reports[i].now, Seconds (5.5).GetTimeStep (), "Child did not start at the checkpoint");
+      NS_TEST_EXPECT_MSG_EQ (reports[i].ticksAtFork, 5, "Child did not inherit the warm-up");
+      NS_TEST_EXPECT_MSG_EQ (reports[i].ticksAtEnd, 7, "Child did not continue the simulation");
+    }
+  NS_TEST_EXPECT_MSG_EQ (reports[0].value, reports[2].value, "Same run, different values");
+  NS_TEST_EXPECT_MSG_NE (reports[0].value, reports[1].value, "Different runs, same values");
+}
+#endif /* HAVE_UNISTD_H && HAVE_SYS_WAIT_H */
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +744,32 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderingTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderingTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderingTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderingTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderingTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorCancelTestCase (factory), TestCase::QUICK);
+#if defined (HAVE_UNISTD_H) && defined (HAVE_SYS_WAIT_H)
+    AddTestCase (new SimulatorForkTestCase (), TestCase::QUICK);
+#endif
   }
 } g_simulatorTestSuite;
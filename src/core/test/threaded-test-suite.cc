@@ -32,6 +32,7 @@
 #include <list>
 #include <thread>  // sleep_for
 #include <utility>
+#include <vector>
 
 using namespace ns3;
 
@@ -226,6 +227,101 @@ ThreadedSimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_a, m_d, "Bad scheduling");
 }
 
+/**
+ * Inject events from many threads as fast as possible, more than
+ * the lock-free queue of DefaultSimulatorImpl can hold, and check
+ * that none is lost and that the events of each thread run in order.
+ */
+class ThreadedSimulatorInjectionTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorInjectionTestCase (unsigned int threads, unsigned int events);
+  static void InjectingThread (std::pair<ThreadedSimulatorInjectionTestCase *, unsigned int> context);
+  void Receive (unsigned int threadno, unsigned int sequence);
+  void Poll (void);
+  unsigned int m_threads;
+  unsigned int m_events;
+  unsigned int m_received;
+  std::vector<unsigned int> m_next;
+  std::string m_error;
+  std::list<Ptr<SystemThread> > m_threadlist;
+
+private:
+  virtual void DoRun (void);
+};
+
+ThreadedSimulatorInjectionTestCase::ThreadedSimulatorInjectionTestCase (unsigned int threads, unsigned int events)
+  : TestCase ("Check event injection from " + std::to_string (threads) +
+              " threads, " + std::to_string (events) + " events each"),
+    m_threads (threads),
+    m_events (events)
+{
+}
+
+void
+ThreadedSimulatorInjectionTestCase::InjectingThread (std::pair<ThreadedSimulatorInjectionTestCase *, unsigned int> context)
+{
+  ThreadedSimulatorInjectionTestCase *me = context.first;
+  unsigned int threadno = context.second;
+  for (unsigned int i = 0; i < me->m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (threadno, Seconds (0),
+                                      &ThreadedSimulatorInjectionTestCase::Receive, me, threadno, i);
+    }
+}
+
+void
+ThreadedSimulatorInjectionTestCase::Receive (unsigned int threadno, unsigned int sequence)
+{
+  if (Simulator::GetContext () != threadno || sequence != m_next[threadno])
+    {
+      m_error = "Bad injected event order";
+    }
+  m_next[threadno] = sequence + 1;
+  ++m_received;
+}
+
+void
+ThreadedSimulatorInjectionTestCase::Poll (void)
+{
+  if (m_received < m_threads * m_events)
+    {
+      Simulator::Schedule (MicroSeconds (10), &ThreadedSimulatorInjectionTestCase::Poll, this);
+    }
+}
+
+void
+ThreadedSimulatorInjectionTestCase::DoRun (void)
+{
+  m_received = 0;
+  m_next.assign (m_threads, 0);
+  for (unsigned int i = 0; i < m_threads; ++i)
+    {
+      m_threadlist.push_back (
+        Create<SystemThread> (MakeBoundCallback (
+            &ThreadedSimulatorInjectionTestCase::InjectingThread,
+                std::pair<ThreadedSimulatorInjectionTestCase *, unsigned int> (this, i) )) );
+    }
+
+  Simulator::Schedule (MicroSeconds (10), &ThreadedSimulatorInjectionTestCase::Poll, this);
+  // Bound the test if events are lost.
+  Simulator::Stop (Seconds (100));
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Start ();
+    }
+  Simulator::Run ();
+  for (std::list<Ptr<SystemThread> >::iterator it = m_threadlist.begin (); it != m_threadlist.end (); ++it)
+    {
+      (*it)->Join ();
+    }
+  m_threadlist.clear ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_error.empty (), true, m_error);
+  NS_TEST_EXPECT_MSG_EQ (m_received, m_threads * m_events, "Lost injected events");
+}
+
 class ThreadedSimulatorTestSuite : public TestSuite
 {
 public:
@@ -242,7 +338,8 @@ public:
       "ns3::ListScheduler",
       "ns3::HeapScheduler",
       "ns3::MapScheduler",
-      "ns3::CalendarScheduler"
+      "ns3::CalendarScheduler",
+      "ns3::LadderScheduler"
     };
     unsigned int threadcounts[] = {
       0,
@@ -263,5 +360,7 @@ public:
               }
           }
       }
+    AddTestCase (new ThreadedSimulatorInjectionTestCase (2, 100000), TestCase::QUICK);
+    AddTestCase (new ThreadedSimulatorInjectionTestCase (16, 20000), TestCase::QUICK);
   }
 } g_threadedSimulatorTestSuite;
@@ -82,6 +82,8 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * Only the shortest path trees which may be changed by the topology
+   * changes are computed again (see GlobalRouteManager::UpdateGlobalRoutes ()).
    */
   static void RecomputeRoutingTables (void);
 private:
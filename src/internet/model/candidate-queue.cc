@@ -51,22 +51,24 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::Less);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,14 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  c.distance = vNew->GetDistanceFromRoot ();
+  c.sequence = m_sequence++;
+  m_candidates.push_back (c);
+  m_positions[vNew] = m_candidates.size () - 1;
+  m_vertices.insert (std::make_pair (vNew->GetVertexId (), vNew));
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +115,24 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  m_positions.erase (v);
+  std::pair<Vertices_t::iterator, Vertices_t::iterator> range = m_vertices.equal_range (v->GetVertexId ());
+  for (Vertices_t::iterator i = range.first; i != range.second; i++)
+    {
+      if (i->second == v)
+        {
+          m_vertices.erase (i);
+          break;
+        }
+    }
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +145,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,15 +166,10 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
-
-  for (; i != m_candidates.end (); i++)
+  Vertices_t::const_iterator i = m_vertices.find (addr);
+  if (i != m_vertices.end ())
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
-        {
-          return v;
-        }
+      return i->second;
     }
 
   return 0;
@@ -164,11 +180,88 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // The vertices whose distance changed are ordered after the vertices
+  // already queued with the same distance.
+  for (CandidateList_t::iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      if (i->distance != i->vertex->GetDistanceFromRoot ())
+        {
+          i->distance = i->vertex->GetDistanceFromRoot ();
+          i->sequence = m_sequence++;
+        }
+    }
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  Positions_t::const_iterator position = m_positions.find (v);
+  NS_ASSERT_MSG (position != m_positions.end (), "Vertex is not in the CandidateQueue");
+  uint32_t i = position->second;
+  NS_ASSERT_MSG (v->GetDistanceFromRoot () <= m_candidates[i].distance, "Distance of vertex increased");
+  m_candidates[i].distance = v->GetDistanceFromRoot ();
+  m_candidates[i].sequence = m_sequence++;
+  SiftUp (i);
+}
+
+void
+CandidateQueue::Place (uint32_t i, Candidate const &c)
+{
+  m_candidates[i] = c;
+  m_positions[c.vertex] = i;
+}
+
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  while (i > 0)
+    {
+      uint32_t parent = (i - 1) / 2;
+      if (!Less (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (i, m_candidates[parent]);
+      i = parent;
+    }
+  Place (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  uint32_t size = m_candidates.size ();
+  for (;;)
+    {
+      uint32_t child = 2 * i + 1;
+      if (child >= size)
+        {
+          break;
+        }
+      if (child + 1 < size && Less (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Less (m_candidates[child], c))
+        {
+          break;
+        }
+      Place (i, m_candidates[child]);
+      i = child;
+    }
+  Place (i, c);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -176,25 +269,22 @@ CandidateQueue::Reorder (void)
  *
  * This ordering is necessary for implementing ECMP
  */
-bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+bool
+CandidateQueue::Less (Candidate const &a, Candidate const &b)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
-
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+  if (a.distance != b.distance)
     {
-      result = true;
+      return a.distance < b.distance;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  bool aNetwork = a.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  bool bNetwork = b.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  if (aNetwork != bNetwork)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          result = true;
-        }
+      return aNetwork;
     }
-  return result;
+  // the vertices which compare equal are popped in the order they were
+  // ordered in, as from a sorted list
+  return a.sequence < b.sequence;
 }
 
 } // namespace ns3
@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -47,6 +48,12 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap which records the position of each vertex,
+ * so that Push, Pop and Reorder (SPFVertex*) take a logarithmic time and
+ * Find a constant time.  The vertices which compare equal are popped in
+ * the order in which they were pushed, or given their current distance,
+ * as when the queue was a sorted list.
  */
 class CandidateQueue
 {
@@ -154,6 +161,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Restores the order of the Candidate Queue after the distance of
+ * one of its vertices decreased.
+ *
+ * The vertex is popped after the vertices already queued with the same
+ * distance, as Reorder () would do.
+ *
+ * @see SPFVertex
+ * @param v The vertex whose m_distanceFromRoot decreased.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -171,21 +190,53 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
-/**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
- *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
- */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /// a vertex of the heap, with the distance it is ordered by
+  struct Candidate
+  {
+    SPFVertex *vertex;   //!< the vertex
+    uint32_t distance;   //!< the distance of the vertex when it was last ordered
+    uint64_t sequence;   //!< the order in which the vertex was last ordered
+  };
+
+  /**
+   * \brief return true if a < b
+   *
+   * SPFVertexes are added into the queue according to the ordering
+   * defined by this method: by distance, then network vertices before
+   * router vertices, then in the order in which they were ordered.
+   *
+   * \param a first operand
+   * \param b second operand
+   * \return True if a should be popped before b; false otherwise
+   */
+  static bool Less (Candidate const &a, Candidate const &b);
+  /**
+   * \brief Store a candidate at a position of the heap
+   * \param i the position
+   * \param c the candidate
+   */
+  void Place (uint32_t i, Candidate const &c);
+  /**
+   * \brief Move a candidate towards the top of the heap
+   * \param i the position of the candidate
+   */
+  void SiftUp (uint32_t i);
+  /**
+   * \brief Move a candidate towards the bottom of the heap
+   * \param i the position of the candidate
+   */
+  void SiftDown (uint32_t i);
+
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex candidates
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  /// container of the positions of the SPFVertex candidates in the heap
+  typedef std::unordered_map<SPFVertex*, uint32_t> Positions_t;
+  Positions_t m_positions;       //!< the position of each candidate in the heap
+  /// container of the SPFVertex candidates by vertex ID
+  typedef std::unordered_multimap<Ipv4Address, SPFVertex*, Ipv4AddressHash> Vertices_t;
+  Vertices_t m_vertices;         //!< the candidates, by vertex ID
+  uint64_t m_sequence;           //!< the sequence number of the next ordered candidate
 
   /**
    * \brief Stream insertion operator.
@@ -26,11 +26,19 @@
 #include <vector>
 #include <queue>
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <unistd.h>
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
 #include "ns3/node-list.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
@@ -44,6 +52,18 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \relates GlobalRouteManagerImpl
+ * \brief The number of threads which run the SPF calculations
+ */
+static GlobalValue g_globalRoutingThreads =
+  GlobalValue ("GlobalRoutingThreads",
+               "The number of threads which compute the global routes of "
+               "the nodes, or 0 for one per processor.  The routes do not "
+               "depend on the number of threads.",
+               UintegerValue (0),
+               MakeUintegerChecker<uint32_t> ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -495,13 +515,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -531,6 +548,17 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const
+{
+  NS_LOG_FUNCTION (this);
+  lsas.clear ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+}
+
 // ---------------------------------------------------------------------------
 //
 // GlobalRouteManagerImpl Implementation
@@ -539,16 +567,30 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_ownLsdb (true),
+    m_rootIsNode (false),
+    m_keepTraces (false)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb)
+  :
+    m_spfroot (0),
+    m_lsdb (lsdb),
+    m_ownLsdb (false),
+    m_rootIsNode (false),
+    m_keepTraces (false)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  if (m_lsdb && m_ownLsdb)
     {
       delete m_lsdb;
     }
@@ -573,25 +615,14 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
       Ptr<Node> node = *i;
-      Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-      if (router == 0)
+      if (node->GetObject<GlobalRouter> () == 0)
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      DeleteRoutes (node);
     }
+  m_traces.clear ();
+  m_lsaIndex.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -655,6 +686,15 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 // Write the newly discovered link state advertisement to the database.
 //
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
+//
+// The LSAs keep their index as long as the routes are updated, so that the
+// trees recorded by previous calculations can be read with the new LSDB.
+//
+          if (lsa->GetLSType () != GlobalRoutingLSA::ASExternalLSAs)
+            {
+              uint32_t index = m_lsaIndex.size ();
+              m_lsaIndex.insert (std::make_pair (lsa->GetLinkStateId (), index));
+            }
         }
     }
 }
@@ -696,10 +736,25 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("About to start SPF calculation");
+  std::vector<Ptr<Node> > roots;
+  GetRoots (roots);
+//
+// The SPF calculations of the nodes are independent of each other: they
+// only read the LSDB, and each of them writes the routes of its own root.
+//
+  SPFCalculateRoots (roots, std::vector<bool> (roots.size (), false), false);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::GetRoots (std::vector<Ptr<Node> > &roots)
+{
+  NS_LOG_FUNCTION (&roots);
 //
 // Walk the list of nodes in the system.
 //
-  NS_LOG_INFO ("About to start SPF calculation");
+  roots.clear ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,157 +779,776 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          roots.push_back (node);
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+/**
+ * \brief Compare two link records
+ * \param a a link record
+ * \param b another link record
+ * \returns true if the link records are the same
+ */
+static bool
+IsSameLinkRecord (GlobalRoutingLinkRecord* a, GlobalRoutingLinkRecord* b)
+{
+  return a->GetLinkType () == b->GetLinkType ()
+         && a->GetLinkId () == b->GetLinkId ()
+         && a->GetLinkData () == b->GetLinkData ()
+         && a->GetMetric () == b->GetMetric ();
+}
+
+/**
+ * \brief Compare two LSAs, except for their SPF status
+ * \param a an LSA
+ * \param b another LSA
+ * \returns true if the LSAs are the same
+ */
+static bool
+IsSameLSA (GlobalRoutingLSA* a, GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      if (!IsSameLinkRecord (a->GetLinkRecord (i), b->GetLinkRecord (i)))
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
 }
 
 //
-// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
-// 16.1 (2) for further details.
-//
-// We're passed a parameter <v> that is a vertex which is already in the SPF
-// tree.  A vertex represents a router node.  We also get a reference to the
-// SPF candidate queue, which is a priority queue containing the shortest paths
-// to the networks we know about.
-//
-// We examine the links in v's LSA and update the list of candidates with any
-// vertices not already on the list.  If a lower-cost path is found to a
-// vertex already on the candidate list, store the new (lower) cost.
+// The routes are updated by building the LSDB again and comparing it with
+// the previous one.  As in RFC2328, Section 16.5, a change of an LSA can
+// only change the shortest path tree of a root if the LSA is in the tree,
+// and if the changed link is on a shortest path, or makes a path as short
+// as the shortest one.  The other trees are the same as before: so are the
+// order in which their vertices joined them and the exits to these
+// vertices, and the routes of their roots are written from the trees
+// recorded by the previous calculations.  The changes to the links to
+// stub networks change none of the trees.  The changes to the network LSAs
+// and to the External LSAs are not tracked: all the trees are computed
+// again.
 //
 void
-GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+GlobalRouteManagerImpl::UpdateGlobalRoutes ()
 {
-  NS_LOG_FUNCTION (this << v << &candidate);
+  NS_LOG_FUNCTION (this);
+  if (!m_keepTraces || m_traces.empty ())
+    {
+//
+// The trees take a memory in the square of the number of routers, so they
+// are only kept once the routes are updated.
+//
+      m_keepTraces = true;
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+
+  GlobalRouteManagerLSDB* lsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  std::vector<LSAChange> changes;
+  bool all = GetLSAChanges (lsdb, changes);
+  delete lsdb;
+  NS_LOG_LOGIC (changes.size () << " router LSAs changed" << (all ? ", recomputing all the trees" : ""));
+
+  std::vector<Ptr<Node> > roots;
+  GetRoots (roots);
+  std::vector<bool> replay (roots.size (), false);
+  uint32_t nReplayed = 0;
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      std::map<uint32_t, SPFTrace>::const_iterator trace = m_traces.find (roots[i]->GetId ());
+      if (all || trace == m_traces.end () || trace->second.stub)
+        {
+          continue;
+        }
+      RootAddresses_t addresses;
+      GetRootAddresses (roots[i], addresses);
+      if (addresses == trace->second.addresses && !IsTreeChanged (trace->second, changes))
+        {
+          replay[i] = true;
+          nReplayed++;
+        }
+    }
+  NS_LOG_INFO ("Updating the routes of " << roots.size () << " nodes, " <<
+               roots.size () - nReplayed << " SPF calculations");
 
-  SPFVertex* w = 0;
-  GlobalRoutingLSA* w_lsa = 0;
-  GlobalRoutingLinkRecord *l = 0;
-  uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
 //
-// V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
+// The routers which are no longer roots lose their routes, as they would
+// with DeleteGlobalRoutes ().
 //
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
+  std::vector<Ptr<Node> >::const_iterator root = roots.begin ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+      if (root != roots.end () && *root == *i)
+        {
+          root++;
+          continue;
+        }
+      if ((*i)->GetObject<GlobalRouter> ())
+        {
+          DeleteRoutes (*i);
+          m_traces.erase ((*i)->GetId ());
+        }
     }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+
+  SPFCalculateRoots (roots, replay, true);
+}
+
+bool
+GlobalRouteManagerImpl::GetLSAChanges (GlobalRouteManagerLSDB* lsdb, std::vector<LSAChange> &changes) const
+{
+  NS_LOG_FUNCTION (this << lsdb);
+  changes.clear ();
+  if (lsdb->GetNumExtLSAs () != m_lsdb->GetNumExtLSAs ())
     {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+      return true;
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      if (!IsSameLSA (lsdb->GetExtLSA (i), m_lsdb->GetExtLSA (i)))
+        {
+          return true;
+        }
     }
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+  std::vector<GlobalRoutingLSA*> oldLsas;
+  std::vector<GlobalRoutingLSA*> newLsas;
+  lsdb->GetLSAs (oldLsas);
+  m_lsdb->GetLSAs (newLsas);
+  std::vector<GlobalRoutingLSA*>::const_iterator o = oldLsas.begin ();
+  std::vector<GlobalRoutingLSA*>::const_iterator n = newLsas.begin ();
+  while (o != oldLsas.end () || n != newLsas.end ())
     {
-// Get w_lsa:  In case of V is Router-LSA
-      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+      GlobalRoutingLSA* oldLsa = 0;
+      GlobalRoutingLSA* newLsa = 0;
+      if (n == newLsas.end ()
+          || (o != oldLsas.end () && (*o)->GetLinkStateId () < (*n)->GetLinkStateId ()))
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-//
-// (a) If this is a link to a stub network, examine the next link in V's LSA.
-// Links to stub networks will be considered in the second stage of the
-// shortest path calculation.
-//
-          l = v->GetLSA ()->GetLinkRecord (i);
-          NS_ASSERT (l != 0);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+          oldLsa = *o++;
+        }
+      else if (o == oldLsas.end () || (*n)->GetLinkStateId () < (*o)->GetLinkStateId ())
+        {
+          newLsa = *n++;
+        }
+      else
+        {
+          oldLsa = *o++;
+          newLsa = *n++;
+          if (IsSameLSA (oldLsa, newLsa))
             {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
               continue;
             }
+        }
+      GlobalRoutingLSA* lsa = oldLsa ? oldLsa : newLsa;
+      if (lsa->GetLSType () != GlobalRoutingLSA::RouterLSA
+          || (oldLsa && newLsa && newLsa->GetLSType () != GlobalRoutingLSA::RouterLSA))
+        {
+          return true;
+        }
+
+      LSAChange change;
+      change.id = lsa->GetLinkStateId ();
+      change.removed = (newLsa == 0);
+      change.reordered = false;
 //
-// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
-// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
-// database. 
+// Match the links to routers of both LSAs, in order; the links to stub
+// networks are only read when writing the routes.
 //
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+      std::vector<GlobalRoutingLinkRecord*> oldLinks;
+      std::vector<GlobalRoutingLinkRecord*> newLinks;
+      for (uint32_t i = 0; oldLsa && i < oldLsa->GetNLinkRecords (); i++)
+        {
+          if (oldLsa->GetLinkRecord (i)->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
             {
-//
-// Lookup the link state advertisement of the new link -- we call it <w> in
-// the link state database.
-//
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a P2P record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              oldLinks.push_back (oldLsa->GetLinkRecord (i));
             }
-          else if (l->GetLinkType () == 
-                   GlobalRoutingLinkRecord::TransitNetwork)
+        }
+      for (uint32_t i = 0; newLsa && i < newLsa->GetNLinkRecords (); i++)
+        {
+          if (newLsa->GetLinkRecord (i)->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
-              NS_LOG_LOGIC ("Found a Transit record from " << 
-                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+              newLinks.push_back (newLsa->GetLinkRecord (i));
             }
-          else 
+        }
+      std::vector<bool> kept (newLinks.size (), false);
+      uint32_t last = 0;
+      for (uint32_t i = 0; i < oldLinks.size (); i++)
+        {
+          uint32_t j = 0;
+          while (j < newLinks.size () && (kept[j] || !IsSameLinkRecord (oldLinks[i], newLinks[j])))
             {
-              NS_ASSERT_MSG (0, "illegal Link Type");
+              j++;
+            }
+          if (j < newLinks.size ())
+            {
+              kept[j] = true;
+              change.reordered = change.reordered || j < last;
+              last = j;
+              continue;
             }
+          if (oldLinks[i]->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+            {
+              return true;
+            }
+          change.removedLinks.push_back (SPFLink_t (oldLinks[i]->GetLinkId (), oldLinks[i]->GetMetric ()));
         }
-// Get w_lsa:  In case of V is Network-LSA
-      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+      for (uint32_t j = 0; j < newLinks.size (); j++)
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          if (kept[j])
             {
               continue;
             }
-          NS_LOG_LOGIC ("Found a Network LSA from " << 
-                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+          if (newLinks[j]->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+            {
+              return true;
+            }
+          change.addedLinks.push_back (SPFLink_t (newLinks[j]->GetLinkId (), newLinks[j]->GetMetric ()));
+        }
+      if (change.removed || change.reordered
+          || !change.removedLinks.empty () || !change.addedLinks.empty ())
+        {
+          changes.push_back (change);
         }
+    }
+  return false;
+}
 
-// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
-//
-// (c) If vertex W is already on the shortest-path tree, examine the next
-// link in the LSA.
-//
-// If the link is to a router that is already in the shortest path first tree
-// then we have it covered -- ignore it.
-//
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+bool
+GlobalRouteManagerImpl::IsTreeChanged (SPFTrace const &trace, std::vector<LSAChange> const &changes) const
+{
+  NS_LOG_FUNCTION (this << changes.size ());
+  Ipv4Address root = trace.vertices.front ().id;
+  GlobalRoutingLSA* rootLsa = m_lsdb->GetLSA (root);
+  for (std::vector<LSAChange>::const_iterator i = changes.begin (); i != changes.end (); i++)
+    {
+      if (i->id == root)
         {
-          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
-                        w_lsa->GetLinkStateId () << " already in SPF tree");
+          return true;
+        }
+      uint32_t v = GetTracePosition (trace, i->id);
+      if (v == SPF_NO_VERTEX)
+        {
+          // the links of the routers which cannot be reached are not used
           continue;
         }
+      if (i->removed || i->reordered)
+        {
+          return true;
+        }
 //
-// (d) Calculate the link state cost D of the resulting path from the root to 
-// vertex W.  D is equal to the sum of the link state cost of the (already 
-// calculated) shortest path to vertex V and the advertised cost of the link
-// between vertices V and W.
+// The next hops to the neighbors of the root are read from the links of
+// the neighbors back to the root.
 //
-      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+      for (uint32_t j = 0; rootLsa && j < rootLsa->GetNLinkRecords (); j++)
         {
-          NS_ASSERT (l != 0);
-          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+          if (rootLsa->GetLinkRecord (j)->GetLinkId () == i->id)
+            {
+              return true;
+            }
         }
-      else
+      uint64_t distance = trace.vertices[v].distance;
+      for (uint32_t k = 0; k < 2; k++)
         {
-          distance = v->GetDistanceFromRoot ();
+          std::vector<SPFLink_t> const &links = k ? i->addedLinks : i->removedLinks;
+          for (std::vector<SPFLink_t>::const_iterator l = links.begin (); l != links.end (); l++)
+            {
+              uint32_t w = GetTracePosition (trace, l->first);
+              if (w == SPF_NO_VERTEX || distance + l->second <= trace.vertices[w].distance)
+                {
+                  return true;
+                }
+            }
         }
+    }
+  return false;
+}
 
-      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+uint32_t
+GlobalRouteManagerImpl::GetTracePosition (SPFTrace const &trace, Ipv4Address id) const
+{
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator i = m_lsaIndex.find (id);
+  if (i == m_lsaIndex.end () || i->second >= trace.positions.size ())
+    {
+      return SPF_NO_VERTEX;
+    }
+  return trace.positions[i->second];
+}
 
-// Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
-        {
-// Calculate nexthop to w
-// We need to figure out how to actually get to the new router represented
-// by <w>.  This will (among other things) find the next hop address to send
-// packets destined for this network to, and also find the outbound interface
-// used to forward the packets.
+/**
+ * \brief The SPF calculations of a group of roots.
+ *
+ * The worker threads take the next calculation to run from the shared
+ * counter, and store its routes and its tree by root, so that the main
+ * thread can write them in the order of the roots.
+ */
+struct GlobalRouteManagerImpl::SPFBatch
+{
+  std::vector<Ipv4Address> roots;              //!< the router IDs of the roots
+  std::vector<RootAddresses_t> addresses;      //!< the addresses of the roots
+  std::vector<SPFRoutes_t> routes;             //!< the routes of the roots
+  std::vector<SPFTrace> traces;                //!< the trees of the roots
+  std::vector<bool> replay;                    //!< whether the routes of the roots are written from their trees
+  /// the index of the LSAs, to record the trees, or 0
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> const *lsaIndex;
+  std::atomic<uint32_t> next;                  //!< the next calculation to run
+};
 
-// prepare vertex w
-          w = new SPFVertex (w_lsa);
-          if (SPFNexthopCalculation (v, w, l, distance))
+uint32_t
+GlobalRouteManagerImpl::GetSPFThreads (uint32_t nRoots)
+{
+#ifdef HAVE_PTHREAD_H
+  // Below this number of roots per thread, starting the threads costs
+  // more than it saves.
+  const uint32_t MIN_ROOTS_PER_THREAD = 16;
+  UintegerValue value;
+  g_globalRoutingThreads.GetValue (value);
+  uint32_t threads = value.Get ();
+  if (threads == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = processors > 0 ? processors : 1;
+    }
+  threads = std::min (threads, nRoots / MIN_ROOTS_PER_THREAD);
+  // The logs of the calculations would be interleaved.
+  if (threads > 1 && !g_log.IsNoneEnabled ())
+    {
+      threads = 1;
+    }
+  return std::max (threads, 1U);
+#else
+  return 1;
+#endif
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots (std::vector<Ptr<Node> > const &roots,
+                                           std::vector<bool> const &replay, bool update)
+{
+  NS_LOG_FUNCTION (this << roots.size () << update);
+  NS_ASSERT (replay.size () == roots.size ());
+  uint32_t threads = GetSPFThreads (std::count (replay.begin (), replay.end (), false));
+  // This thread runs calculations too, with its own state.
+  std::vector<GlobalRouteManagerImpl*> workers (1, this);
+  for (uint32_t i = 1; i < threads; i++)
+    {
+      workers.push_back (new GlobalRouteManagerImpl (m_lsdb));
+    }
+  // The routes of a batch are held until all of its calculations are
+  // done, so the roots are processed in batches to bound the memory used.
+  const uint32_t BATCH_ROOTS_PER_THREAD = 64;
+  uint32_t batchSize = threads * BATCH_ROOTS_PER_THREAD;
+  for (uint32_t start = 0; start < roots.size (); start += batchSize)
+    {
+      uint32_t end = std::min<uint32_t> (start + batchSize, roots.size ());
+      SPFBatch batch;
+      batch.addresses.resize (end - start);
+      batch.routes.resize (end - start);
+      batch.traces.resize (end - start);
+      batch.replay.assign (replay.begin () + start, replay.begin () + end);
+      batch.lsaIndex = m_keepTraces ? &m_lsaIndex : 0;
+      for (uint32_t i = start; i < end; i++)
+        {
+          batch.roots.push_back (roots[i]->GetObject<GlobalRouter> ()->GetRouterId ());
+          GetRootAddresses (roots[i], batch.addresses[i - start]);
+          if (replay[i])
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
-//
+              std::swap (batch.traces[i - start], m_traces[roots[i]->GetId ()]);
+            }
+        }
+      batch.next = 0;
+
+#ifdef HAVE_PTHREAD_H
+      std::vector<Ptr<SystemThread> > workerThreads;
+      for (uint32_t i = 1; i < threads; i++)
+        {
+          Ptr<SystemThread> thread =
+            Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateBatch,
+                                                workers[i]).Bind (&batch));
+          thread->Start ();
+          workerThreads.push_back (thread);
+        }
+#endif
+      SPFCalculateBatch (&batch);
+#ifdef HAVE_PTHREAD_H
+      for (uint32_t i = 0; i < workerThreads.size (); i++)
+        {
+          workerThreads[i]->Join ();
+        }
+#endif
+
+      for (uint32_t i = start; i < end; i++)
+        {
+          if (update)
+            {
+              UpdateRoutes (roots[i], batch.routes[i - start]);
+            }
+          else
+            {
+              InstallRoutes (roots[i], batch.routes[i - start]);
+            }
+          if (m_keepTraces)
+            {
+              std::swap (m_traces[roots[i]->GetId ()], batch.traces[i - start]);
+            }
+        }
+    }
+  for (uint32_t i = 1; i < threads; i++)
+    {
+      delete workers[i];
+    }
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateBatch (SPFBatch *batch)
+{
+  NS_LOG_FUNCTION (this << batch);
+  for (uint32_t i = batch->next++; i < batch->roots.size (); i = batch->next++)
+    {
+      if (batch->replay[i])
+        {
+          NS_LOG_LOGIC ("Writing the routes of " << batch->roots[i] << " from its previous tree");
+          std::swap (m_trace, batch->traces[i]);
+          m_routes.clear ();
+          SPFAddRoutes ();
+        }
+      else
+        {
+          m_rootAddresses.swap (batch->addresses[i]);
+          m_rootIsNode = true;
+          SPFCalculate (batch->roots[i]);
+          if (batch->lsaIndex)
+            {
+              m_trace.addresses = m_rootAddresses;
+              m_trace.positions.assign (batch->lsaIndex->size (), SPF_NO_VERTEX);
+              for (uint32_t k = 0; k < m_trace.vertices.size (); k++)
+                {
+                  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash>::const_iterator index =
+                    batch->lsaIndex->find (m_trace.vertices[k].id);
+                  if (index != batch->lsaIndex->end ())
+                    {
+                      m_trace.positions[index->second] = k;
+                    }
+                }
+            }
+        }
+      m_routes.swap (batch->routes[i]);
+      std::swap (m_trace, batch->traces[i]);
+    }
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetLSAStatus (GlobalRoutingLSA* lsa) const
+{
+  std::unordered_map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i =
+    m_lsaStatus.find (lsa);
+  if (i == m_lsaStatus.end ())
+    {
+      return GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED;
+    }
+  return i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetLSAStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_lsaStatus[lsa] = status;
+}
+
+void
+GlobalRouteManagerImpl::GetRootAddresses (Ptr<Node> node, RootAddresses_t &addresses)
+{
+  NS_LOG_FUNCTION (node);
+  addresses.clear ();
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  NS_ASSERT_MSG (ipv4, 
+                 "GlobalRouteManagerImpl::GetRootAddresses (): "
+                 "GetObject for <Ipv4> interface failed");
+  for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+    {
+      for (uint32_t j = 0; j < ipv4->GetNAddresses (i); j++)
+        {
+          addresses.push_back (std::make_pair (i, ipv4->GetAddress (i, j).GetLocal ()));
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::SetRoot (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (this << node);
+  m_rootIsNode = (node != 0);
+  if (m_rootIsNode)
+    {
+      GetRootAddresses (node, m_rootAddresses);
+    }
+  else
+    {
+      m_rootAddresses.clear ();
+    }
+}
+
+void
+GlobalRouteManagerImpl::AddRoute (SPFRouteType type, Ipv4Address dest, Ipv4Mask mask,
+                                  Ipv4Address nextHop, uint32_t outIf)
+{
+  SPFRoute route;
+  route.type = type;
+  route.dest = dest;
+  route.mask = mask;
+  route.nextHop = nextHop;
+  route.outIf = outIf;
+  m_routes.push_back (route);
+}
+
+void
+GlobalRouteManagerImpl::InstallRoutes (Ptr<Node> node, SPFRoutes_t const &routes)
+{
+  NS_LOG_FUNCTION (node << routes.size ());
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  for (SPFRoutes_t::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      switch (i->type)
+        {
+        case SPF_HOST_ROUTE:
+          gr->AddHostRouteTo (i->dest, i->nextHop, i->outIf);
+          break;
+        case SPF_NETWORK_ROUTE:
+          gr->AddNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          break;
+        case SPF_AS_EXTERNAL_ROUTE:
+          gr->AddASExternalRouteTo (i->dest, i->mask, i->nextHop, i->outIf);
+          break;
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::UpdateRoutes (Ptr<Node> node, SPFRoutes_t const &routes)
+{
+  NS_LOG_FUNCTION (node << routes.size ());
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  NS_ASSERT (gr);
+  std::vector<Ipv4RoutingTableEntry> hostRoutes;
+  std::vector<Ipv4RoutingTableEntry> networkRoutes;
+  std::vector<Ipv4RoutingTableEntry> externalRoutes;
+  for (SPFRoutes_t::const_iterator i = routes.begin (); i != routes.end (); i++)
+    {
+      switch (i->type)
+        {
+        case SPF_HOST_ROUTE:
+          hostRoutes.push_back (Ipv4RoutingTableEntry::CreateHostRouteTo (i->dest, i->nextHop, i->outIf));
+          break;
+        case SPF_NETWORK_ROUTE:
+          networkRoutes.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf));
+          break;
+        case SPF_AS_EXTERNAL_ROUTE:
+          externalRoutes.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (i->dest, i->mask, i->nextHop, i->outIf));
+          break;
+        }
+    }
+  if (gr->RetainRoutes (hostRoutes, networkRoutes, externalRoutes))
+    {
+      NS_LOG_LOGIC ("Kept " << gr->GetNRoutes () << " routes of node " << node->GetId ());
+      return;
+    }
+  DeleteRoutes (node);
+  InstallRoutes (node, routes);
+}
+
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Node> node)
+{
+  NS_LOG_FUNCTION (node);
+  Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
+  NS_ASSERT (router);
+  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+}
+
+//
+// This method is derived from quagga ospf_spf_next ().  See RFC2328 Section 
+// 16.1 (2) for further details.
+//
+// We're passed a parameter <v> that is a vertex which is already in the SPF
+// tree.  A vertex represents a router node.  We also get a reference to the
+// SPF candidate queue, which is a priority queue containing the shortest paths
+// to the networks we know about.
+//
+// We examine the links in v's LSA and update the list of candidates with any
+// vertices not already on the list.  If a lower-cost path is found to a
+// vertex already on the candidate list, store the new (lower) cost.
+//
+void
+GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
+{
+  NS_LOG_FUNCTION (this << v << &candidate);
+
+  SPFVertex* w = 0;
+  GlobalRoutingLSA* w_lsa = 0;
+  GlobalRoutingLinkRecord *l = 0;
+  uint32_t distance = 0;
+  uint32_t numRecordsInVertex = 0;
+//
+// V points to a Router-LSA or Network-LSA
+// Loop over the links in router LSA or attached routers in Network LSA
+//
+  if (v->GetVertexType () == SPFVertex::VertexRouter)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
+    }
+  if (v->GetVertexType () == SPFVertex::VertexNetwork)
+    {
+      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
+    }
+
+  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+    {
+// Get w_lsa:  In case of V is Router-LSA
+      if (v->GetVertexType () == SPFVertex::VertexRouter) 
+        {
+          NS_LOG_LOGIC ("Examining link " << i << " of " << 
+                        v->GetVertexId () << "'s " <<
+                        v->GetLSA ()->GetNLinkRecords () << " link records");
+//
+// (a) If this is a link to a stub network, examine the next link in V's LSA.
+// Links to stub networks will be considered in the second stage of the
+// shortest path calculation.
+//
+          l = v->GetLSA ()->GetLinkRecord (i);
+          NS_ASSERT (l != 0);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              continue;
+            }
+//
+// (b) Otherwise, W is a transit vertex (router or transit network).  Look up
+// the vertex W's LSA (router-LSA or network-LSA) in Area A's link state
+// database. 
+//
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+//
+// Lookup the link state advertisement of the new link -- we call it <w> in
+// the link state database.
+//
+              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
+              NS_ASSERT (w_lsa);
+              NS_LOG_LOGIC ("Found a P2P record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else if (l->GetLinkType () == 
+                   GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
+              NS_ASSERT (w_lsa);
+              NS_LOG_LOGIC ("Found a Transit record from " << 
+                            v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+            }
+          else 
+            {
+              NS_ASSERT_MSG (0, "illegal Link Type");
+            }
+        }
+// Get w_lsa:  In case of V is Network-LSA
+      if (v->GetVertexType () == SPFVertex::VertexNetwork) 
+        {
+          w_lsa = m_lsdb->GetLSAByLinkData 
+              (v->GetLSA ()->GetAttachedRouter (i));
+          if (!w_lsa)
+            {
+              continue;
+            }
+          NS_LOG_LOGIC ("Found a Network LSA from " << 
+                        v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
+        }
+
+// Note:  w_lsa at this point may be either RouterLSA or NetworkLSA
+//
+// (c) If vertex W is already on the shortest-path tree, examine the next
+// link in the LSA.
+//
+// If the link is to a router that is already in the shortest path first tree
+// then we have it covered -- ignore it.
+//
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+        {
+          NS_LOG_LOGIC ("Skipping ->  LSA "<< 
+                        w_lsa->GetLinkStateId () << " already in SPF tree");
+          continue;
+        }
+//
+// (d) Calculate the link state cost D of the resulting path from the root to 
+// vertex W.  D is equal to the sum of the link state cost of the (already 
+// calculated) shortest path to vertex V and the advertised cost of the link
+// between vertices V and W.
+//
+      if (v->GetLSA ()->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          NS_ASSERT (l != 0);
+          distance = v->GetDistanceFromRoot () + l->GetMetric ();
+        }
+      else
+        {
+          distance = v->GetDistanceFromRoot ();
+        }
+
+      NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
+
+// Is there already vertex w in candidate list?
+      if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+        {
+// Calculate nexthop to w
+// We need to figure out how to actually get to the new router represented
+// by <w>.  This will (among other things) find the next hop address to send
+// packets destined for this network to, and also find the outbound interface
+// used to forward the packets.
+
+// prepare vertex w
+          w = new SPFVertex (w_lsa);
+          if (SPFNexthopCalculation (v, w, l, distance))
+            {
+              SetLSAStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+//
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
 //
@@ -888,7 +1562,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (GetLSAStatus (w_lsa) == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -960,7 +1634,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +1921,23 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  Ptr<Node> node;
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<GlobalRouter> rtr = (*i)->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == root)
+        {
+          node = *i;
+          break;
+        }
+    }
+  SetRoot (node);
   SPFCalculate (root);
+  if (node)
+    {
+      InstallRoutes (node, m_routes);
+    }
 }
 
 //
@@ -1320,12 +2010,8 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  AddRoute (SPF_NETWORK_ROUTE, Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                            FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1345,9 +2031,15 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the SPF status of the Link State Database and the routes.
+// They are kept by this calculation rather than in the LSAs, so that
+// calculations rooted at different routers can run at the same time.
 //
-  m_lsdb->Initialize ();
+  m_lsaStatus.clear ();
+  m_routes.clear ();
+  m_trace = SPFTrace ();
+  m_trace.stub = false;
+  m_vertexPositions.clear ();
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1367,7 +2059,8 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SPFRecordVertex (v);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +2070,13 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_rootIsNode && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      m_trace.stub = true;
       delete m_spfroot;
+      m_spfroot = 0;
+      m_vertexPositions.clear ();
       return;
     }
 
@@ -1428,7 +2124,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1444,15 +2140,15 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
 // RFC2328 16.1. (4). 
 //
-// This is the method that actually adds the routes.  It'll walk the list
-// of nodes in the system, looking for the node corresponding to the router
-// ID of the root of the tree -- that is the router we're building the routes
-// for.  It looks for the Ipv4 interface of that node and remembers it.  So
-// we are only actually adding routes to that one node at the root of the SPF 
+// The vertex is recorded in the tree of the calculation, and the routes are
+// added to the routes of the root once the tree is complete, by
+// SPFAddRoutes ().  We only add routes to the node at the root of the SPF
 // tree.
 //
-// We're going to pop of a pointer to every vertex in the tree except the 
-// root in order of distance from the root.  For each of the vertices, we call
+      SPFRecordVertex (v);
+//
+// SPFAddRoutes () takes every vertex in the tree except the root in order of
+// distance from the root.  For each of the router vertices, it calls
 // SPFIntraAddRouter ().  Down in SPFIntraAddRouter, we look at all of the 
 // point-to-point Global Router Link Records (the links to nodes adjacent to
 // the node represented by the vertex).  We add a route to the IP address 
@@ -1464,19 +2160,6 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // To summarize, we're going to look at the node represented by <v> and loop
 // through its point-to-point links, adding a *host* route to the local IP
 // address (at the <v> side) for each of those links.
-//
-      if (v->GetVertexType () == SPFVertex::VertexRouter)
-        {
-          SPFIntraAddRouter (v);
-        }
-      else if (v->GetVertexType () == SPFVertex::VertexNetwork)
-        {
-          SPFIntraAddTransit (v);
-        }
-      else
-        {
-          NS_ASSERT_MSG (0, "illegal SPFVertex type");
-        }
 //
 // RFC2328 16.1. (5). 
 //
@@ -1490,24 +2173,91 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
   for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
     {
       m_spfroot->ClearVertexProcessed ();
-      GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
-      NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      NS_LOG_LOGIC ("Processing External LSA with id " << m_lsdb->GetExtLSA (i)->GetLinkStateId ());
+      ProcessASExternals (m_spfroot, i);
     }
 
 //
-// We're all done setting the routing information for the node at the root of
-// the SPF tree.  Delete all of the vertices and corresponding resources.  Go
-// possibly do it again for the next router.
+// We're all done building the tree for the node at the root of the SPF tree.
+// Delete all of the vertices and corresponding resources, and compute the
+// routes from the tree.  Go possibly do it again for the next router.
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_vertexPositions.clear ();
+  SPFAddRoutes ();
+}
+
+void
+GlobalRouteManagerImpl::SPFRecordVertex (SPFVertex* v)
+{
+  NS_LOG_FUNCTION (this << v);
+  SPFTraceVertex vertex;
+  vertex.id = v->GetVertexId ();
+  vertex.type = v->GetVertexType ();
+  vertex.distance = v->GetDistanceFromRoot ();
+  vertex.firstExit = m_trace.exits.size ();
+  vertex.nExits = v->GetNRootExitDirections ();
+  for (uint32_t i = 0; i < vertex.nExits; i++)
+    {
+      m_trace.exits.push_back (v->GetRootExitDirection (i));
+    }
+  m_vertexPositions[v->GetLSA ()] = m_trace.vertices.size ();
+  m_trace.vertices.push_back (vertex);
+}
+
+void
+GlobalRouteManagerImpl::SPFAddRoutes (void)
+{
+  NS_LOG_FUNCTION (this);
+//
+// The routes to the routers and the transit networks, in the order in which
+// they joined the tree; the root is the first vertex.
+//
+  for (uint32_t k = 1; k < m_trace.vertices.size (); k++)
+    {
+      if (m_trace.vertices[k].type == SPFVertex::VertexRouter)
+        {
+          SPFIntraAddRouter (k);
+        }
+      else if (m_trace.vertices[k].type == SPFVertex::VertexNetwork)
+        {
+          SPFIntraAddTransit (k);
+        }
+      else
+        {
+          NS_ASSERT_MSG (0, "illegal SPFVertex type");
+        }
+    }
+//
+// The routes to the stub networks, then the external routes.
+//
+  for (std::vector<uint32_t>::const_iterator k = m_trace.stubs.begin (); k != m_trace.stubs.end (); k++)
+    {
+      GlobalRoutingLSA *rlsa = m_lsdb->GetLSA (m_trace.vertices[*k].id);
+      NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
+      for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = rlsa->GetLinkRecord (i);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
+              SPFIntraAddStub (l, *k);
+            }
+        }
+    }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator i = m_trace.externals.begin ();
+       i != m_trace.externals.end (); i++)
+    {
+      SPFAddASExternal (m_lsdb->GetExtLSA (i->first), i->second);
+    }
 }
 
 void
-GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa)
+GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, uint32_t ext)
 {
-  NS_LOG_FUNCTION (this << v << extlsa);
+  NS_LOG_FUNCTION (this << v << ext);
+  GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (ext);
   NS_LOG_LOGIC ("Processing external for destination " << 
                 extlsa->GetLinkStateId () <<
                 ", for router "  << v->GetVertexId () <<
@@ -1519,7 +2269,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if ((rlsa->GetLinkStateId ()) == (extlsa->GetAdvertisingRouter ()))
         {
           NS_LOG_LOGIC ("Found advertising router to destination");
-          SPFAddASExternal (extlsa,v);
+          m_trace.externals.push_back (std::make_pair (ext, m_vertexPositions[v->GetLSA ()]));
         }
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
@@ -1527,7 +2277,7 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
       if (!v->GetChild (i)->IsVertexProcessed ())
         {
           NS_LOG_LOGIC ("Vertex's child " << i << " not yet processed, processing...");
-          ProcessASExternals (v->GetChild (i), extlsa);
+          ProcessASExternals (v->GetChild (i), ext);
           v->GetChild (i)->SetVertexProcessed (true);
         }
     }
@@ -1539,129 +2289,66 @@ GlobalRouteManagerImpl::ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extl
 //
 
 void
-GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v)
+GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v)
 {
   NS_LOG_FUNCTION (this << extlsa << v);
 
-  NS_ASSERT_MSG (m_spfroot, "GlobalRouteManagerImpl::SPFAddASExternal (): Root pointer not set");
+  NS_ASSERT_MSG (!m_trace.vertices.empty (), "GlobalRouteManagerImpl::SPFAddASExternal (): Root not set");
 // Two cases to consider: We are advertising the external ourselves
 // => No need to add anything
 // OR find best path to the advertising router
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  SPFTraceVertex const &vertex = m_trace.vertices[v];
+  if (v == 0)
     {
       NS_LOG_LOGIC ("External is on local host: " 
-                    << v->GetVertexId () << "; returning");
+                    << vertex.id << "; returning");
       return;
     }
   NS_LOG_LOGIC ("External is on remote host: " 
                 << extlsa->GetAdvertisingRouter () << "; installing");
 
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_trace.vertices.front ().id;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
+// The routes are written to the routing table of the node at the root of
+// the SPF tree once the calculation is done, see InstallRoutes ().
 //
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
 //
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
+// The vertex <v> (corresponding to the node that advertises the external
+// network) has the exit directions precalculated for us: the next hop
+// addresses to which the root node should send packets, and the outbound
+// interfaces on which to send them.
 //
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < vertex.nExits; i++)
+    {
+      SPFVertex::NodeExit_t exit = m_trace.exits[vertex.firstExit + i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          AddRoute (SPF_AS_EXTERNAL_ROUTE, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
-
 // Processing logic from RFC 2328, page 166 and quagga ospf_spf_process_stubs ()
 // stub link records will exist for point-to-point interfaces and for
 // broadcast interfaces for which no neighboring router can be found
@@ -1670,23 +2357,13 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 {
   NS_LOG_FUNCTION (this << v);
   NS_LOG_LOGIC ("Processing stubs for " << v->GetVertexId ());
+//
+// The routes to the stub networks of the router are computed by
+// SPFAddRoutes (), from the position of the router in the tree.
+//
   if (v->GetVertexType () == SPFVertex::VertexRouter)
     {
-      GlobalRoutingLSA *rlsa = v->GetLSA ();
-      NS_LOG_LOGIC ("Processing router LSA with id " << rlsa->GetLinkStateId ());
-      for (uint32_t i = 0; i < rlsa->GetNLinkRecords (); i++)
-        {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
-                        v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
-          GlobalRoutingLinkRecord *l = v->GetLSA ()->GetLinkRecord (i);
-          if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
-            {
-              NS_LOG_LOGIC ("Found a Stub record to " << l->GetLinkId ());
-              SPFIntraAddStub (l, v);
-              continue;
-            }
-        }
+      m_trace.stubs.push_back (m_vertexPositions[v->GetLSA ()]);
     }
   for (uint32_t i = 0; i < v->GetNChildren (); i++)
     {
@@ -1700,142 +2377,71 @@ GlobalRouteManagerImpl::SPFProcessStubs (SPFVertex* v)
 
 // RFC2328 16.1. second stage. 
 void
-GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, uint32_t v)
 {
   NS_LOG_FUNCTION (this << l << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddStub (): Root pointer not set");
+  NS_ASSERT_MSG (!m_trace.vertices.empty (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): Root not set");
 
   // XXX simplifed logic for the moment.  There are two cases to consider:
   // 1) the stub network is on this router; do nothing for now
   //    (already handled above)
   // 2) the stub network is on a remote router, so I should use the
   // same next hop that I use to get to vertex v
-  if (v->GetVertexId () == m_spfroot->GetVertexId ())
+  SPFTraceVertex const &vertex = m_trace.vertices[v];
+  if (v == 0)
     {
-      NS_LOG_LOGIC ("Stub is on local host: " << v->GetVertexId () << "; returning");
+      NS_LOG_LOGIC ("Stub is on local host: " << vertex.id << "; returning");
       return;
     }
-  NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
+  NS_LOG_LOGIC ("Stub is on remote host: " << vertex.id << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries, once the calculation
+// is done (see InstallRoutes ()).
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_trace.vertices.front ().id;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// The vertex <v> (corresponding to the node that has the stub network)
+// has the exit directions precalculated for us: the next hop addresses
+// to which the root node should send packets to be forwarded to the stub
+// network, and the outbound interfaces on which to send them.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < vertex.nExits; i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      SPFVertex::NodeExit_t exit = m_trace.exits[vertex.firstExit + i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          AddRoute (SPF_NETWORK_ROUTE, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
 // Return the interface number corresponding to a given IP address and mask
-// This is a wrapper around GetInterfaceForPrefix(), but we first
-// have to find the right node pointer to pass to that function.
+// This is equivalent to GetInterfaceForPrefix() on the node at the root of
+// the SPF tree, whose addresses were gathered by SetRoot().
 // If no such interface is found, return -1 (note:  unit test framework
 // for routing assumes -1 to be a legal return value)
 //
@@ -1844,69 +2450,21 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
+// Look through the interfaces of the root node for one that has the IP
+// address we're looking for.  If we find one, return the corresponding
+// interface index, or -1 if not found.
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  for (RootAddresses_t::const_iterator i = m_rootAddresses.begin (); i != m_rootAddresses.end (); i++)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
+      if (i->second.CombineMask (amask) == a.CombineMask (amask))
         {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Look through the interfaces on this node for one that has the IP address
-// we're looking for.  If we find one, return the corresponding interface
-// index, or -1 if not found.
-//
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
-
-#if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
+          return i->first;
         }
     }
 //
 // Couldn't find it.
 //
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
+  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find interface for " << a);
   return -1;
 }
 
@@ -1927,77 +2485,33 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 // route.
 //
 void
-GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddRouter (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
+  NS_ASSERT_MSG (!m_trace.vertices.empty (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries, once the calculation
+// is done (see InstallRoutes ()).
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_trace.vertices.front ().id;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
-//
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  SPFTraceVertex const &vertex = m_trace.vertices[v];
+  GlobalRoutingLSA *lsa = m_lsdb->GetLSA (vertex.id);
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA for vertex " << vertex.id);
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2520,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Node " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,153 +2545,85 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < vertex.nExits; i++)
+        {
+          SPFVertex::NodeExit_t exit = m_trace.exits[vertex.firstExit + i];
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              AddRoute (SPF_HOST_ROUTE, lr->GetLinkData (), Ipv4Mask::GetOnes (), nextHop, outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
-GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
+GlobalRouteManagerImpl::SPFIntraAddTransit (uint32_t v)
 {
   NS_LOG_FUNCTION (this << v);
 
-  NS_ASSERT_MSG (m_spfroot, 
-                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
+  NS_ASSERT_MSG (!m_trace.vertices.empty (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries, once the calculation
+// is done (see InstallRoutes ()).
 //
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
+  Ipv4Address routerId = m_trace.vertices.front ().id;
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+// Get the Global Router Link State Advertisement from the vertex we're
+// adding the routes to.  This is the network LSA of the transit network.
+//
+  SPFTraceVertex const &vertex = m_trace.vertices[v];
+  GlobalRoutingLSA *lsa = m_lsdb->GetLSA (vertex.id);
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA for vertex " << vertex.id);
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < vertex.nExits; i++)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
+      SPFVertex::NodeExit_t exit = m_trace.exits[vertex.firstExit + i];
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-      if (rtr == 0)
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          AddRoute (SPF_NETWORK_ROUTE, tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
         }
-    } 
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -26,6 +26,7 @@
 #include <list>
 #include <queue>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -641,6 +642,13 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get the Link State Advertisements, other than the External ones.
+ *
+ * @param lsas the LSAs, in the order of their link state IDs
+ */
+  void GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -735,6 +743,21 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after the topology changed
+ *
+ * The routing database is built again, and the SPF calculations are only
+ * run again for the roots whose shortest path tree may be changed by the
+ * LSAs which changed.  The routes of the other roots are written from
+ * their trees, as recorded by the previous calculation.  In both cases,
+ * the routes are removed from the routing table when they are the only
+ * change, and the routing table is written again otherwise.
+ *
+ * The routing tables are the same as after DeleteGlobalRoutes (),
+ * BuildGlobalRoutingDatabase () and InitializeRoutes ().
+ */
+  virtual void UpdateGlobalRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +789,245 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+/**
+ * @brief Create a Global Route Manager Implementation which runs SPF
+ * calculations on the LSDB of another one, from a worker thread.
+ *
+ * @param lsdb the LSDB, which remains owned by the other manager
+ */
+  explicit GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+  /// the kinds of routes computed by the SPF calculation
+  enum SPFRouteType
+  {
+    SPF_HOST_ROUTE,        //!< a route added by AddHostRouteTo
+    SPF_NETWORK_ROUTE,     //!< a route added by AddNetworkRouteTo
+    SPF_AS_EXTERNAL_ROUTE  //!< a route added by AddASExternalRouteTo
+  };
+
+  /// a route computed by the SPF calculation, to be added to the root
+  struct SPFRoute
+  {
+    SPFRouteType type;    //!< the kind of route
+    Ipv4Address dest;     //!< the destination
+    Ipv4Mask mask;        //!< the destination mask, unused by host routes
+    Ipv4Address nextHop;  //!< the next hop
+    uint32_t outIf;       //!< the outgoing interface
+  };
+
+  typedef std::vector<SPFRoute> SPFRoutes_t; //!< container of SPF routes
+  /// container of the interfaces and addresses of a node
+  typedef std::vector<std::pair<int32_t, Ipv4Address> > RootAddresses_t;
+
+  /// the position of the LSAs which are not in a shortest path tree
+  static const uint32_t SPF_NO_VERTEX = 0xffffffff;
+
+  /// a vertex of a shortest path tree, as recorded by SPFCalculate ()
+  struct SPFTraceVertex
+  {
+    Ipv4Address id;                  //!< the link state ID of the LSA of the vertex
+    SPFVertex::VertexType type;      //!< the type of the vertex
+    uint32_t distance;               //!< the distance of the vertex from the root
+    uint32_t firstExit;              //!< the position of the first exit of the vertex in SPFTrace::exits
+    uint32_t nExits;                 //!< the number of exits of the vertex
+  };
+
+  /**
+   * \brief The shortest path tree of a root, as needed to write its routes
+   * and to tell whether changed LSAs may change it.
+   */
+  struct SPFTrace
+  {
+    RootAddresses_t addresses;                         //!< the addresses of the root
+    bool stub;                                         //!< whether the root is a stub node, see CheckForStubNode ()
+    std::vector<SPFTraceVertex> vertices;              //!< the vertices, in the order they joined the tree, from the root
+    std::vector<SPFVertex::NodeExit_t> exits;          //!< the exits from the root to the vertices
+    std::vector<uint32_t> positions;                   //!< the position in vertices of the LSAs, by LSA index, or SPF_NO_VERTEX
+    std::vector<uint32_t> stubs;                       //!< the vertices whose stub networks are routed, in order
+    std::vector<std::pair<uint32_t, uint32_t> > externals; //!< the External LSAs and the vertices advertising them, in order
+  };
+
+  /// a link of a router LSA, to a router
+  typedef std::pair<Ipv4Address, uint32_t> SPFLink_t;
+
+  /// a router LSA whose links to other routers changed
+  struct LSAChange
+  {
+    Ipv4Address id;                  //!< the link state ID of the LSA
+    bool removed;                    //!< whether the LSA was removed
+    bool reordered;                  //!< whether the links kept are in another order
+    std::vector<SPFLink_t> removedLinks; //!< the removed links, as (link ID, metric)
+    std::vector<SPFLink_t> addedLinks;   //!< the added links, as (link ID, metric)
+  };
+
+  /// the SPF calculations of a group of roots, shared by the worker threads
+  struct SPFBatch;
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_ownLsdb; //!< whether the LSDB is deleted with the manager
+  /// the SPF status of the LSAs in the current SPF calculation
+  std::unordered_map<GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_lsaStatus;
+  RootAddresses_t m_rootAddresses; //!< the addresses of the root node, in interface order
+  bool m_rootIsNode; //!< whether the root is a node of the simulation
+  SPFRoutes_t m_routes; //!< the routes computed by the current SPF calculation
+  SPFTrace m_trace; //!< the tree of the current SPF calculation
+  /// the position in the tree of the LSAs in the current SPF calculation
+  std::unordered_map<GlobalRoutingLSA*, uint32_t> m_vertexPositions;
+  /// the trees of the last SPF calculations, by node ID
+  std::map<uint32_t, SPFTrace> m_traces;
+  bool m_keepTraces; //!< whether the trees are kept, see UpdateGlobalRoutes ()
+  /// the index of the LSAs, by link state ID, for SPFTrace::positions
+  std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> m_lsaIndex;
+
+  /**
+   * \brief Get the SPF status of an LSA in the current SPF calculation
+   * \param lsa the LSA
+   * \returns the status
+   */
+  GlobalRoutingLSA::SPFStatus GetLSAStatus (GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the SPF status of an LSA in the current SPF calculation
+   * \param lsa the LSA
+   * \param status the status
+   */
+  void SetLSAStatus (GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+  /**
+   * \brief Get the interfaces and addresses of a node
+   * \param node the node
+   * \param addresses the interfaces and addresses, in interface order
+   */
+  static void GetRootAddresses (Ptr<Node> node, RootAddresses_t &addresses);
+
+  /**
+   * \brief Set the node at the root of the next SPF calculation
+   * \param node the node, or 0 if the root is not a node of the simulation
+   */
+  void SetRoot (Ptr<Node> node);
+
+  /**
+   * \brief Record a route computed by the SPF calculation
+   * \param type the kind of route
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param nextHop the next hop
+   * \param outIf the outgoing interface
+   */
+  void AddRoute (SPFRouteType type, Ipv4Address dest, Ipv4Mask mask,
+                 Ipv4Address nextHop, uint32_t outIf);
+
+  /**
+   * \brief Add the routes computed by an SPF calculation to the routing
+   * table of its root, in the order in which they were computed
+   * \param node the root node
+   * \param routes the routes
+   */
+  static void InstallRoutes (Ptr<Node> node, SPFRoutes_t const &routes);
+
+  /**
+   * \brief Make the routes computed by an SPF calculation the routes of
+   * the routing table of its root
+   *
+   * The routes which are no longer computed are removed if the other ones
+   * are in the routing table, in the same order; otherwise, the routing
+   * table is written again.
+   *
+   * \param node the root node
+   * \param routes the routes
+   */
+  static void UpdateRoutes (Ptr<Node> node, SPFRoutes_t const &routes);
+
+  /**
+   * \brief Remove all the routes of a node
+   * \param node the node
+   */
+  static void DeleteRoutes (Ptr<Node> node);
+
+  /**
+   * \brief Get the nodes whose routes are computed, in node order
+   * \param roots the nodes
+   */
+  static void GetRoots (std::vector<Ptr<Node> > &roots);
+
+  /**
+   * \brief Find the router LSAs whose links to other routers changed
+   *
+   * Only the changes to point-to-point links are described; the caller
+   * is told to run all the calculations again when the External LSAs,
+   * the network LSAs or the links to transit networks changed.
+   *
+   * \param lsdb the previous LSDB
+   * \param changes the changed router LSAs
+   * \returns true if all the calculations are to be run again
+   */
+  bool GetLSAChanges (GlobalRouteManagerLSDB* lsdb, std::vector<LSAChange> &changes) const;
+
+  /**
+   * \brief Tell whether the shortest path tree of a root may be changed
+   * by changed LSAs
+   * \param trace the tree recorded by the previous calculation
+   * \param changes the changed router LSAs
+   * \returns true if the calculation is to be run again
+   */
+  bool IsTreeChanged (SPFTrace const &trace, std::vector<LSAChange> const &changes) const;
+
+  /**
+   * \param trace a tree recorded by an SPF calculation
+   * \param id the link state ID of an LSA
+   * \returns the position of the LSA in the tree, or SPF_NO_VERTEX
+   */
+  uint32_t GetTracePosition (SPFTrace const &trace, Ipv4Address id) const;
+
+  /**
+   * \brief Get the number of threads which run the SPF calculations
+   * \param nRoots the number of SPF calculations
+   * \returns the number of threads, at least 1
+   */
+  static uint32_t GetSPFThreads (uint32_t nRoots);
+
+  /**
+   * \brief Run the SPF calculations of nodes, and write their routes
+   *
+   * The calculations may run on several threads.  Each calculation is run
+   * by a single thread, and the routes are written in the order of the
+   * roots once the calculations are done, so that the routing tables are
+   * the same whatever the number of threads.
+   *
+   * \param roots the root nodes
+   * \param replay for each root, whether its routes are written from the
+   * tree recorded by the previous calculation instead of a new one
+   * \param update whether the routes replace those of the routing tables
+   * (see UpdateRoutes ()) instead of being added to them
+   */
+  void SPFCalculateRoots (std::vector<Ptr<Node> > const &roots,
+                          std::vector<bool> const &replay, bool update);
+
+  /**
+   * \brief Run the SPF calculations of a batch until none is left
+   *
+   * This is the body of the worker threads.
+   *
+   * \param batch the batch
+   */
+  void SPFCalculateBatch (SPFBatch *batch);
+
+  /**
+   * \brief Add a vertex which joined the shortest path tree to the tree
+   * of the current SPF calculation
+   * \param v the vertex
+   */
+  void SPFRecordVertex (SPFVertex* v);
+
+  /**
+   * \brief Compute the routes of the tree of the current SPF calculation
+   *
+   * The routes to the vertices are computed in the order in which the
+   * vertices joined the tree, then the routes to the stub networks and
+   * the external routes, from the LSAs of the LSDB.
+   */
+  void SPFAddRoutes (void);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -804,9 +1064,9 @@ private:
    * \brief Process Autonomous Systems (AS) External LSA
    *
    * \param v vertex to be processed
-   * \param extlsa external LSA
+   * \param ext the index of the external LSA
    */
-  void ProcessASExternals (SPFVertex* v, GlobalRoutingLSA* extlsa);
+  void ProcessASExternals (SPFVertex* v, uint32_t ext);
 
   /**
    * \brief Examine the links in v's LSA and update the list of candidates with any
@@ -904,33 +1164,33 @@ private:
    * a destination IP address, reachable from the root, to which we add a host
    * route.
    *
-   * \param v the vertex
+   * \param v the position of the vertex in the current tree
    *
    */
-  void SPFIntraAddRouter (SPFVertex* v);
+  void SPFIntraAddRouter (uint32_t v);
 
   /**
    * \brief Add a transit to the routing tables
    *
-   * \param v the vertex
+   * \param v the position of the vertex in the current tree
    */
-  void SPFIntraAddTransit (SPFVertex* v);
+  void SPFIntraAddTransit (uint32_t v);
 
   /**
    * \brief Add a stub to the routing tables
    *
    * \param l the global routing link record
-   * \param v the vertex
+   * \param v the position of the vertex in the current tree
    */
-  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex* v);
+  void SPFIntraAddStub (GlobalRoutingLinkRecord *l, uint32_t v);
 
   /**
    * \brief Add an external route to the routing tables
    *
    * \param extlsa the external LSA
-   * \param v the vertex
+   * \param v the position of the vertex in the current tree
    */
-  void SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v);
+  void SPFAddASExternal (GlobalRoutingLSA *extlsa, uint32_t v);
 
   /**
    * \brief Return the interface number corresponding to a given IP address and mask
@@ -65,6 +65,16 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after the topology changed
+ *
+ * Only the SPF calculations whose trees may be changed by the Link State
+ * Advertisements which changed are run again.  The routes are the same as
+ * after DeleteGlobalRoutes (), BuildGlobalRoutingDatabase () and
+ * InitializeRoutes ().
+ */
+  static void UpdateGlobalRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -43,9 +43,9 @@
  * If the topology changes during the simulation, by default, routing
  * will not adjust.  There are two ways to make it adjust.
  * - Set the attribute Ipv4GlobalRouting::RespondToInterfaceEvents to true 
- * - Manually call the sequence of GlobalRouteManager methods to delte global
- *   routes, build global routing database, and initialize routes.
- *   There is a helper method that encapsulates this 
+ * - Manually call GlobalRouteManager::UpdateGlobalRoutes (), which builds
+ *   the global routing database again and recomputes the routes which may
+ *   have changed.  There is a helper method that encapsulates this 
  *   (Ipv4GlobalRoutingHelper::RecomputeRoutingTables())
  * 
  * \section api API and Usage
@@ -17,6 +17,7 @@
 //
 
 #include <vector>
+#include <algorithm>
 #include <iomanip>
 #include "ns3/names.h"
 #include "ns3/log.h"
@@ -59,7 +60,8 @@ Ipv4GlobalRouting::GetTypeId (void)
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_nextRank (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +82,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostIndex, route);
 }
 
 void 
@@ -90,6 +93,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostIndex, route);
 }
 
 void 
@@ -105,6 +109,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkIndex, route);
 }
 
 void 
@@ -118,6 +123,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkIndex, route);
 }
 
 void 
@@ -133,6 +139,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalIndex, route);
 }
 
 
@@ -147,71 +154,19 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   RouteVec_t allRoutes;
 
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
-    {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
-        {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
-        }
-    }
+  MatchRoutes (m_hostIndex, dest, oif, allRoutes);
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
-        {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
-        }
+      MatchRoutes (m_networkIndex, dest, oif, allRoutes);
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      MatchRoutes (m_ASexternalIndex, dest, oif, allRoutes);
+      if (allRoutes.size () > 1)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
-            {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
-            }
+          // only the first external route is considered
+          allRoutes.resize (1);
         }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
@@ -245,6 +200,80 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+void
+Ipv4GlobalRouting::IndexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  IndexedRoute indexed;
+  indexed.route = route;
+  indexed.rank = m_nextRank++;
+  index.Insert (key, route->GetDestNetworkMask ().GetPrefixLength (), indexed);
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  IndexedRoute indexed;
+  indexed.route = route;
+  indexed.rank = 0;
+  bool found = index.Remove (key, route->GetDestNetworkMask ().GetPrefixLength (), indexed);
+  NS_ASSERT (found);
+}
+
+bool
+Ipv4GlobalRouting::RankLess (IndexedRoute const &a, IndexedRoute const &b)
+{
+  return a.rank < b.rank;
+}
+
+void
+Ipv4GlobalRouting::MatchRoutes (RouteIndex const &index, Ipv4Address dest, Ptr<NetDevice> oif,
+                                std::vector<Ipv4RoutingTableEntry *> &routes) const
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  uint8_t key[4];
+  dest.Serialize (key);
+  RouteIndex::Values const *matches[33];
+  uint32_t lengths[33];
+  uint32_t nMatches = index.Match (key, matches, lengths);
+
+  std::vector<IndexedRoute> found;
+  for (uint32_t i = 0; i < nMatches; i++)
+    {
+      for (RouteIndex::Values::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          Ipv4RoutingTableEntry *route = j->route;
+          // the index only compares the leading bits of the mask
+          if (!route->GetDestNetworkMask ().IsMatch (dest, route->GetDestNetwork ()))
+            {
+              continue;
+            }
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          NS_LOG_LOGIC ("Found global route " << route << " with mask length " << lengths[i]);
+          found.push_back (*j);
+        }
+    }
+  if (nMatches > 1)
+    {
+      // routes to prefixes of different lengths are used in the order
+      // in which they were added, as the routing table is
+      std::sort (found.begin (), found.end (), RankLess);
+    }
+  for (std::vector<IndexedRoute>::const_iterator i = found.begin (); i != found.end (); i++)
+    {
+      routes.push_back (i->route);
+    }
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -319,6 +348,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostIndex, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +366,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkIndex, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +383,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalIndex, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -362,6 +394,78 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
   NS_ASSERT (false);
 }
 
+/**
+ * \param a a route
+ * \param b another route
+ * \return true if both routes have the same destination, mask, gateway
+ * and interface
+ */
+static bool
+IsSameRoute (Ipv4RoutingTableEntry const &a, Ipv4RoutingTableEntry const &b)
+{
+  return a.GetDest () == b.GetDest ()
+         && a.GetDestNetworkMask () == b.GetDestNetworkMask ()
+         && a.GetGateway () == b.GetGateway ()
+         && a.GetInterface () == b.GetInterface ();
+}
+
+bool
+Ipv4GlobalRouting::IsSubsequence (std::list<Ipv4RoutingTableEntry *> const &routes,
+                                  std::vector<Ipv4RoutingTableEntry> const &kept)
+{
+  std::vector<Ipv4RoutingTableEntry>::const_iterator k = kept.begin ();
+  for (std::list<Ipv4RoutingTableEntry *>::const_iterator i = routes.begin ();
+       i != routes.end () && k != kept.end (); i++)
+    {
+      if (IsSameRoute (**i, *k))
+        {
+          k++;
+        }
+    }
+  return k == kept.end ();
+}
+
+void
+Ipv4GlobalRouting::RetainRoutes (std::list<Ipv4RoutingTableEntry *> &routes, RouteIndex &index,
+                                 std::vector<Ipv4RoutingTableEntry> const &kept)
+{
+  std::vector<Ipv4RoutingTableEntry>::const_iterator k = kept.begin ();
+  std::list<Ipv4RoutingTableEntry *>::iterator i = routes.begin ();
+  while (i != routes.end ())
+    {
+      if (k != kept.end () && IsSameRoute (**i, *k))
+        {
+          k++;
+          i++;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Removing route " << **i);
+          UnindexRoute (index, *i);
+          delete *i;
+          i = routes.erase (i);
+        }
+    }
+}
+
+bool
+Ipv4GlobalRouting::RetainRoutes (std::vector<Ipv4RoutingTableEntry> const &hostRoutes,
+                                 std::vector<Ipv4RoutingTableEntry> const &networkRoutes,
+                                 std::vector<Ipv4RoutingTableEntry> const &externalRoutes)
+{
+  NS_LOG_FUNCTION (this << hostRoutes.size () << networkRoutes.size () << externalRoutes.size ());
+  if (!IsSubsequence (m_hostRoutes, hostRoutes)
+      || !IsSubsequence (m_networkRoutes, networkRoutes)
+      || !IsSubsequence (m_ASexternalRoutes, externalRoutes))
+    {
+      return false;
+    }
+  RetainRoutes (m_hostRoutes, m_hostIndex, hostRoutes);
+  RetainRoutes (m_networkRoutes, m_networkIndex, networkRoutes);
+  RetainRoutes (m_ASexternalRoutes, m_ASexternalIndex, externalRoutes);
+  return true;
+}
+
 int64_t
 Ipv4GlobalRouting::AssignStreams (int64_t stream)
 {
@@ -392,6 +496,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostIndex.Clear ();
+  m_networkIndex.Clear ();
+  m_ASexternalIndex.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -537,9 +644,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -549,9 +654,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
   NS_LOG_FUNCTION (this << i);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -561,9 +664,7 @@ Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress ad
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -573,9 +674,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
   NS_LOG_FUNCTION (this << interface << address);
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::UpdateGlobalRoutes ();
     }
 }
 
@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -218,6 +220,24 @@ public:
    */
   void RemoveRoute (uint32_t i);
 
+  /**
+   * \brief Remove the routes which are not in the given lists of routes.
+   *
+   * Each list holds the routes of one kind to keep, in the order of the
+   * routing table.  The routes are compared by destination, mask, gateway
+   * and interface.  If the routes of a list are not all in the routing
+   * table, in this order, no route is removed.
+   *
+   * \param hostRoutes the routes to hosts to keep
+   * \param networkRoutes the routes to networks to keep
+   * \param externalRoutes the external routes to keep
+   * \return true if the routes were removed, false if the routing table
+   * was left unchanged
+   */
+  bool RetainRoutes (std::vector<Ipv4RoutingTableEntry> const &hostRoutes,
+                     std::vector<Ipv4RoutingTableEntry> const &networkRoutes,
+                     std::vector<Ipv4RoutingTableEntry> const &externalRoutes);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -268,10 +288,79 @@ private:
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
 
+  /**
+   * \brief A route in the prefix indexes, with its rank in the list
+   * of routes that holds it
+   */
+  struct IndexedRoute
+  {
+    Ipv4RoutingTableEntry *route; //!< the route
+    uint64_t rank;                //!< ranks grow in the order of the list
+    /**
+     * \param o another indexed route
+     * \return true if both refer to the same route
+     */
+    bool operator == (IndexedRoute const &o) const
+    {
+      return route == o.route;
+    }
+  };
+
+  /// longest prefix match index of a container of routes
+  typedef PrefixTrie<IndexedRoute, 32> RouteIndex;
+
+  /**
+   * \brief Add a route to a prefix index
+   * \param index the index
+   * \param route the route, already appended to its container
+   */
+  void IndexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove a route from a prefix index
+   * \param index the index
+   * \param route the route
+   */
+  void UnindexRoute (RouteIndex &index, Ipv4RoutingTableEntry *route);
+  /**
+   * \param a an indexed route
+   * \param b another indexed route
+   * \return true if a comes before b in their container
+   */
+  static bool RankLess (IndexedRoute const &a, IndexedRoute const &b);
+  /**
+   * \brief Find the routes to an address in a prefix index
+   * \param index the index
+   * \param dest the destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \param routes the matching routes, in the order of their container
+   */
+  void MatchRoutes (RouteIndex const &index, Ipv4Address dest, Ptr<NetDevice> oif,
+                    std::vector<Ipv4RoutingTableEntry *> &routes) const;
+  /**
+   * \param routes a container of routes
+   * \param kept the routes to keep
+   * \return true if the routes to keep are in the container, in this order
+   */
+  static bool IsSubsequence (std::list<Ipv4RoutingTableEntry *> const &routes,
+                             std::vector<Ipv4RoutingTableEntry> const &kept);
+  /**
+   * \brief Remove the routes of a container which are not kept
+   * \param routes the container
+   * \param index the index of the container
+   * \param kept the routes to keep, a subsequence of the container
+   */
+  void RetainRoutes (std::list<Ipv4RoutingTableEntry *> &routes, RouteIndex &index,
+                     std::vector<Ipv4RoutingTableEntry> const &kept);
+
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  RouteIndex m_hostIndex;       //!< Index of the routes to hosts
+  RouteIndex m_networkIndex;    //!< Index of the routes to networks
+  RouteIndex m_ASexternalIndex; //!< Index of the external routes
+  uint64_t m_nextRank;          //!< The rank of the next route added
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -59,6 +59,28 @@ Ipv4StaticRouting::Ipv4StaticRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4StaticRouting::AppendNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  m_networkRoutes.push_back (std::make_pair (route, metric));
+  uint8_t key[4];
+  route->GetDestNetwork ().Serialize (key);
+  m_networkIndex.Insert (key, route->GetDestNetworkMask ().GetPrefixLength (), m_networkRoutes.back ());
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute (NetworkRoutesI i)
+{
+  NS_LOG_FUNCTION (this << i->first);
+  uint8_t key[4];
+  i->first->GetDestNetwork ().Serialize (key);
+  bool found = m_networkIndex.Remove (key, i->first->GetDestNetworkMask ().GetPrefixLength (), *i);
+  NS_ASSERT (found);
+  delete i->first;
+  return m_networkRoutes.erase (i);
+}
+
 void 
 Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network, 
                                       Ipv4Mask networkMask, 
@@ -72,7 +94,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  AppendNetworkRoute (route, metric);
 }
 
 void 
@@ -86,7 +108,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  AppendNetworkRoute (route, metric);
 }
 
 void 
@@ -143,7 +165,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  AppendNetworkRoute (route, 0);
 }
 
 uint32_t 
@@ -224,8 +246,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -240,18 +260,33 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  uint8_t key[4];
+  dest.Serialize (key);
+  NetworkIndex::Values const *matches[33];
+  uint32_t lengths[33];
+  uint32_t nMatches = m_networkIndex.Match (key, matches, lengths);
+
+  // The longest matching prefix wins; among its routes, the last one
+  // with the lowest metric wins, except for host routes where the
+  // first one wins.
+  Ipv4RoutingTableEntry *route = 0;
+  for (uint32_t i = nMatches; i > 0 && route == 0; i--)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint16_t masklen = lengths[i - 1];
+      uint32_t shortest_metric = 0xffffffff;
+      for (NetworkIndex::Values::const_iterator k = matches[i - 1]->begin ();
+           k != matches[i - 1]->end ();
+           k++)
         {
+          Ipv4RoutingTableEntry *j = k->first;
+          uint32_t metric = k->second;
+          Ipv4Mask mask = (j)->GetDestNetworkMask ();
+          Ipv4Address entry = (j)->GetDestNetwork ();
+          NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
+          if (!mask.IsMatch (dest, entry))
+            {
+              continue;
+            }
           NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
           if (oif != 0)
             {
@@ -261,35 +296,28 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+          route = j;
           if (masklen == 32)
             {
               break;
             }
         }
     }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+    }
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " at the end");
@@ -447,8 +475,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseNetworkRoute (j);
           return;
         }
       tmp++;
@@ -575,6 +602,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkIndex.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,8 +641,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -660,8 +687,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
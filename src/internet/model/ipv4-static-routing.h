@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +414,33 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /// longest prefix match index of the routes to networks
+  typedef PrefixTrie<std::pair <Ipv4RoutingTableEntry *, uint32_t>, 32> NetworkIndex;
+
+  /**
+   * \brief Append a route to the forwarding table for network.
+   * \param route the route
+   * \param metric the route metric
+   */
+  void AppendNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table for network, and delete it.
+   * \param i the route
+   * \return the route which followed it
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI i);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of the forwarding table for network, by prefix.
+   */
+  NetworkIndex m_networkIndex;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -146,12 +146,32 @@ void Ipv6StaticRouting::AddHostRouteTo (Ipv6Address dst, uint32_t interface, uin
   AddNetworkRouteTo (dst, Ipv6Prefix::GetOnes (), interface, metric);
 }
 
+void Ipv6StaticRouting::AppendNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  m_networkRoutes.push_back (std::make_pair (route, metric));
+  uint8_t key[16];
+  route->GetDestNetwork ().GetBytes (key);
+  m_networkIndex.Insert (key, route->GetDestNetworkPrefix ().GetPrefixLength (), m_networkRoutes.back ());
+}
+
+Ipv6StaticRouting::NetworkRoutesI Ipv6StaticRouting::EraseNetworkRoute (NetworkRoutesI it)
+{
+  NS_LOG_FUNCTION (this << it->first);
+  uint8_t key[16];
+  it->first->GetDestNetwork ().GetBytes (key);
+  bool found = m_networkIndex.Remove (key, it->first->GetDestNetworkPrefix ().GetPrefixLength (), *it);
+  NS_ASSERT (found);
+  delete it->first;
+  return m_networkRoutes.erase (it);
+}
+
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, uint32_t metric)
 {
   NS_LOG_FUNCTION (this << network << networkPrefix << nextHop << interface << metric);
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AppendNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -164,7 +184,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
 
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, nextHop, interface, prefixToUse);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AppendNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix networkPrefix, uint32_t interface, uint32_t metric)
@@ -172,7 +192,7 @@ void Ipv6StaticRouting::AddNetworkRouteTo (Ipv6Address network, Ipv6Prefix netwo
   NS_LOG_FUNCTION (this << network << networkPrefix << interface);
   Ipv6RoutingTableEntry* route = new Ipv6RoutingTableEntry ();
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkPrefix, interface);
-  m_networkRoutes.push_back (std::make_pair (route, metric));
+  AppendNetworkRoute (route, metric);
 }
 
 void Ipv6StaticRouting::SetDefaultRoute (Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse, uint32_t metric)
@@ -196,7 +216,7 @@ void Ipv6StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   Ipv6Address network = Ipv6Address ("ff00::"); /* RFC 3513 */
   Ipv6Prefix networkMask = Ipv6Prefix (8);
   *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo (network, networkMask, outputInterface);
-  m_networkRoutes.push_back (std::make_pair (route, 0));
+  AppendNetworkRoute (route, 0);
 }
 
 uint32_t Ipv6StaticRouting::GetNMulticastRoutes () const
@@ -265,15 +285,23 @@ bool Ipv6StaticRouting::HasNetworkDest (Ipv6Address network, uint32_t interfaceI
   NS_LOG_FUNCTION (this << network << interfaceIndex);
 
   /* in the network table */
-  for (NetworkRoutesI j = m_networkRoutes.begin (); j != m_networkRoutes.end (); j++)
-    {
-      Ipv6RoutingTableEntry* rtentry = j->first;
-      Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix ();
-      Ipv6Address entry = rtentry->GetDestNetwork ();
-
-      if (prefix.IsMatch (network, entry) && rtentry->GetInterface () == interfaceIndex)
+  uint8_t key[16];
+  network.GetBytes (key);
+  NetworkIndex::Values const *matches[129];
+  uint32_t lengths[129];
+  uint32_t nMatches = m_networkIndex.Match (key, matches, lengths);
+  for (uint32_t i = 0; i < nMatches; i++)
+    {
+      for (NetworkIndex::Values::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
         {
-          return true;
+          Ipv6RoutingTableEntry* rtentry = j->first;
+          Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix ();
+          Ipv6Address entry = rtentry->GetDestNetwork ();
+
+          if (prefix.IsMatch (network, entry) && rtentry->GetInterface () == interfaceIndex)
+            {
+              return true;
+            }
         }
     }
 
@@ -285,8 +313,6 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
 {
   NS_LOG_FUNCTION (this << dst << interface);
   Ptr<Ipv6Route> rtentry = 0;
-  uint16_t longestMask = 0;
-  uint32_t shortestMetric = 0xffffffff;
 
   /* when sending on link-local multicast, there have to be interface specified */
   if (dst.IsLinkLocalMulticast ())
@@ -300,68 +326,78 @@ Ptr<Ipv6Route> Ipv6StaticRouting::LookupStatic (Ipv6Address dst, Ptr<NetDevice>
       return rtentry;
     }
 
-  for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); it++)
+  uint8_t key[16];
+  dst.GetBytes (key);
+  NetworkIndex::Values const *matches[129];
+  uint32_t lengths[129];
+  uint32_t nMatches = m_networkIndex.Match (key, matches, lengths);
+
+  /* the longest matching prefix wins; among its routes, the last one with
+   * the lowest metric wins, except for host routes where the first one wins
+   */
+  Ipv6RoutingTableEntry* route = 0;
+  for (uint32_t i = nMatches; i > 0 && route == 0; i--)
     {
-      Ipv6RoutingTableEntry* j = it->first;
-      uint32_t metric = it->second;
-      Ipv6Prefix mask = j->GetDestNetworkPrefix ();
-      uint16_t maskLen = mask.GetPrefixLength ();
-      Ipv6Address entry = j->GetDestNetwork ();
+      uint16_t maskLen = lengths[i - 1];
+      uint32_t shortestMetric = 0xffffffff;
+      for (NetworkIndex::Values::const_iterator it = matches[i - 1]->begin (); it != matches[i - 1]->end (); it++)
+        {
+          Ipv6RoutingTableEntry* j = it->first;
+          uint32_t metric = it->second;
+          Ipv6Prefix mask = j->GetDestNetworkPrefix ();
+          Ipv6Address entry = j->GetDestNetwork ();
 
-      NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
+          NS_LOG_LOGIC ("Searching for route to " << dst << ", mask length " << maskLen << ", metric " << metric);
+
+          if (!mask.IsMatch (dst, entry))
+            {
+              continue;
+            }
 
-      if (mask.IsMatch (dst, entry))
-        {
           NS_LOG_LOGIC ("Found global network route " << *j << ", mask length " << maskLen << ", metric " << metric);
 
           /* if interface is given, check the route will output on this interface */
-          if (!interface || interface == m_ipv6->GetNetDevice (j->GetInterface ()))
+          if (interface && interface != m_ipv6->GetNetDevice (j->GetInterface ()))
             {
-              if (maskLen < longestMask)
-                {
-                  NS_LOG_LOGIC ("Previous match longer, skipping");
-                  continue;
-                }
-
-              if (maskLen > longestMask)
-                {
-                  shortestMetric = 0xffffffff;
-                }
+              continue;
+            }
 
-              longestMask = maskLen;
-              if (metric > shortestMetric)
-                {
-                  NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
-                  continue;
-                }
+          if (metric > shortestMetric)
+            {
+              NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
+              continue;
+            }
 
-              shortestMetric = metric;
-              Ipv6RoutingTableEntry* route = j;
-              uint32_t interfaceIdx = route->GetInterface ();
-              rtentry = Create<Ipv6Route> ();
+          shortestMetric = metric;
+          route = j;
+          if (maskLen == 128)
+            {
+              break;
+            }
+        }
+    }
 
-              if (route->GetGateway ().IsAny ())
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-                }
-              else if (route->GetDest ().IsAny ()) /* default route */
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
-                }
-              else
-                {
-                  rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
-                }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv6Route> ();
 
-              rtentry->SetDestination (route->GetDest ());
-              rtentry->SetGateway (route->GetGateway ());
-              rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
-              if (maskLen == 128)
-                {
-                  break;
-                }
-            }
+      if (route->GetGateway ().IsAny ())
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+        }
+      else if (route->GetDest ().IsAny ()) /* default route */
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetPrefixToUse ().IsAny () ? dst : route->GetPrefixToUse ()));
         }
+      else
+        {
+          rtentry->SetSource (m_ipv6->SourceAddressSelection (interfaceIdx, route->GetGateway ()));
+        }
+
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
     }
 
   if (rtentry)
@@ -380,6 +416,7 @@ void Ipv6StaticRouting::DoDispose ()
       delete j->first;
     }
   m_networkRoutes.clear ();
+  m_networkIndex.Clear ();
 
   for (MulticastRoutesI i = m_multicastRoutes.begin (); i != m_multicastRoutes.end (); i = m_multicastRoutes.erase (i))
     {
@@ -528,8 +565,7 @@ void Ipv6StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseNetworkRoute (it);
           return;
         }
       tmp++;
@@ -547,8 +583,7 @@ void Ipv6StaticRouting::RemoveRoute (Ipv6Address network, Ipv6Prefix prefix, uin
       if (network == rtentry->GetDest () && rtentry->GetInterface () == ifIndex
           && rtentry->GetPrefixToUse () == prefixToUse)
         {
-          delete it->first;
-          m_networkRoutes.erase (it);
+          EraseNetworkRoute (it);
           return;
         }
     }
@@ -672,8 +707,7 @@ void Ipv6StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -717,8 +751,7 @@ void Ipv6StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAd
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkPrefix () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -761,8 +794,7 @@ void Ipv6StaticRouting::NotifyRemoveRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv
 
           if (dst == entry && prefix == mask && rtentry->GetInterface () == interface)
             {
-              delete j->first;
-              j = m_networkRoutes.erase (j);
+              j = EraseNetworkRoute (j);
             }
           else
             {
@@ -30,6 +30,7 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-header.h"
 #include "ns3/ipv6-routing-protocol.h"
+#include "ns3/prefix-trie.h"
 
 namespace ns3 {
 
@@ -281,11 +282,38 @@ private:
    */
   Ptr<Ipv6MulticastRoute> LookupStatic (Ipv6Address origin, Ipv6Address group, uint32_t ifIndex);
 
+  /**
+   * \brief Longest prefix match index of the network routes.
+   *
+   * The routes to the same prefix through different interfaces, such as
+   * the link-local routes, share an entry.
+   */
+  typedef PrefixTrie<std::pair <Ipv6RoutingTableEntry *, uint32_t>, 128> NetworkIndex;
+
+  /**
+   * \brief Append a route to the forwarding table for network.
+   * \param route the route
+   * \param metric the route metric
+   */
+  void AppendNetworkRoute (Ipv6RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the forwarding table for network, and delete it.
+   * \param it the route
+   * \return the route which followed it
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI it);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the index of the forwarding table for network, by prefix.
+   */
+  NetworkIndex m_networkIndex;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -0,0 +1,417 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PREFIX_TRIE_H
+#define PREFIX_TRIE_H
+
+#include <stdint.h>
+#include <cstring>
+#include <vector>
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ * \brief A path-compressed binary trie of address prefixes, for longest
+ * prefix match lookups.
+ *
+ * Each prefix holds a list of values, kept in insertion order, so that
+ * a routing protocol can store several routes to the same prefix.  The
+ * trie is a Patricia trie: a node exists only for a prefix which holds
+ * values or where two branches fork, so that a lookup visits at most as
+ * many nodes as there are distinct matching prefix lengths plus forks,
+ * and inserting or removing a prefix touches only the nodes on its path.
+ *
+ * The keys are addresses of BITS bits in network byte order.  The bits
+ * of a key beyond the length of its prefix are ignored.
+ *
+ * The nodes are stored in a single array and refer to each other by
+ * index, so that the trie does not allocate a node per prefix.
+ */
+template <typename T, uint32_t BITS>
+class PrefixTrie
+{
+public:
+  /// the values of a prefix
+  typedef std::vector<T> Values;
+
+  PrefixTrie ();
+
+  /**
+   * \brief Append a value to the values of a prefix
+   * \param key the prefix address, in network byte order
+   * \param length the prefix length (bits)
+   * \param value the value
+   */
+  void Insert (const uint8_t *key, uint32_t length, T const &value);
+  /**
+   * \brief Remove a value from the values of a prefix
+   * \param key the prefix address, in network byte order
+   * \param length the prefix length (bits)
+   * \param value the value; the first value equal to it is removed
+   * \return true if the value was found
+   */
+  bool Remove (const uint8_t *key, uint32_t length, T const &value);
+  /**
+   * \param key the prefix address, in network byte order
+   * \param length the prefix length (bits)
+   * \return the values of the prefix, or 0 if it holds none
+   */
+  Values const *Find (const uint8_t *key, uint32_t length) const;
+  /**
+   * \brief Find the prefixes which match an address
+   * \param key the address, in network byte order
+   * \param matches the values of the matching prefixes, shortest prefix first
+   * \param lengths the lengths of the matching prefixes
+   * \return the number of matching prefixes
+   */
+  uint32_t Match (const uint8_t *key, Values const *matches[BITS + 1], uint32_t lengths[BITS + 1]) const;
+  /**
+   * \brief Remove all the prefixes
+   */
+  void Clear (void);
+
+private:
+  /// a node of the trie
+  struct Node
+  {
+    uint8_t key[BITS / 8]; //!< the prefix, with the bits beyond its length cleared
+    uint32_t length;       //!< the prefix length
+    uint32_t parent;       //!< the parent node, or NONE for the root
+    uint32_t child[2];     //!< the subtrees whose next bit is 0 and 1, or NONE
+    Values values;         //!< the values of the prefix
+  };
+
+  /// the index of no node
+  static const uint32_t NONE = 0xffffffff;
+
+  /**
+   * \param key an address
+   * \param i the bit index, from the most significant bit
+   * \return the bit
+   */
+  static uint32_t GetBit (const uint8_t *key, uint32_t i);
+  /**
+   * \param a an address
+   * \param b another address
+   * \param max the maximum number of bits to compare
+   * \return the number of leading bits which are equal, at most max
+   */
+  static uint32_t GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max);
+  /**
+   * \param key the prefix address
+   * \param length the prefix length
+   * \return the node of the prefix, or NONE
+   */
+  uint32_t FindNode (const uint8_t *key, uint32_t length) const;
+  /**
+   * \brief Allocate a node with no value and no child
+   * \param key the prefix address
+   * \param length the prefix length
+   * \param parent the parent node
+   * \return the new node
+   */
+  uint32_t NewNode (const uint8_t *key, uint32_t length, uint32_t parent);
+  /**
+   * \brief Make a node take the place of another under their parent
+   * \param old the node to replace
+   * \param n the new node, or NONE
+   */
+  void ReplaceNode (uint32_t old, uint32_t n);
+  /**
+   * \brief Remove the nodes which no longer hold values nor fork,
+   * from a node up to the root
+   * \param n the node to start from
+   */
+  void Prune (uint32_t n);
+
+  std::vector<Node> m_nodes;     //!< the nodes, in use or free
+  std::vector<uint32_t> m_free;  //!< the free nodes
+  uint32_t m_root;               //!< the root node, or NONE
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T, uint32_t BITS>
+PrefixTrie<T, BITS>::PrefixTrie ()
+  : m_root (NONE)
+{
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::GetBit (const uint8_t *key, uint32_t i)
+{
+  return (key[i / 8] >> (7 - i % 8)) & 1;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::GetCommonLength (const uint8_t *a, const uint8_t *b, uint32_t max)
+{
+  uint32_t length = 0;
+  for (uint32_t i = 0; length < max; i++)
+    {
+      uint8_t diff = a[i] ^ b[i];
+      if (diff != 0)
+        {
+          while ((diff & 0x80) == 0)
+            {
+              diff <<= 1;
+              length++;
+            }
+          break;
+        }
+      length += 8;
+    }
+  return length < max ? length : max;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Insert (const uint8_t *key, uint32_t length, T const &value)
+{
+  NS_ASSERT (length <= BITS);
+  uint32_t parent = NONE;
+  uint32_t bit = 0;
+  uint32_t n = m_root;
+  while (n != NONE)
+    {
+      uint32_t nodeLength = m_nodes[n].length;
+      uint32_t common = GetCommonLength (key, m_nodes[n].key,
+                                         length < nodeLength ? length : nodeLength);
+      if (common == nodeLength)
+        {
+          if (common == length)
+            {
+              m_nodes[n].values.push_back (value);
+              return;
+            }
+          parent = n;
+          bit = GetBit (key, nodeLength);
+          n = m_nodes[n].child[bit];
+          continue;
+        }
+      // The prefix leaves the path of the node: insert a node for the
+      // common part above it.
+      uint32_t fork = NewNode (key, common, parent);
+      ReplaceNode (n, fork);
+      m_nodes[fork].child[GetBit (m_nodes[n].key, common)] = n;
+      m_nodes[n].parent = fork;
+      if (common == length)
+        {
+          m_nodes[fork].values.push_back (value);
+        }
+      else
+        {
+          uint32_t leaf = NewNode (key, length, fork);
+          m_nodes[fork].child[GetBit (key, common)] = leaf;
+          m_nodes[leaf].values.push_back (value);
+        }
+      return;
+    }
+  uint32_t leaf = NewNode (key, length, parent);
+  if (parent == NONE)
+    {
+      m_root = leaf;
+    }
+  else
+    {
+      m_nodes[parent].child[bit] = leaf;
+    }
+  m_nodes[leaf].values.push_back (value);
+}
+
+template <typename T, uint32_t BITS>
+bool
+PrefixTrie<T, BITS>::Remove (const uint8_t *key, uint32_t length, T const &value)
+{
+  uint32_t n = FindNode (key, length);
+  if (n == NONE)
+    {
+      return false;
+    }
+  Values &values = m_nodes[n].values;
+  for (typename Values::iterator i = values.begin (); i != values.end (); i++)
+    {
+      if (*i == value)
+        {
+          values.erase (i);
+          if (values.empty ())
+            {
+              Prune (n);
+            }
+          return true;
+        }
+    }
+  return false;
+}
+
+template <typename T, uint32_t BITS>
+typename PrefixTrie<T, BITS>::Values const *
+PrefixTrie<T, BITS>::Find (const uint8_t *key, uint32_t length) const
+{
+  uint32_t n = FindNode (key, length);
+  if (n == NONE || m_nodes[n].values.empty ())
+    {
+      return 0;
+    }
+  return &m_nodes[n].values;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::Match (const uint8_t *key, Values const *matches[BITS + 1], uint32_t lengths[BITS + 1]) const
+{
+  uint32_t nMatches = 0;
+  uint32_t n = m_root;
+  while (n != NONE)
+    {
+      Node const &node = m_nodes[n];
+      if (GetCommonLength (key, node.key, node.length) < node.length)
+        {
+          break;
+        }
+      if (!node.values.empty ())
+        {
+          matches[nMatches] = &node.values;
+          lengths[nMatches] = node.length;
+          nMatches++;
+        }
+      if (node.length == BITS)
+        {
+          break;
+        }
+      n = node.child[GetBit (key, node.length)];
+    }
+  return nMatches;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Clear (void)
+{
+  m_nodes.clear ();
+  m_free.clear ();
+  m_root = NONE;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::FindNode (const uint8_t *key, uint32_t length) const
+{
+  uint32_t n = m_root;
+  while (n != NONE)
+    {
+      Node const &node = m_nodes[n];
+      if (node.length > length
+          || GetCommonLength (key, node.key, node.length) < node.length)
+        {
+          return NONE;
+        }
+      if (node.length == length)
+        {
+          return n;
+        }
+      n = node.child[GetBit (key, node.length)];
+    }
+  return NONE;
+}
+
+template <typename T, uint32_t BITS>
+uint32_t
+PrefixTrie<T, BITS>::NewNode (const uint8_t *key, uint32_t length, uint32_t parent)
+{
+  uint32_t n;
+  if (m_free.empty ())
+    {
+      n = m_nodes.size ();
+      m_nodes.push_back (Node ());
+    }
+  else
+    {
+      n = m_free.back ();
+      m_free.pop_back ();
+    }
+  Node &node = m_nodes[n];
+  std::memset (node.key, 0, BITS / 8);
+  std::memcpy (node.key, key, (length + 7) / 8);
+  if (length % 8 != 0)
+    {
+      node.key[length / 8] &= 0xff << (8 - length % 8);
+    }
+  node.length = length;
+  node.parent = parent;
+  node.child[0] = NONE;
+  node.child[1] = NONE;
+  return n;
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::ReplaceNode (uint32_t old, uint32_t n)
+{
+  uint32_t parent = m_nodes[old].parent;
+  if (n != NONE)
+    {
+      m_nodes[n].parent = parent;
+    }
+  if (parent == NONE)
+    {
+      m_root = n;
+    }
+  else if (m_nodes[parent].child[0] == old)
+    {
+      m_nodes[parent].child[0] = n;
+    }
+  else
+    {
+      m_nodes[parent].child[1] = n;
+    }
+}
+
+template <typename T, uint32_t BITS>
+void
+PrefixTrie<T, BITS>::Prune (uint32_t n)
+{
+  while (n != NONE && m_nodes[n].values.empty ())
+    {
+      uint32_t parent = m_nodes[n].parent;
+      uint32_t *child = m_nodes[n].child;
+      if (child[0] != NONE && child[1] != NONE)
+        {
+          return;
+        }
+      uint32_t only = child[0] != NONE ? child[0] : child[1];
+      ReplaceNode (n, only);
+      Values ().swap (m_nodes[n].values);
+      m_free.push_back (n);
+      if (only != NONE)
+        {
+          // The parent still forks between this subtree and another one.
+          return;
+        }
+      n = parent;
+    }
+}
+
+} // namespace ns3
+
+#endif /* PREFIX_TRIE_H */
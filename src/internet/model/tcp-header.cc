@@ -24,6 +24,7 @@
 #include "tcp-option.h"
 #include "ns3/buffer.h"
 #include "ns3/address-utils.h"
+#include "ns3/ip-checksum.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -228,36 +229,31 @@ TcpHeader::CalculateHeaderChecksum (uint16_t size) const
   /* Zero                   3 bytes                                        */
   /* Next header            1 byte                                         */
 
-  uint32_t maxHdrSz = (2 * Address::MAX_SIZE) + 8;
-  Buffer buf = Buffer (maxHdrSz);
-  buf.AddAtStart (maxHdrSz);
-  Buffer::Iterator it = buf.Begin ();
-  uint32_t hdrSize = 0;
+  uint8_t hdr[(2 * Address::MAX_SIZE) + 8];
+  uint32_t hdrSize = m_source.CopyTo (hdr);
+  hdrSize += m_destination.CopyTo (hdr + hdrSize);
 
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      hdrSize = 12;
+      hdr[hdrSize++] = 0; /* protocol */
+      hdr[hdrSize++] = m_protocol; /* protocol */
+      hdr[hdrSize++] = size >> 8; /* length */
+      hdr[hdrSize++] = size & 0xff; /* length */
     }
   else
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
-      hdrSize = 40;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = size >> 8; /* length */
+      hdr[hdrSize++] = size & 0xff; /* length */
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = m_protocol; /* protocol */
     }
 
-  it = buf.Begin ();
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return IpChecksumPartial (hdr, hdrSize);
 }
 
 bool
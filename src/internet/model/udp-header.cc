@@ -20,6 +20,7 @@
 
 #include "udp-header.h"
 #include "ns3/address-utils.h"
+#include "ns3/ip-checksum.h"
 
 namespace ns3 {
 
@@ -101,35 +102,34 @@ UdpHeader::InitializeChecksum (Ipv6Address source,
 uint16_t
 UdpHeader::CalculateHeaderChecksum (uint16_t size) const
 {
-  Buffer buf = Buffer ((2 * Address::MAX_SIZE) + 8);
-  buf.AddAtStart ((2 * Address::MAX_SIZE) + 8);
-  Buffer::Iterator it = buf.Begin ();
+  uint8_t hdr[(2 * Address::MAX_SIZE) + 8];
   uint32_t hdrSize = 0;
 
-  WriteTo (it, m_source);
-  WriteTo (it, m_destination);
   if (Ipv4Address::IsMatchingType (m_source))
     {
-      it.WriteU8 (0); /* protocol */
-      it.WriteU8 (m_protocol); /* protocol */
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      hdrSize = 12;
+      hdrSize = m_source.CopyTo (hdr);
+      hdrSize += m_destination.CopyTo (hdr + hdrSize);
+      hdr[hdrSize++] = 0; /* protocol */
+      hdr[hdrSize++] = m_protocol; /* protocol */
+      hdr[hdrSize++] = size >> 8; /* length */
+      hdr[hdrSize++] = size & 0xff; /* length */
     }
   else if (Ipv6Address::IsMatchingType (m_source))
     {
-      it.WriteU16 (0);
-      it.WriteU8 (size >> 8); /* length */
-      it.WriteU8 (size & 0xff); /* length */
-      it.WriteU16 (0);
-      it.WriteU8 (0);
-      it.WriteU8 (m_protocol); /* protocol */
-      hdrSize = 40;
+      hdrSize = m_source.CopyTo (hdr);
+      hdrSize += m_destination.CopyTo (hdr + hdrSize);
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = size >> 8; /* length */
+      hdr[hdrSize++] = size & 0xff; /* length */
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = 0;
+      hdr[hdrSize++] = m_protocol; /* protocol */
     }
 
-  it = buf.Begin ();
   /* we don't CompleteChecksum ( ~ ) now */
-  return ~(it.CalculateIpChecksum (hdrSize));
+  return IpChecksumPartial (hdr, hdrSize);
 }
 
 bool
@@ -26,7 +26,11 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/random-variable-stream.h"
 #include <cstdlib> // for rand()
+#include <algorithm>
+#include <list>
+#include <vector>
 
 using namespace ns3;
 
@@ -225,6 +229,112 @@ GlobalRouteManagerImplTestCase::DoRun (void)
   // does not crash
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief CandidateQueue Test
+ *
+ * Checks that the vertices are popped in the order of the sorted list
+ * which the queue used to be, while vertices are pushed, popped and
+ * have their distance decreased.
+ */
+class CandidateQueueTestCase : public TestCase
+{
+public:
+  CandidateQueueTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief The order of the vertices in the sorted list.
+   * \param v1 first operand
+   * \param v2 second operand
+   * \return True if v1 should be popped before v2
+   */
+  static bool Compare (const SPFVertex* v1, const SPFVertex* v2);
+};
+
+CandidateQueueTestCase::CandidateQueueTestCase ()
+  : TestCase ("CandidateQueueTestCase")
+{
+}
+
+bool
+CandidateQueueTestCase::Compare (const SPFVertex* v1, const SPFVertex* v2)
+{
+  if (v1->GetDistanceFromRoot () != v2->GetDistanceFromRoot ())
+    {
+      return v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ();
+    }
+  return v1->GetVertexType () == SPFVertex::VertexNetwork
+    && v2->GetVertexType () == SPFVertex::VertexRouter;
+}
+
+void
+CandidateQueueTestCase::DoRun (void)
+{
+  CandidateQueue candidate;
+  std::list<SPFVertex*> sorted;
+  std::vector<SPFVertex*> queued;
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint32_t id = 1;
+
+  for (uint32_t i = 0; i < 4000; i++)
+    {
+      uint32_t op = queued.empty () ? 0 : rng->GetInteger (0, 3);
+      if (op == 0 || (op == 1 && i < 2000))
+        {
+          SPFVertex *v = new SPFVertex;
+          v->SetVertexId (Ipv4Address (id++));
+          v->SetVertexType (rng->GetInteger (0, 1) ? SPFVertex::VertexRouter : SPFVertex::VertexNetwork);
+          v->SetDistanceFromRoot (rng->GetInteger (0, 40));
+          candidate.Push (v);
+          sorted.insert (std::upper_bound (sorted.begin (), sorted.end (), v, &Compare), v);
+          queued.push_back (v);
+        }
+      else if (op == 1 || op == 2)
+        {
+          SPFVertex *v = queued[rng->GetInteger (0, queued.size () - 1)];
+          NS_TEST_ASSERT_MSG_EQ (candidate.Find (v->GetVertexId ()), v, "Vertex not found");
+          if (v->GetDistanceFromRoot () == 0)
+            {
+              continue;
+            }
+          v->SetDistanceFromRoot (rng->GetInteger (0, v->GetDistanceFromRoot () - 1));
+          if (op == 1)
+            {
+              candidate.Reorder (v);
+            }
+          else
+            {
+              candidate.Reorder ();
+            }
+          sorted.sort (&Compare);
+        }
+      else
+        {
+          SPFVertex *v = candidate.Pop ();
+          NS_TEST_ASSERT_MSG_EQ (v, sorted.front (), "Vertex popped out of order");
+          sorted.pop_front ();
+          queued.erase (std::find (queued.begin (), queued.end (), v));
+          NS_TEST_EXPECT_MSG_EQ (candidate.Find (v->GetVertexId ()), 0, "Popped vertex found");
+          delete v;
+        }
+      NS_TEST_ASSERT_MSG_EQ (candidate.Size (), sorted.size (), "Wrong size");
+    }
+
+  while (!sorted.empty ())
+    {
+      SPFVertex *v = candidate.Pop ();
+      NS_TEST_ASSERT_MSG_EQ (v, sorted.front (), "Vertex popped out of order");
+      sorted.pop_front ();
+      delete v;
+    }
+  NS_TEST_EXPECT_MSG_EQ (candidate.Empty (), true, "Queue not empty");
+}
+
 
 /**
  * \ingroup internet-test
@@ -243,6 +353,7 @@ GlobalRouteManagerImplTestSuite::GlobalRouteManagerImplTestSuite ()
   : TestSuite ("global-route-manager-impl", UNIT)
 {
   AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+  AddTestCase (new CandidateQueueTestCase (), TestCase::QUICK);
 }
 
 static GlobalRouteManagerImplTestSuite g_globalRoutingManagerImplTestSuite; //!< Static variable for test initialization
@@ -14,9 +14,13 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
+#include <string>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-value.h"
+#include "ns3/global-router-interface.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -42,6 +46,7 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -1244,6 +1249,266 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting longest prefix match test
+ *
+ * Compares the routes found by the indexed lookup with a scan of the
+ * host, network and external routes, while routes are added and removed.
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// A route added to the routing protocol
+  struct Route
+  {
+    Ipv4Address network; //!< the destination network
+    Ipv4Mask mask;       //!< the destination mask
+    Ipv4Address gateway; //!< the gateway, unique to the route
+  };
+
+  /**
+   * \brief Find the route to an address by scanning the routes, in the
+   * order of the routing table.
+   * \param dest The destination address.
+   * \returns The gateway of the route, or 0.0.0.0 if there is none.
+   */
+  Ipv4Address ScanRoutes (Ipv4Address dest) const;
+
+  std::vector<Route> m_routes[3]; //!< The host, network and external routes
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase ()
+  : TestCase ("Longest prefix match of global routes")
+{
+}
+
+Ipv4Address
+Ipv4GlobalRoutingLookupTestCase::ScanRoutes (Ipv4Address dest) const
+{
+  // the first route of the first kind with a match is used, whatever
+  // the length of its prefix
+  for (uint32_t kind = 0; kind < 3; kind++)
+    {
+      for (std::vector<Route>::const_iterator i = m_routes[kind].begin (); i != m_routes[kind].end (); i++)
+        {
+          if (i->mask.IsMatch (dest, i->network))
+            {
+              return i->gateway;
+            }
+        }
+    }
+  return Ipv4Address ();
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t ifIndex = ipv4->AddInterface (device);
+  ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (ifIndex);
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetIpv4 (ipv4);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint32_t gateway = Ipv4Address ("172.16.0.0").Get ();
+  for (uint32_t round = 0; round < 4; round++)
+    {
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          // most prefixes fall in 10.0.0.0/14, so that they nest
+          Route route;
+          uint32_t kind = rng->GetInteger (0, 2);
+          uint32_t length = kind == 0 ? 32 : rng->GetInteger (8, 32);
+          route.mask = Ipv4Mask (length == 32 ? 0xffffffff : ~(0xffffffff >> length));
+          route.network = Ipv4Address (0x0a000000 | rng->GetInteger (0, 0x3ffff)).CombineMask (route.mask);
+          route.gateway = Ipv4Address (gateway++);
+          m_routes[kind].push_back (route);
+          if (kind == 0)
+            {
+              routing->AddHostRouteTo (route.network, route.gateway, ifIndex);
+            }
+          else if (kind == 1)
+            {
+              routing->AddNetworkRouteTo (route.network, route.mask, route.gateway, ifIndex);
+            }
+          else
+            {
+              routing->AddASExternalRouteTo (route.network, route.mask, route.gateway, ifIndex);
+            }
+        }
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          uint32_t index = rng->GetInteger (0, routing->GetNRoutes () - 1);
+          routing->RemoveRoute (index);
+          for (uint32_t kind = 0; kind < 3; kind++)
+            {
+              if (index < m_routes[kind].size ())
+                {
+                  m_routes[kind].erase (m_routes[kind].begin () + index);
+                  break;
+                }
+              index -= m_routes[kind].size ();
+            }
+        }
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          Ipv4Header header;
+          header.SetDestination (Ipv4Address (0x0a000000 | rng->GetInteger (0, 0x3ffff)));
+          Socket::SocketErrno err;
+          Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, err);
+          Ipv4Address found = route ? route->GetGateway () : Ipv4Address ();
+          NS_TEST_EXPECT_MSG_EQ (found, ScanRoutes (header.GetDestination ()),
+                                 "Wrong route to " << header.GetDestination ());
+        }
+    }
+
+  routing->Dispose ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting parallel SPF test
+ *
+ * Builds a random topology of point-to-point links and stub nodes, with
+ * random metrics and hence many equal cost paths, and checks that the
+ * routing tables computed on several threads are the same as those
+ * computed on a single thread.
+ */
+class Ipv4GlobalRoutingParallelTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingParallelTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The routing tables of the nodes
+  typedef std::vector<std::vector<std::string> > Tables;
+
+  /**
+   * \brief Get the routing tables of the nodes.
+   * \param nodes The nodes.
+   * \returns The routes of each node, in order.
+   */
+  Tables GetTables (NodeContainer nodes);
+};
+
+Ipv4GlobalRoutingParallelTestCase::Ipv4GlobalRoutingParallelTestCase ()
+  : TestCase ("Global routes computed on several threads")
+{
+}
+
+Ipv4GlobalRoutingParallelTestCase::Tables
+Ipv4GlobalRoutingParallelTestCase::GetTables (NodeContainer nodes)
+{
+  Tables tables;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> table;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (j);
+          table.push_back (route.str ());
+        }
+      tables.push_back (table);
+    }
+  return tables;
+}
+
+void
+Ipv4GlobalRoutingParallelTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  // 96 routers in a ring, with random chords, and 16 stub nodes
+  NodeContainer routers;
+  routers.Create (96);
+  NodeContainer stubs;
+  stubs.Create (16);
+  NodeContainer nodes (routers, stubs);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper devHelper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  std::vector<NodeContainer> links;
+  for (uint32_t i = 0; i < routers.GetN (); i++)
+    {
+      links.push_back (NodeContainer (routers.Get (i), routers.Get ((i + 1) % routers.GetN ())));
+    }
+  for (uint32_t i = 0; i < 48; i++)
+    {
+      uint32_t a = rng->GetInteger (0, routers.GetN () - 1);
+      uint32_t b = rng->GetInteger (0, routers.GetN () - 1);
+      if (a != b)
+        {
+          links.push_back (NodeContainer (routers.Get (a), routers.Get (b)));
+        }
+    }
+  for (uint32_t i = 0; i < stubs.GetN (); i++)
+    {
+      links.push_back (NodeContainer (stubs.Get (i), routers.Get (rng->GetInteger (0, routers.GetN () - 1))));
+    }
+  devHelper.SetNetDevicePointToPointMode (true);
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      ipv4.Assign (devHelper.Install (links[i]));
+      ipv4.NewNetwork ();
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = nodes.Get (i)->GetObject<Ipv4> ();
+      for (uint32_t j = 1; j < ip->GetNInterfaces (); j++)
+        {
+          ip->SetMetric (j, rng->GetInteger (1, 3));
+        }
+    }
+
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  Tables sequential = GetTables (nodes);
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (4));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+  Tables parallel = GetTables (nodes);
+  GlobalValue::Bind ("GlobalRoutingThreads", UintegerValue (0));
+
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (sequential[i].size (), 0, "No route on node " << i);
+      NS_TEST_ASSERT_MSG_EQ (parallel[i].size (), sequential[i].size (), "Wrong number of routes on node " << i);
+      for (uint32_t j = 0; j < sequential[i].size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (parallel[i][j], sequential[i][j], "Wrong route on node " << i);
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1532,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingParallelTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
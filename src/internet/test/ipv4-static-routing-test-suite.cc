@@ -16,6 +16,7 @@
 
 // End-to-end tests for Ipv4 static routing
 
+#include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -35,6 +36,9 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/double.h"
+#include "ns3/ipv4-routing-table-entry.h"
 
 using namespace ns3;
 
@@ -201,6 +205,184 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting longest prefix match Test
+ *
+ * Compares the routes found by the indexed lookup with a linear scan
+ * of the routing table, while routes are added and removed.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The routes and metrics of a routing table
+  typedef std::vector<std::pair<Ipv4RoutingTableEntry, uint32_t> > Table;
+
+  /**
+   * \brief Find the route to an address by scanning the routing table.
+   * \param table The routing table.
+   * \param dest The destination address.
+   * \returns The gateway of the route, or 0.0.0.0 if there is none.
+   */
+  Ipv4Address ScanRoutes (Table const &table, Ipv4Address dest);
+
+  /**
+   * \brief Check the route to an address.
+   * \param routing The routing protocol.
+   * \param table The routing table of the protocol.
+   * \param dest The destination address.
+   */
+  void CheckRoute (Ptr<Ipv4StaticRouting> routing, Table const &table, Ipv4Address dest);
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase ()
+  : TestCase ("Longest prefix match of static routes")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLookupTestCase::ScanRoutes (Table const &table, Ipv4Address dest)
+{
+  // the longest mask, then the lowest metric, wins; the first matching
+  // host route, or the last route with the lowest metric, is used
+  Ipv4Address gateway;
+  uint16_t longest = 0;
+  uint32_t shortest = 0xffffffff;
+  for (Table::const_iterator i = table.begin (); i != table.end (); i++)
+    {
+      Ipv4RoutingTableEntry const &route = i->first;
+      uint32_t metric = i->second;
+      uint16_t length = route.GetDestNetworkMask ().GetPrefixLength ();
+      if (!route.GetDestNetworkMask ().IsMatch (dest, route.GetDestNetwork ()) || length < longest)
+        {
+          continue;
+        }
+      if (length > longest)
+        {
+          shortest = 0xffffffff;
+        }
+      longest = length;
+      if (metric > shortest)
+        {
+          continue;
+        }
+      shortest = metric;
+      gateway = route.GetGateway ();
+      if (length == 32)
+        {
+          break;
+        }
+    }
+  return gateway;
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::CheckRoute (Ptr<Ipv4StaticRouting> routing, Table const &table, Ipv4Address dest)
+{
+  Ipv4Header header;
+  header.SetDestination (dest);
+  Socket::SocketErrno err;
+  Ptr<Ipv4Route> route = routing->RouteOutput (0, header, 0, err);
+  Ipv4Address gateway = route ? route->GetGateway () : Ipv4Address ();
+  NS_TEST_EXPECT_MSG_EQ (gateway, ScanRoutes (table, dest), "Wrong route to " << dest);
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (device);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t ifIndex = ipv4->AddInterface (device);
+  ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address ("192.168.0.1"), Ipv4Mask ("/24")));
+  ipv4->SetUp (ifIndex);
+
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting (ipv4);
+
+  // A few routes to nested prefixes, with equal and different metrics
+  routing->AddNetworkRouteTo (Ipv4Address ("10.0.0.0"), Ipv4Mask ("/8"), Ipv4Address ("192.168.0.2"), ifIndex, 0);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.1.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.3"), ifIndex, 5);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.4"), ifIndex, 2);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.2.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.5"), ifIndex, 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.3.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.6"), ifIndex, 1);
+  routing->AddNetworkRouteTo (Ipv4Address ("10.3.0.0"), Ipv4Mask ("/16"), Ipv4Address ("192.168.0.7"), ifIndex, 1);
+  routing->AddHostRouteTo (Ipv4Address ("10.4.0.1"), Ipv4Address ("192.168.0.8"), ifIndex, 5);
+  routing->AddHostRouteTo (Ipv4Address ("10.4.0.1"), Ipv4Address ("192.168.0.9"), ifIndex, 1);
+  routing->SetDefaultRoute (Ipv4Address ("192.168.0.10"), ifIndex);
+
+  Ipv4Header header;
+  Socket::SocketErrno err;
+  header.SetDestination (Ipv4Address ("10.1.2.3"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.3"), "Longest prefix not used");
+  header.SetDestination (Ipv4Address ("10.2.2.3"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.5"), "Lowest metric not used");
+  header.SetDestination (Ipv4Address ("10.3.2.3"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.7"), "Last equal route not used");
+  header.SetDestination (Ipv4Address ("10.4.0.1"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.8"), "First host route not used");
+  header.SetDestination (Ipv4Address ("10.4.0.2"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.2"), "Shorter prefix not used");
+  header.SetDestination (Ipv4Address ("11.0.0.1"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.10"), "Default route not used");
+
+  // Removing the /16 falls back to the /8
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      if (routing->GetRoute (i).GetGateway () == Ipv4Address ("192.168.0.3"))
+        {
+          routing->RemoveRoute (i);
+          break;
+        }
+    }
+  header.SetDestination (Ipv4Address ("10.1.2.3"));
+  NS_TEST_EXPECT_MSG_EQ (routing->RouteOutput (0, header, 0, err)->GetGateway (), Ipv4Address ("192.168.0.2"), "Removed route used");
+
+  // Random routes, compared with a scan of the table, while routes are
+  // added and removed
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint32_t gateway = Ipv4Address ("172.16.0.0").Get ();
+  for (uint32_t round = 0; round < 4; round++)
+    {
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          // most prefixes fall in 10.0.0.0/14, so that they nest
+          Ipv4Address network (0x0a000000 | rng->GetInteger (0, 0x3ffff));
+          uint32_t length = rng->GetInteger (8, 32);
+          uint32_t mask = length == 32 ? 0xffffffff : ~(0xffffffff >> length);
+          routing->AddNetworkRouteTo (network.CombineMask (Ipv4Mask (mask)), Ipv4Mask (mask),
+                                      Ipv4Address (gateway++), ifIndex, rng->GetInteger (0, 3));
+        }
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          routing->RemoveRoute (rng->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+      Table table;
+      for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+        {
+          table.push_back (std::make_pair (routing->GetRoute (i), routing->GetMetric (i)));
+        }
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          CheckRoute (routing, table, Ipv4Address (0x0a000000 | rng->GetInteger (0, 0x3ffff)));
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +399,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,230 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <vector>
+#include "ns3/test.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-routing-table-entry.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/random-variable-stream.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 StaticRouting longest prefix match Test
+ *
+ * Compares the routes found by the indexed lookup with a linear scan
+ * of the routing table, while routes are added and removed, and checks
+ * that the link-local routes of each interface are kept apart.
+ */
+class Ipv6StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv6StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// The routes and metrics of a routing table
+  typedef std::vector<std::pair<Ipv6RoutingTableEntry, uint32_t> > Table;
+
+  /**
+   * \brief Find the route to an address by scanning the routing table.
+   * \param table The routing table.
+   * \param dest The destination address.
+   * \returns The gateway of the route, or :: if there is none.
+   */
+  Ipv6Address ScanRoutes (Table const &table, Ipv6Address dest);
+
+  /**
+   * \brief Find the route to an address.
+   * \param routing The routing protocol.
+   * \param dest The destination address.
+   * \param oif The output device, or 0.
+   * \returns The route, or 0 if there is none.
+   */
+  Ptr<Ipv6Route> Lookup (Ptr<Ipv6StaticRouting> routing, Ipv6Address dest, Ptr<NetDevice> oif);
+};
+
+Ipv6StaticRoutingLookupTestCase::Ipv6StaticRoutingLookupTestCase ()
+  : TestCase ("Longest prefix match of IPv6 static routes")
+{
+}
+
+Ipv6Address
+Ipv6StaticRoutingLookupTestCase::ScanRoutes (Table const &table, Ipv6Address dest)
+{
+  // the longest prefix, then the lowest metric, wins; the first matching
+  // host route, or the last route with the lowest metric, is used
+  Ipv6Address gateway;
+  uint16_t longest = 0;
+  uint32_t shortest = 0xffffffff;
+  for (Table::const_iterator i = table.begin (); i != table.end (); i++)
+    {
+      Ipv6RoutingTableEntry const &route = i->first;
+      uint32_t metric = i->second;
+      uint16_t length = route.GetDestNetworkPrefix ().GetPrefixLength ();
+      if (!route.GetDestNetworkPrefix ().IsMatch (dest, route.GetDestNetwork ()) || length < longest)
+        {
+          continue;
+        }
+      if (length > longest)
+        {
+          shortest = 0xffffffff;
+        }
+      longest = length;
+      if (metric > shortest)
+        {
+          continue;
+        }
+      shortest = metric;
+      gateway = route.GetGateway ();
+      if (length == 128)
+        {
+          break;
+        }
+    }
+  return gateway;
+}
+
+Ptr<Ipv6Route>
+Ipv6StaticRoutingLookupTestCase::Lookup (Ptr<Ipv6StaticRouting> routing, Ipv6Address dest, Ptr<NetDevice> oif)
+{
+  Ipv6Header header;
+  header.SetDestinationAddress (dest);
+  Socket::SocketErrno err;
+  return routing->RouteOutput (0, header, oif, err);
+}
+
+void
+Ipv6StaticRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  Ptr<SimpleNetDevice> devices[2];
+  int32_t ifIndex[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      devices[i] = CreateObject<SimpleNetDevice> ();
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (devices[i]);
+      ifIndex[i] = ipv6->AddInterface (devices[i]);
+      ipv6->SetUp (ifIndex[i]);
+    }
+  ipv6->AddAddress (ifIndex[0], Ipv6InterfaceAddress (Ipv6Address ("2001:db8:0:1::1"), Ipv6Prefix (64)));
+  ipv6->AddAddress (ifIndex[1], Ipv6InterfaceAddress (Ipv6Address ("2001:db8:0:2::1"), Ipv6Prefix (64)));
+
+  Ipv6StaticRoutingHelper ipv6RoutingHelper;
+  Ptr<Ipv6StaticRouting> routing = ipv6RoutingHelper.GetStaticRouting (ipv6);
+
+  // Both interfaces have a route to fe80::/64: the output interface
+  // selects one, the last one added is used otherwise.
+  Ipv6Address linkLocal ("fe80::1234");
+  Ptr<Ipv6Route> route = Lookup (routing, linkLocal, devices[0]);
+  NS_TEST_ASSERT_MSG_EQ ((route != 0), true, "No link-local route on the first interface");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices[0], "Wrong link-local route");
+  route = Lookup (routing, linkLocal, devices[1]);
+  NS_TEST_ASSERT_MSG_EQ ((route != 0), true, "No link-local route on the second interface");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices[1], "Wrong link-local route");
+  route = Lookup (routing, linkLocal, 0);
+  NS_TEST_ASSERT_MSG_EQ ((route != 0), true, "No link-local route");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices[1], "Wrong link-local route");
+
+  // Removing the routes of an interface leaves those of the other one
+  ipv6->SetDown (ifIndex[1]);
+  route = Lookup (routing, linkLocal, 0);
+  NS_TEST_ASSERT_MSG_EQ ((route != 0), true, "No link-local route");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), devices[0], "Removed link-local route used");
+  route = Lookup (routing, Ipv6Address ("2001:db8:0:2::2"), 0);
+  NS_TEST_EXPECT_MSG_EQ ((route == 0), true, "Removed route used");
+  ipv6->SetUp (ifIndex[1]);
+
+  // Random /48, /64 and /128 routes, compared with a scan of the table,
+  // while routes are added and removed
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint8_t lengths[] = { 48, 56, 64, 64, 64, 96, 128, 128 };
+  uint32_t gateway = 0;
+  for (uint32_t round = 0; round < 4; round++)
+    {
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          // the prefixes nest within 2001:db8:0:0::/60
+          uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+          bytes[7] = rng->GetInteger (0, 15);
+          bytes[15] = rng->GetInteger (0, 7);
+          uint8_t gatewayBytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0xff, 0xff, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+          gatewayBytes[14] = gateway >> 8;
+          gatewayBytes[15] = gateway & 0xff;
+          gateway++;
+          Ipv6Prefix prefix (lengths[rng->GetInteger (0, 7)]);
+          routing->AddNetworkRouteTo (Ipv6Address (bytes).CombinePrefix (prefix), prefix,
+                                      Ipv6Address (gatewayBytes), ifIndex[rng->GetInteger (0, 1)],
+                                      rng->GetInteger (0, 3));
+        }
+      for (uint32_t i = 0; i < 200; i++)
+        {
+          routing->RemoveRoute (rng->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+      Table table;
+      for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+        {
+          table.push_back (std::make_pair (routing->GetRoute (i), routing->GetMetric (i)));
+        }
+      for (uint32_t i = 0; i < 500; i++)
+        {
+          uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+          bytes[7] = rng->GetInteger (0, 15);
+          bytes[15] = rng->GetInteger (0, 7);
+          Ipv6Address dest (bytes);
+          route = Lookup (routing, dest, 0);
+          Ipv6Address found = route ? route->GetGateway () : Ipv6Address ();
+          NS_TEST_EXPECT_MSG_EQ (found, ScanRoutes (table, dest), "Wrong route to " << dest);
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv6 StaticRouting TestSuite
+ */
+class Ipv6StaticRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv6StaticRoutingTestSuite ();
+};
+
+Ipv6StaticRoutingTestSuite::Ipv6StaticRoutingTestSuite ()
+  : TestSuite ("ipv6-static-routing", UNIT)
+{
+  AddTestCase (new Ipv6StaticRoutingLookupTestCase, TestCase::QUICK);
+}
+
+static Ipv6StaticRoutingTestSuite ipv6StaticRoutingTestSuite; //!< Static variable for test initialization
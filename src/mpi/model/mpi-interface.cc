@@ -27,6 +27,7 @@
 
 #include "null-message-mpi-interface.h"
 #include "granted-time-window-mpi-interface.h"
+#include "threaded-communication-interface.h"
 
 namespace ns3 {
 
@@ -94,6 +95,11 @@ MpiInterface::Enable (int* pargc, char*** pargv)
           g_parallelCommunicationInterface = new GrantedTimeWindowMpiInterface ();
           useDefault = false;
         }
+      else if (simulationType.compare ("ns3::ThreadedSimulatorImpl") == 0)
+        {
+          g_parallelCommunicationInterface = new ThreadedCommunicationInterface ();
+          useDefault = false;
+        }
     }
 
   // User did not specify a valid parallel simulator; use the default.
@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "threaded-communication-interface.h"
+#include "mpi-receiver.h"
+
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ThreadedCommunicationInterface");
+
+ThreadedCommunicationInterface::ThreadedCommunicationInterface ()
+  : m_enabled (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ThreadedCommunicationInterface::~ThreadedCommunicationInterface ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ThreadedCommunicationInterface::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+ThreadedCommunicationInterface::GetSystemId ()
+{
+  return Simulator::GetSystemId ();
+}
+
+uint32_t
+ThreadedCommunicationInterface::GetSize ()
+{
+  uint32_t size = 1;
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); ++i)
+    {
+      size = std::max (size, NodeList::GetNode (i)->GetSystemId () + 1);
+    }
+  return size;
+}
+
+bool
+ThreadedCommunicationInterface::IsEnabled ()
+{
+  return m_enabled;
+}
+
+void
+ThreadedCommunicationInterface::Enable (int* pargc, char*** pargv)
+{
+  NS_LOG_FUNCTION (this << pargc << pargv);
+  m_enabled = true;
+}
+
+void
+ThreadedCommunicationInterface::Disable ()
+{
+  NS_LOG_FUNCTION (this);
+  m_enabled = false;
+}
+
+void
+ThreadedCommunicationInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (this << p << rxTime << node << dev);
+
+  std::vector<uint8_t> buffer (p->GetSerializedSize ());
+  uint32_t ok = p->Serialize (&buffer[0], buffer.size ());
+  NS_ASSERT (ok);
+  NS_UNUSED (ok);
+
+  // The event only holds plain values, so it can safely be handed
+  // over to the thread of the destination partition.
+  Simulator::ScheduleWithContext (node, rxTime - Simulator::Now (),
+                                  &ThreadedCommunicationInterface::ReceivePacket,
+                                  buffer, node, dev);
+}
+
+void
+ThreadedCommunicationInterface::ReceivePacket (const std::vector<uint8_t> &buffer, uint32_t node, uint32_t dev)
+{
+  NS_LOG_FUNCTION (buffer.size () << node << dev);
+
+  Ptr<Packet> p = Create<Packet> (&buffer[0], buffer.size (), true);
+
+  // Find the correct node/device to deliver the packet to
+  Ptr<Node> pNode = NodeList::GetNode (node);
+  Ptr<MpiReceiver> pMpiRec = 0;
+  uint32_t nDevices = pNode->GetNDevices ();
+  for (uint32_t i = 0; i < nDevices; ++i)
+    {
+      Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+      if (pThisDev->GetIfIndex () == dev)
+        {
+          pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+          break;
+        }
+    }
+
+  NS_ASSERT (pNode && pMpiRec);
+  pMpiRec->Receive (p);
+}
+
+} // namespace ns3
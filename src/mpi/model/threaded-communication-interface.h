@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NS3_THREADED_COMMUNICATION_INTERFACE_H
+#define NS3_THREADED_COMMUNICATION_INTERFACE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/packet.h"
+
+#include "parallel-communication-interface.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Interface between ns-3 and the partitions of a
+ * ThreadedSimulatorImpl.
+ *
+ * The partitions all live in the same process, so no MPI library is
+ * involved: a packet sent to a node of another partition is
+ * serialized, and the event which receives it is handed over to the
+ * partition of the destination node, where the packet is rebuilt.
+ * The sender and the receiver thus never share a Packet.
+ */
+class ThreadedCommunicationInterface : public ParallelCommunicationInterface
+{
+public:
+  ThreadedCommunicationInterface ();
+  virtual ~ThreadedCommunicationInterface ();
+
+  // virtual from ParallelCommunicationInterface
+  virtual void Destroy ();
+  /**
+   * \return system id of the partition of the calling thread
+   */
+  virtual uint32_t GetSystemId ();
+  /**
+   * \return number of partitions, that is the largest system id of
+   * the nodes plus one.  Must be called from the main program.
+   */
+  virtual uint32_t GetSize ();
+  virtual bool IsEnabled ();
+  virtual void Enable (int* pargc, char*** pargv);
+  virtual void Disable ();
+  virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+
+private:
+  /**
+   * \param buffer serialized packet
+   * \param node destination node
+   * \param dev destination device
+   *
+   * Rebuild a packet in the partition of the destination node and
+   * pass it to the MpiReceiver of the destination device.
+   */
+  static void ReceivePacket (const std::vector<uint8_t> &buffer, uint32_t node, uint32_t dev);
+
+  bool m_enabled; //!< true if enabled
+};
+
+} // namespace ns3
+
+#endif /* NS3_THREADED_COMMUNICATION_INTERFACE_H */
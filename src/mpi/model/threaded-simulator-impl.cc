@@ -0,0 +1,770 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "threaded-simulator-impl.h"
+#include "mpi-interface.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ThreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (ThreadedSimulatorImpl);
+
+thread_local ThreadedSimulatorImpl::Partition *ThreadedSimulatorImpl::g_partition = 0;
+
+namespace {
+
+/// Timestamp of an empty partition, and infinite lookahead.
+const uint64_t INFINITE_TS = std::numeric_limits<uint64_t>::max ();
+
+/// System id of the partition of the global events.
+const uint32_t GLOBAL_SYSTEM_ID = std::numeric_limits<uint32_t>::max ();
+
+} // unnamed namespace
+
+TypeId
+ThreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ThreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<ThreadedSimulatorImpl> ()
+  ;
+  return tid;
+}
+
+ThreadedSimulatorImpl::ThreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+
+  m_stop = false;
+  m_global = 0;
+  m_lookAhead = INFINITE_TS;
+  m_maxLookAhead = INFINITE_TS;
+  m_inRound = false;
+  m_roundEnd = 0;
+  m_round = 0;
+  m_running = 0;
+  m_exit = false;
+}
+
+ThreadedSimulatorImpl::~ThreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ThreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<Partition *> partitions = m_partitions;
+  if (m_global != 0)
+    {
+      partitions.push_back (m_global);
+    }
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      for (std::vector<Message>::iterator j = partition->outbox.begin ();
+           j != partition->outbox.end (); ++j)
+        {
+          j->event->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  m_systemIds.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+ThreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+
+  while (true)
+    {
+      Ptr<EventImpl> ev;
+      {
+        std::lock_guard<std::mutex> lock (m_destroyMutex);
+        if (m_destroyEvents.empty ())
+          {
+            break;
+          }
+        ev = m_destroyEvents.front ().PeekEventImpl ();
+        m_destroyEvents.pop_front ();
+      }
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+
+  StopWorkers ();
+
+  if (MpiInterface::IsEnabled ())
+    {
+      MpiInterface::Destroy ();
+    }
+}
+
+void
+ThreadedSimulatorImpl::StopWorkers (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_exit = true;
+  }
+  m_roundStart.notify_all ();
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+}
+
+ThreadedSimulatorImpl::Partition *
+ThreadedSimulatorImpl::CreatePartition (uint32_t systemId) const
+{
+  NS_LOG_FUNCTION (this << systemId);
+
+  Partition *partition = new Partition ();
+  partition->systemId = systemId;
+  partition->events = m_schedulerFactory.Create<Scheduler> ();
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  // before ::Run is entered, the currentUid will be zero
+  partition->currentUid = 0;
+  partition->currentTs = 0;
+  partition->currentContext = Simulator::NO_CONTEXT;
+  partition->unscheduledEvents = 0;
+  return partition;
+}
+
+ThreadedSimulatorImpl::Partition *
+ThreadedSimulatorImpl::FindPartition (uint32_t context) const
+{
+  if (context < m_systemIds.size ())
+    {
+      return m_partitions[m_systemIds[context]];
+    }
+  // Simulator::NO_CONTEXT, or a context which does not match a node
+  return m_global;
+}
+
+ThreadedSimulatorImpl::Partition *
+ThreadedSimulatorImpl::GetPartition (uint32_t context)
+{
+  if (context >= m_systemIds.size () && context != Simulator::NO_CONTEXT && !m_inRound)
+    {
+      UpdateSystemIds ();
+    }
+  return FindPartition (context);
+}
+
+ThreadedSimulatorImpl::Partition *
+ThreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  if (g_partition != 0)
+    {
+      return g_partition;
+    }
+  return m_global;
+}
+
+void
+ThreadedSimulatorImpl::UpdateSystemIds (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_inRound);
+
+  for (uint32_t i = m_systemIds.size (); i < NodeList::GetNNodes (); ++i)
+    {
+      uint32_t systemId = NodeList::GetNode (i)->GetSystemId ();
+      while (m_partitions.size () <= systemId)
+        {
+          m_partitions.push_back (CreatePartition (m_partitions.size ()));
+        }
+      m_systemIds.push_back (systemId);
+    }
+}
+
+void
+ThreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_lookAhead = m_maxLookAhead;
+  for (uint32_t i = 0; i < NodeList::GetNNodes (); ++i)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<Channel> channel = node->GetDevice (j)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          // only consider the channels with a device in another partition
+          bool remote = false;
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              Ptr<NetDevice> device = channel->GetDevice (k);
+              if (device != 0 && device->GetNode ()->GetSystemId () != node->GetSystemId ())
+                {
+                  remote = true;
+                  break;
+                }
+            }
+          if (!remote)
+            {
+              continue;
+            }
+
+          TimeValue delay;
+          if (!channel->GetAttributeFailSafe ("Delay", delay))
+            {
+              NS_FATAL_ERROR ("Channel " << channel->GetInstanceTypeId ().GetName () <<
+                              " of node " << node->GetId () << " spans two partitions" <<
+                              " but has no \"Delay\" attribute");
+            }
+          NS_ASSERT (delay.Get ().IsPositive ());
+          m_lookAhead = std::min<uint64_t> (m_lookAhead, delay.Get ().GetTimeStep ());
+        }
+    }
+
+  if (m_lookAhead == 0 && m_partitions.size () > 1)
+    {
+      NS_FATAL_ERROR ("Can't run partitions in parallel with a zero lookahead");
+    }
+  NS_LOG_LOGIC ("lookahead=" << m_lookAhead);
+}
+
+void
+ThreadedSimulatorImpl::SetMaximumLookAhead (const Time lookAhead)
+{
+  if (lookAhead > 0)
+    {
+      NS_LOG_FUNCTION (this << lookAhead);
+      m_maxLookAhead = lookAhead.GetTimeStep ();
+    }
+  else
+    {
+      NS_LOG_WARN ("attempted to set look ahead negative: " << lookAhead);
+    }
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetPartitionCount (void) const
+{
+  return m_partitions.size ();
+}
+
+void
+ThreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+
+  m_schedulerFactory = schedulerFactory;
+  if (m_global == 0)
+    {
+      m_global = CreatePartition (GLOBAL_SYSTEM_ID);
+      return;
+    }
+
+  std::vector<Partition *> partitions = m_partitions;
+  partitions.push_back (m_global);
+  for (std::vector<Partition *>::iterator i = partitions.begin (); i != partitions.end (); ++i)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      while (!(*i)->events->IsEmpty ())
+        {
+          Scheduler::Event next = (*i)->events->RemoveNext ();
+          scheduler->Insert (next);
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+uint64_t
+ThreadedSimulatorImpl::NextTs (const Partition *partition)
+{
+  if (partition->events->IsEmpty ())
+    {
+      return INFINITE_TS;
+    }
+  return partition->events->PeekNext ().key.m_ts;
+}
+
+void
+ThreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  NS_LOG_FUNCTION (this << partition->systemId);
+
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+ThreadedSimulatorImpl::ProcessRound (Partition *partition, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << partition->systemId << end);
+
+  while (NextTs (partition) < end)
+    {
+      ProcessOneEvent (partition);
+    }
+}
+
+void
+ThreadedSimulatorImpl::DeliverMessages (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  // Visit the outboxes in a fixed order so that the uids, and thus the
+  // order of the events which share a timestamp, are reproducible.
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      std::vector<Message> &outbox = (*i)->outbox;
+      for (std::vector<Message>::iterator j = outbox.begin (); j != outbox.end (); ++j)
+        {
+          Insert (j->target, j->ts, j->context, j->event);
+        }
+      outbox.clear ();
+    }
+}
+
+void
+ThreadedSimulatorImpl::RunWorker (uint32_t systemId, uint64_t round)
+{
+  NS_LOG_FUNCTION (this << systemId << round);
+
+  g_partition = m_partitions[systemId];
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (!m_exit && m_round == round)
+        {
+          m_roundStart.wait (lock);
+        }
+      if (m_exit)
+        {
+          break;
+        }
+      round = m_round;
+      uint64_t end = m_roundEnd;
+      lock.unlock ();
+
+      ProcessRound (g_partition, end);
+
+      lock.lock ();
+      m_running--;
+      if (m_running == 0)
+        {
+          m_roundDone.notify_one ();
+        }
+    }
+  g_partition = 0;
+}
+
+void
+ThreadedSimulatorImpl::RunRound (uint64_t end)
+{
+  NS_LOG_FUNCTION (this << end);
+
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    m_inRound = true;
+    m_roundEnd = end;
+    m_running = m_threads.size ();
+    m_round++;
+  }
+  m_roundStart.notify_all ();
+
+  // The main thread runs the first partition itself.
+  g_partition = m_partitions[0];
+  ProcessRound (g_partition, end);
+  g_partition = 0;
+
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (m_running != 0)
+    {
+      m_roundDone.wait (lock);
+    }
+  m_inRound = false;
+}
+
+bool
+ThreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events->IsEmpty ();
+}
+
+void
+ThreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  UpdateSystemIds ();
+  if (m_partitions.empty ())
+    {
+      m_partitions.push_back (CreatePartition (0));
+    }
+  CalculateLookAhead ();
+  m_stop = false;
+
+  // The worker threads are kept across calls to Run, so that their
+  // packet uids stay unique.
+  for (uint32_t i = m_threads.size () + 1; i < m_partitions.size (); ++i)
+    {
+      Ptr<SystemThread> thread =
+        Create<SystemThread> (MakeCallback (&ThreadedSimulatorImpl::RunWorker, this).TwoBind (i, m_round));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+
+  while (true)
+    {
+      DeliverMessages ();
+      if (m_stop)
+        {
+          break;
+        }
+
+      uint64_t next = INFINITE_TS;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, NextTs (*i));
+        }
+      uint64_t globalNext = NextTs (m_global);
+      if (next == INFINITE_TS && globalNext == INFINITE_TS)
+        {
+          break;
+        }
+
+      // The global events run alone, before the events of the
+      // partitions which share their timestamp.
+      if (globalNext <= next)
+        {
+          ProcessOneEvent (m_global);
+          continue;
+        }
+
+      uint64_t end = globalNext;
+      if (m_lookAhead < end - next)
+        {
+          end = next + m_lookAhead;
+        }
+      RunRound (end);
+    }
+
+  // Report the time reached by the furthest partition from now on.
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      if ((*i)->currentTs > m_global->currentTs)
+        {
+          m_global->currentTs = (*i)->currentTs;
+          m_global->currentUid = 0;
+        }
+    }
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  // Events which moved between partitions are counted by both.
+  int unscheduledEvents = m_global->unscheduledEvents;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      unscheduledEvents += (*i)->unscheduledEvents;
+    }
+  NS_ASSERT (m_stop || unscheduledEvents == 0);
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetSystemId (void) const
+{
+  Partition *partition = GetCurrentPartition ();
+  if (partition == m_global)
+    {
+      return 0;
+    }
+  return partition->systemId;
+}
+
+void
+ThreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_stop = true;
+}
+
+void
+ThreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+Scheduler::EventKey
+ThreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev.key;
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+ThreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+
+  Partition *partition = GetCurrentPartition ();
+  Time tAbsolute = delay + TimeStep (partition->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (partition->currentTs));
+  Scheduler::EventKey key = Insert (partition, static_cast<uint64_t> (tAbsolute.GetTimeStep ()),
+                                    partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+void
+ThreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *current = GetCurrentPartition ();
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << current->currentTs << event);
+
+  uint64_t ts = current->currentTs + delay.GetTimeStep ();
+  Partition *target = GetPartition (context);
+  if (target == current || !m_inRound)
+    {
+      Insert (target, ts, context, event);
+      return;
+    }
+
+  // The target partition may be running the same round: hand the
+  // event over at the end of the round.
+  if (ts < m_roundEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " scheduled " << delay <<
+                      " ahead, less than the lookahead of " << TimeStep (m_lookAhead));
+    }
+  Message message;
+  message.target = target;
+  message.ts = ts;
+  message.context = context;
+  message.event = event;
+  current->outbox.push_back (message);
+}
+
+EventId
+ThreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  Partition *partition = GetCurrentPartition ();
+  Scheduler::EventKey key = Insert (partition, partition->currentTs,
+                                    partition->currentContext, event);
+  return EventId (event, key.m_ts, key.m_context, key.m_uid);
+}
+
+EventId
+ThreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  EventId id (Ptr<EventImpl> (event, false), GetCurrentPartition ()->currentTs, 0xffffffff, 2);
+  std::lock_guard<std::mutex> lock (m_destroyMutex);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+ThreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrentPartition ()->currentTs);
+}
+
+Time
+ThreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - FindPartition (id.GetContext ())->currentTs);
+    }
+}
+
+void
+ThreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      std::lock_guard<std::mutex> lock (m_destroyMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = FindPartition (id.GetContext ());
+  NS_ASSERT_MSG (!m_inRound || partition == GetCurrentPartition (),
+                 "Can't remove an event of another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+ThreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+ThreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      std::lock_guard<std::mutex> lock (m_destroyMutex);
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *partition = FindPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < partition->currentTs
+      || (id.GetTs () == partition->currentTs
+          && id.GetUid () <= partition->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+ThreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  /// \todo I am fairly certain other compilers use other non-standard
+  /// post-fixes to indicate 64 bit constants.
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+ThreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrentPartition ()->currentContext;
+}
+
+} // namespace ns3
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NS3_THREADED_SIMULATOR_IMPL_H
+#define NS3_THREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Parallel simulator implementation running on several threads
+ * of a single process.
+ *
+ * The nodes are partitioned by their system id, exactly as for the
+ * DistributedSimulatorImpl, but each partition is run by a thread of
+ * the current process rather than by an MPI task.  Each partition
+ * owns its own Scheduler, and the events are assigned to a partition
+ * based on the node which matches their context.  Events without a
+ * context (Simulator::NO_CONTEXT), such as those scheduled from the
+ * main program before Simulator::Run, are global events: they are
+ * run by the main thread while all the partitions are paused.
+ *
+ * The partitions are synchronized with a conservative time window
+ * algorithm.  The lookahead is the smallest delay of the channels
+ * which connect nodes of different partitions.  In each round, all
+ * the partitions run, in parallel, their events which are earlier
+ * than the smallest next event time plus the lookahead (and earlier
+ * than the next global event).  The events scheduled for another
+ * partition during a round are delivered at the end of the round, in
+ * an order which does not depend on the thread scheduling, so that
+ * the results are reproducible.
+ *
+ * To have point-to-point links which span two partitions exchange
+ * serialized packets rather than shared Packet objects, enable the
+ * ThreadedCommunicationInterface with MpiInterface::Enable after
+ * selecting this simulator implementation.  Other events scheduled
+ * for another partition must not share any object with their sender.
+ *
+ * Simulator::Stop invoked from a partition takes effect at the end
+ * of the current round.
+ */
+class ThreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ThreadedSimulatorImpl ();
+  ~ThreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \param lookAhead upper bound of the lookahead
+   *
+   * Bound the lookahead computed from the channel delays, for
+   * example to allow events to be scheduled for another partition
+   * without a channel between them.
+   */
+  void SetMaximumLookAhead (const Time lookAhead);
+
+  /**
+   * \return number of partitions, that is the largest system id of
+   * the nodes plus one.
+   */
+  uint32_t GetPartitionCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  struct Partition;
+
+  /**
+   * \brief An event scheduled for another partition during a round.
+   */
+  struct Message
+  {
+    Partition *target;  //!< destination partition
+    uint64_t ts;        //!< absolute event timestamp
+    uint32_t context;   //!< event context
+    EventImpl *event;   //!< event implementation
+  };
+
+  /**
+   * \brief The events and current state of a partition.
+   */
+  struct Partition
+  {
+    uint32_t systemId;               //!< system id of the nodes of this partition
+    Ptr<Scheduler> events;           //!< pending events
+    uint32_t uid;                    //!< next event uid
+    uint32_t currentUid;             //!< uid of the current event
+    uint64_t currentTs;              //!< timestamp of the current event
+    uint32_t currentContext;         //!< context of the current event
+    /*
+     * number of events that have been inserted but not yet scheduled,
+     * not counting the "destroy" events; this is used for validation
+     */
+    int unscheduledEvents;
+    /*
+     * Events scheduled for other partitions during the current round.
+     * Only the thread running this partition appends to it.
+     */
+    std::vector<Message> outbox;
+  };
+
+  /**
+   * \param systemId system id of the partition, or the largest
+   * uint32_t for the partition of the global events
+   * \return a new partition, empty.
+   */
+  Partition * CreatePartition (uint32_t systemId) const;
+
+  /**
+   * \param context event context
+   * \return partition which runs the events of context, based on
+   * the system ids already recorded.
+   */
+  Partition * FindPartition (uint32_t context) const;
+
+  /**
+   * \param context event context
+   * \return partition which runs the events of context.
+   *
+   * Outside of a round, the system id of the nodes created since
+   * the last call are recorded first.
+   */
+  Partition * GetPartition (uint32_t context);
+
+  /**
+   * \return partition of the calling thread.
+   */
+  Partition * GetCurrentPartition (void) const;
+
+  /**
+   * Record the system id of the nodes created since the last call,
+   * and create their partitions.
+   */
+  void UpdateSystemIds (void);
+
+  /**
+   * Compute the lookahead from the delay of the channels which
+   * connect nodes of different partitions.
+   */
+  void CalculateLookAhead (void);
+
+  /**
+   * \param partition partition
+   * \return timestamp of the next event of the partition, or the
+   * largest uint64_t if it has none.
+   */
+  static uint64_t NextTs (const Partition *partition);
+
+  /**
+   * \param partition destination partition
+   * \param ts absolute event timestamp
+   * \param context event context
+   * \param event event implementation
+   * \return the key of the new event.
+   *
+   * Insert an event in the Scheduler of a partition.
+   */
+  Scheduler::EventKey Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+
+  /**
+   * Move the events queued in the outboxes to their destination
+   * partition.  Called while all the partitions are paused.
+   */
+  void DeliverMessages (void);
+
+  /**
+   * \param partition partition to run
+   * \param end end of the round, exclusive
+   *
+   * Run the events of a partition up to the end of the round.
+   */
+  void ProcessRound (Partition *partition, uint64_t end);
+
+  /**
+   * \param partition partition to run
+   *
+   * Process the next event of a partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+
+  /**
+   * \param end end of the round, exclusive
+   *
+   * Let all the partitions run one round in parallel, and wait
+   * until they are done.
+   */
+  void RunRound (uint64_t end);
+
+  /**
+   * \param systemId system id of the partition run by this thread
+   * \param round last round started before this thread
+   *
+   * Main loop of a worker thread.
+   */
+  void RunWorker (uint32_t systemId, uint64_t round);
+
+  /**
+   * Tell the worker threads to exit, and wait for them.
+   */
+  void StopWorkers (void);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;
+  mutable std::mutex m_destroyMutex;          //!< protects m_destroyEvents
+  std::atomic<bool> m_stop;
+  ObjectFactory m_schedulerFactory;
+
+  /// partition of the global events
+  Partition *m_global;
+  /// partitions of the nodes, indexed by system id
+  std::vector<Partition *> m_partitions;
+  /// system id of each node, indexed by node id
+  std::vector<uint32_t> m_systemIds;
+
+  uint64_t m_lookAhead;         //!< lookahead, in time steps
+  uint64_t m_maxLookAhead;      //!< upper bound of the lookahead, in time steps
+
+  bool m_inRound;               //!< true while the partitions are running a round
+  uint64_t m_roundEnd;          //!< end of the current round
+
+  std::vector<Ptr<SystemThread> > m_threads;  //!< worker threads
+  std::mutex m_mutex;                         //!< protects the fields below
+  std::condition_variable m_roundStart;       //!< signals the start of a round
+  std::condition_variable m_roundDone;        //!< signals the end of a round
+  uint64_t m_round;                           //!< round counter
+  uint32_t m_running;                         //!< number of workers still running the round
+  bool m_exit;                                //!< tells the workers to exit
+
+  /// partition run by the calling thread, or zero for the global partition
+  static thread_local Partition *g_partition;
+};
+
+} // namespace ns3
+
+#endif /* NS3_THREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/threaded-simulator-impl.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \defgroup mpi-test mpi module tests
+ */
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief Check that events bouncing between the nodes of four
+ * partitions run at the same times as with the DefaultSimulatorImpl.
+ */
+class ThreadedSimulatorImplTestCase : public TestCase
+{
+public:
+  ThreadedSimulatorImplTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /// An event, as seen by the node which ran it.
+  struct Record
+  {
+    uint64_t ts;          //!< timestamp
+    uint32_t value;       //!< value carried by the event
+    /**
+     * \param o other record
+     * \return true if this record is ordered before o
+     */
+    bool operator < (const Record &o) const
+    {
+      return ts < o.ts || (ts == o.ts && value < o.value);
+    }
+    /**
+     * \param o other record
+     * \return true if both records are equal
+     */
+    bool operator == (const Record &o) const
+    {
+      return ts == o.ts && value == o.value;
+    }
+  };
+  typedef std::vector<std::vector<Record> > Records;
+
+  /**
+   * \param impl simulator implementation
+   * \return the events run by each node.
+   */
+  Records RunWith (Ptr<SimulatorImpl> impl);
+
+  /**
+   * \param node node which runs the event
+   * \param hops number of nodes left to visit
+   */
+  void Ping (uint32_t node, uint32_t hops);
+
+  /**
+   * \param node node which runs the event
+   * \param value value to record
+   */
+  void Local (uint32_t node, uint32_t value);
+
+  /// Record an event run by a node.
+  void Add (uint32_t node, uint32_t value);
+
+  static const uint32_t N_NODES = 4;    //!< number of nodes
+  Records m_records;                    //!< events run by each node
+  bool m_threaded;                      //!< true when running the ThreadedSimulatorImpl
+  Time m_stop;                          //!< stop time
+};
+
+ThreadedSimulatorImplTestCase::ThreadedSimulatorImplTestCase ()
+  : TestCase ("Check events scheduled across partitions")
+{
+}
+
+void
+ThreadedSimulatorImplTestCase::Add (uint32_t node, uint32_t value)
+{
+  Record record;
+  record.ts = Simulator::Now ().GetTimeStep ();
+  record.value = value;
+  m_records[node].push_back (record);
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), node, "wrong context");
+  NS_TEST_EXPECT_MSG_LT (Simulator::Now (), m_stop, "event after stop");
+  if (m_threaded)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Simulator::GetSystemId (), node, "event run by the wrong partition");
+    }
+}
+
+void
+ThreadedSimulatorImplTestCase::Ping (uint32_t node, uint32_t hops)
+{
+  Add (node, hops);
+  if (hops > 0)
+    {
+      uint32_t next = (node + 1) % N_NODES;
+      Simulator::ScheduleWithContext (next, MilliSeconds (1) + MicroSeconds (7 * node),
+                                      &ThreadedSimulatorImplTestCase::Ping, this, next, hops - 1);
+      Simulator::Schedule (MicroSeconds (300 + hops), &ThreadedSimulatorImplTestCase::Local, this, node, hops);
+    }
+}
+
+void
+ThreadedSimulatorImplTestCase::Local (uint32_t node, uint32_t value)
+{
+  Add (node, 1000 + value);
+  if (value % 3 == 0)
+    {
+      EventId id = Simulator::Schedule (MicroSeconds (10), &ThreadedSimulatorImplTestCase::Local, this, node, value + 1);
+      NS_TEST_EXPECT_MSG_EQ (Simulator::GetDelayLeft (id), MicroSeconds (10), "wrong delay left");
+      Simulator::Cancel (id);
+    }
+}
+
+ThreadedSimulatorImplTestCase::Records
+ThreadedSimulatorImplTestCase::RunWith (Ptr<SimulatorImpl> impl)
+{
+  Simulator::SetImplementation (impl);
+  m_threaded = DynamicCast<ThreadedSimulatorImpl> (impl) != 0;
+  m_records = Records (N_NODES);
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      CreateObject<Node> (i);
+    }
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i), &ThreadedSimulatorImplTestCase::Ping, this, i, 100);
+    }
+  Simulator::Stop (m_stop);
+  Simulator::Run ();
+  if (m_threaded)
+    {
+      NS_TEST_EXPECT_MSG_EQ (DynamicCast<ThreadedSimulatorImpl> (impl)->GetPartitionCount (), N_NODES,
+                             "one partition per system id");
+    }
+  Simulator::Destroy ();
+  for (uint32_t i = 0; i < N_NODES; ++i)
+    {
+      std::sort (m_records[i].begin (), m_records[i].end ());
+    }
+  return m_records;
+}
+
+void
+ThreadedSimulatorImplTestCase::DoRun (void)
+{
+  m_stop = NanoSeconds (50000500);
+  Records expected = RunWith (CreateObject<DefaultSimulatorImpl> ());
+  NS_TEST_ASSERT_MSG_GT (expected[0].size (), 50, "too few events");
+
+  for (uint32_t run = 0; run < 3; ++run)
+    {
+      Ptr<ThreadedSimulatorImpl> impl = CreateObject<ThreadedSimulatorImpl> ();
+      impl->SetMaximumLookAhead (MilliSeconds (1));
+      Records records = RunWith (impl);
+      for (uint32_t i = 0; i < N_NODES; ++i)
+        {
+          NS_TEST_ASSERT_MSG_EQ (records[i].size (), expected[i].size (), "wrong number of events on node " << i);
+          NS_TEST_EXPECT_MSG_EQ ((records[i] == expected[i]), true, "wrong events on node " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup mpi-test
+ * \ingroup tests
+ *
+ * \brief ThreadedSimulatorImpl TestSuite
+ */
+class ThreadedSimulatorImplTestSuite : public TestSuite
+{
+public:
+  ThreadedSimulatorImplTestSuite ()
+    : TestSuite ("threaded-simulator-impl", UNIT)
+  {
+    AddTestCase (new ThreadedSimulatorImplTestCase (), TestCase::QUICK);
+  }
+};
+
+static ThreadedSimulatorImplTestSuite g_threadedSimulatorImplTestSuite; //!< Static variable for test initialization
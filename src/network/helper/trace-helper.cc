@@ -28,6 +28,7 @@
 #include "ns3/names.h"
 #include "ns3/net-device.h"
 #include "ns3/pcap-file-wrapper.h"
+#include "ns3/binary-trace-stream-wrapper.h"
 
 #include "trace-helper.h"
 
@@ -208,6 +209,13 @@ AsciiTraceHelper::CreateFileStream (std::string filename, std::ios::openmode fil
   return StreamWrapper;
 }
 
+Ptr<OutputStreamWrapper>
+AsciiTraceHelper::CreateBinaryFileStream (std::string filename, std::ios::openmode filemode)
+{
+  NS_LOG_FUNCTION (filename << filemode);
+  return Create<BinaryTraceStreamWrapper> (filename, filemode);
+}
+
 std::string
 AsciiTraceHelper::GetFilenameFromDevice (std::string prefix, Ptr<NetDevice> device, bool useObjectNames)
 {
@@ -295,6 +303,27 @@ AsciiTraceHelper::GetFilenameFromInterfacePair (
   return oss.str ();
 }
 
+/**
+ * \brief Store an event of the default sinks if the stream is binary.
+ *
+ * \param stream the stream of the sink
+ * \param event the event character
+ * \param context the context of the event, or 0 if it has none
+ * \param p the packet of the event
+ * \returns false if the stream is an ascii stream
+ */
+static bool
+WriteBinaryEvent (Ptr<OutputStreamWrapper> stream, char event, std::string const *context, Ptr<const Packet> p)
+{
+  BinaryTraceStreamWrapper *binary = dynamic_cast<BinaryTraceStreamWrapper *> (PeekPointer (stream));
+  if (binary == 0)
+    {
+      return false;
+    }
+  binary->WriteEvent (event, context, Simulator::Now ().GetSeconds (), p);
+  return true;
+}
+
 //
 // One of the basic default trace sink sets.  Enqueue:
 //
@@ -310,14 +339,20 @@ void
 AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, '+', 0, p))
+    {
+      *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+    }
 }
 
 void
 AsciiTraceHelper::DefaultEnqueueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, '+', &context, p))
+    {
+      *stream->GetStream () << "+ " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+    }
 }
 
 //
@@ -336,14 +371,20 @@ void
 AsciiTraceHelper::DefaultDropSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, 'd', 0, p))
+    {
+      *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+    }
 }
 
 void
 AsciiTraceHelper::DefaultDropSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, 'd', &context, p))
+    {
+      *stream->GetStream () << "d " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+    }
 }
 
 //
@@ -363,14 +404,20 @@ void
 AsciiTraceHelper::DefaultDequeueSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, '-', 0, p))
+    {
+      *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+    }
 }
 
 void
 AsciiTraceHelper::DefaultDequeueSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, '-', &context, p))
+    {
+      *stream->GetStream () << "- " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+    }
 }
 
 //
@@ -387,14 +434,20 @@ void
 AsciiTraceHelper::DefaultReceiveSinkWithoutContext (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, 'r', 0, p))
+    {
+      *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << *p << std::endl;
+    }
 }
 
 void
 AsciiTraceHelper::DefaultReceiveSinkWithContext (Ptr<OutputStreamWrapper> stream, std::string context, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (stream << p);
-  *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+  if (!WriteBinaryEvent (stream, 'r', &context, p))
+    {
+      *stream->GetStream () << "r " << Simulator::Now ().GetSeconds () << " " << context << " " << *p << std::endl;
+    }
 }
 
 void 
@@ -33,6 +33,10 @@ namespace ns3 {
  *
  * Handling pcap files is a common operation for ns-3 devices.  It is useful to
  * provide a common base class for dealing with these ops.
+ *
+ * Files are created through PcapFileWrapper, so setting the default of
+ * ns3::PcapFileWrapper::AsyncWrite moves the writes of every helper-created
+ * trace onto a background thread.
  */
 
 class PcapHelper
@@ -222,6 +226,23 @@ public:
   Ptr<OutputStreamWrapper> CreateFileStream (std::string filename, 
                                              std::ios::openmode filemode = std::ios::out);
 
+  /**
+   * @brief Create and initialize an output stream object which the default
+   * trace sinks fill with the compact binary format of
+   * BinaryTraceStreamWrapper.
+   *
+   * The stream can be passed wherever CreateFileStream's streams are, but
+   * only the default sinks (such as DefaultEnqueueSinkWithContext) know how
+   * to write to it.  The utils/decode-ascii-trace program regenerates the
+   * ascii text the default sinks would have written.
+   *
+   * @param filename file name
+   * @param filemode file mode
+   * @returns a smart pointer to the output stream
+   */
+  Ptr<OutputStreamWrapper> CreateBinaryFileStream (std::string filename, 
+                                                   std::ios::openmode filemode = std::ios::out);
+
   /**
    * @brief Hook a trace source to the default enqueue operation trace sink that
    * does not accept nor log a trace context.
@@ -20,6 +20,10 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/ip-checksum.h"
+#include <algorithm>
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -50,16 +54,73 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
+
+/**
+ * \brief The limit on the memory held by the buffer data pool of each thread.
+ */
+static GlobalValue g_bufferPoolMaxBytes = GlobalValue ("BufferPoolMaxBytes",
+                                                       "The limit on the memory held by the buffer data pool of each thread, in bytes",
+                                                       UintegerValue (16 << 20),
+                                                       MakeUintegerChecker<uint64_t> ());
+
+namespace {
+
+/** The size of the data of the smallest size class: 64 bytes. */
+const uint32_t POOL_MIN_SHIFT = 6;
+/** The number of size classes: 64 bytes to 64 KiB. */
+const uint32_t POOL_SIZE_CLASSES = 11;
+
+/**
+ * \ingroup packet
+ * \brief Get the size class of a data size.
+ * \param size the data size
+ * \returns the index of the smallest size class which holds \p size bytes,
+ *          or POOL_SIZE_CLASSES if none does.
+ */
+uint32_t
+GetSizeClass (uint32_t size)
+{
+  uint32_t index = 0;
+  while (index < POOL_SIZE_CLASSES && (1U << (POOL_MIN_SHIFT + index)) < size)
+    {
+      index++;
+    }
+  return index;
+}
+
+/**
+ * \ingroup packet
+ * \brief Get the data size of a size class.
+ * \param index the index of the size class
+ * \returns the data size.
+ */
+uint32_t
+GetClassSize (uint32_t index)
+{
+  return 1U << (POOL_MIN_SHIFT + index);
+}
+
+} // unnamed namespace
+
+/**
+ * The free lists of the size classes, and their statistics.
+ */
+struct Buffer::Pool
+{
+  Buffer::FreeList lists[POOL_SIZE_CLASSES]; //!< Free list of each size class
+  struct Buffer::PoolStats stats;            //!< Statistics
+};
+
 /* The following macros are pretty evil but they are needed to allow us to
- * keep track of 3 possible states for the g_freeList variable:
+ * keep track of 3 possible states for the g_pool variable:
  *  - uninitialized means that no one has created a buffer yet
- *    so no one has created the associated free list (it is created
+ *    so no one has created the associated pool (it is created
  *    on-demand when the first buffer is created)
- *  - initialized means that the free list exists and is valid
+ *  - initialized means that the pool exists and is valid
  *  - destroyed means that the static destructors of this compilation unit
- *    have run so, the free list has been cleared from its content
+ *    have run so, the pool has been cleared from its content
  * The key is that in destroyed state, we are careful not re-create it
  * which is a typical weakness of lazy evaluation schemes which use 
  * '0' as a special value to indicate both un-initialized and destroyed.
@@ -70,27 +131,68 @@ uint32_t Buffer::g_recommendedStart = 0;
  * constructor orderings.
  */
 #define MAGIC_DESTROYED (~(long) 0)
-#define IS_UNINITIALIZED(x) (x == (Buffer::FreeList*)0)
-#define IS_DESTROYED(x) (x == (Buffer::FreeList*)MAGIC_DESTROYED)
+#define IS_UNINITIALIZED(x) (x == (Buffer::Pool*)0)
+#define IS_DESTROYED(x) (x == (Buffer::Pool*)MAGIC_DESTROYED)
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
-#define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
-#define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#define DESTROYED ((Buffer::Pool*)MAGIC_DESTROYED)
+#define UNINITIALIZED ((Buffer::Pool*)0)
+thread_local Buffer::Pool *Buffer::g_pool = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
-  if (IS_INITIALIZED (g_freeList))
+  if (IS_INITIALIZED (g_pool))
     {
-      for (Buffer::FreeList::iterator i = g_freeList->begin ();
-           i != g_freeList->end (); i++)
+      for (uint32_t i = 0; i < POOL_SIZE_CLASSES; i++)
         {
-          Buffer::Deallocate (*i);
+          for (Buffer::FreeList::iterator j = g_pool->lists[i].begin ();
+               j != g_pool->lists[i].end (); j++)
+            {
+              Buffer::Deallocate (*j);
+            }
+        }
+      delete g_pool;
+      g_pool = DESTROYED;
+    }
+}
+
+struct Buffer::Pool *
+Buffer::GetPool (void)
+{
+  if (IS_UNINITIALIZED (g_pool))
+    {
+      g_pool = new Buffer::Pool ();
+      UintegerValue maxBytes;
+      g_bufferPoolMaxBytes.GetValue (maxBytes);
+      g_pool->stats.maxBytes = maxBytes.Get ();
+      // The pool is per-thread: make sure the destructor of
+      // this thread runs when it exits.
+      (void) &g_localStaticDestructor;
+    }
+  else if (IS_DESTROYED (g_pool))
+    {
+      return 0;
+    }
+  return g_pool;
+}
+
+void
+Buffer::TrimPool (struct Buffer::Pool *pool)
+{
+  NS_LOG_FUNCTION (pool);
+  // Release the largest data first: they hold the most memory.
+  for (uint32_t i = POOL_SIZE_CLASSES; i > 0 && pool->stats.bytesHeld > pool->stats.maxBytes; i--)
+    {
+      Buffer::FreeList *list = &pool->lists[i - 1];
+      while (!list->empty () && pool->stats.bytesHeld > pool->stats.maxBytes)
+        {
+          struct Buffer::Data *data = list->back ();
+          list->pop_back ();
+          pool->stats.bytesHeld -= data->m_size;
+          pool->stats.releases++;
+          Buffer::Deallocate (data);
         }
-      delete g_freeList;
-      g_freeList = DESTROYED;
     }
 }
 
@@ -99,19 +201,27 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
-  g_maxSize = std::max (g_maxSize, data->m_size);
-  /* feed into free list */
-  if (data->m_size < g_maxSize ||
-      IS_DESTROYED (g_freeList) ||
-      g_freeList->size () > 1000)
+  NS_ASSERT (!IS_UNINITIALIZED (g_pool));
+  if (IS_DESTROYED (g_pool))
+    {
+      Buffer::Deallocate (data);
+      return;
+    }
+  /* feed into the free list of the size class, unless the data
+   * was too large for the size classes or the pool is full. */
+  uint32_t index = GetSizeClass (data->m_size);
+  if (index == POOL_SIZE_CLASSES ||
+      g_pool->stats.bytesHeld + data->m_size > g_pool->stats.maxBytes)
     {
+      g_pool->stats.releases++;
       Buffer::Deallocate (data);
     }
   else
     {
-      NS_ASSERT (IS_INITIALIZED (g_freeList));
-      g_freeList->push_back (data);
+      NS_ASSERT (data->m_size == GetClassSize (index));
+      g_pool->lists[index].push_back (data);
+      g_pool->stats.bytesHeld += data->m_size;
+      g_pool->stats.maxBytesHeld = std::max (g_pool->stats.maxBytesHeld, g_pool->stats.bytesHeld);
     }
 }
 
@@ -119,29 +229,62 @@ Buffer::Data *
 Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
-  /* try to find a buffer correctly sized. */
-  if (IS_UNINITIALIZED (g_freeList))
+  struct Buffer::Pool *pool = GetPool ();
+  uint32_t index = GetSizeClass (dataSize);
+  if (index == POOL_SIZE_CLASSES)
     {
-      g_freeList = new Buffer::FreeList ();
+      /* too large for the size classes: allocate the exact size. */
+      if (pool != 0)
+        {
+          pool->stats.misses++;
+        }
+      return Buffer::Allocate (dataSize);
     }
-  else if (IS_INITIALIZED (g_freeList))
+  if (pool != 0)
     {
-      while (!g_freeList->empty ()) 
+      /* try to find a buffer of the size class. */
+      Buffer::FreeList *list = &pool->lists[index];
+      if (!list->empty ())
         {
-          struct Buffer::Data *data = g_freeList->back ();
-          g_freeList->pop_back ();
-          if (data->m_size >= dataSize) 
-            {
-              data->m_count = 1;
-              return data;
-            }
-          Buffer::Deallocate (data);
+          struct Buffer::Data *data = list->back ();
+          list->pop_back ();
+          pool->stats.bytesHeld -= data->m_size;
+          pool->stats.hits++;
+          data->m_count = 1;
+          return data;
         }
+      pool->stats.misses++;
     }
-  struct Buffer::Data *data = Buffer::Allocate (dataSize);
+  struct Buffer::Data *data = Buffer::Allocate (GetClassSize (index));
   NS_ASSERT (data->m_count == 1);
   return data;
 }
+
+struct Buffer::PoolStats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  struct Buffer::Pool *pool = GetPool ();
+  if (pool == 0)
+    {
+      struct Buffer::PoolStats stats;
+      std::memset (&stats, 0, sizeof (stats));
+      return stats;
+    }
+  return pool->stats;
+}
+
+void
+Buffer::SetPoolMaxBytes (uint64_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBytes);
+  struct Buffer::Pool *pool = GetPool ();
+  if (pool != 0)
+    {
+      pool->stats.maxBytes = maxBytes;
+      TrimPool (pool);
+    }
+}
 #else /* BUFFER_FREE_LIST */
 void
 Buffer::Recycle (struct Buffer::Data *data)
@@ -157,6 +300,21 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+struct Buffer::PoolStats
+Buffer::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  struct Buffer::PoolStats stats;
+  std::memset (&stats, 0, sizeof (stats));
+  return stats;
+}
+
+void
+Buffer::SetPoolMaxBytes (uint64_t maxBytes)
+{
+  NS_LOG_FUNCTION (maxBytes);
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -244,7 +402,7 @@ void
 Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
-  m_data = Buffer::Create (0);
+  m_data = Buffer::Create (g_recommendedStart);
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -1143,14 +1301,32 @@ uint16_t
 Buffer::Iterator::CalculateIpChecksum (uint16_t size, uint32_t initialChecksum)
 {
   NS_LOG_FUNCTION (this << size << initialChecksum);
+  NS_ASSERT_MSG (m_current >= m_dataStart && m_current + size <= m_dataEnd,
+                 GetReadErrorMessage ());
   /* see RFC 1071 to understand this code. */
-  uint32_t sum = initialChecksum;
+  uint64_t sum = initialChecksum;
+  uint32_t start = m_current;
+  uint32_t end = m_current + size;
 
-  for (int j = 0; j < size/2; j++)
-    sum += ReadU16 ();
-
-  if (size & 1)
-    sum += ReadU8 ();
+  // The bytes before the virtual zero area, which add nothing to the sum
+  if (start < m_zeroStart)
+    {
+      uint32_t last = std::min (end, m_zeroStart);
+      sum += IpChecksumPartial (&m_data[start], last - start);
+    }
+  // The bytes after the virtual zero area
+  if (end > m_zeroEnd)
+    {
+      uint32_t first = std::max (start, m_zeroEnd);
+      uint16_t partial = IpChecksumPartial (&m_data[first - (m_zeroEnd - m_zeroStart)], end - first);
+      if ((first - start) & 1)
+        {
+          // these bytes start in the high order bits of the words
+          partial = (partial >> 8) | (partial << 8);
+        }
+      sum += partial;
+    }
+  m_current = end;
 
   while (sum >> 16)
     sum = (sum & 0xffff) + (sum >> 16);
@@ -38,9 +38,14 @@ namespace ns3 {
  * automatically adjusted to hold any data prepended
  * or appended by the user. Its implementation is optimized
  * to ensure that the number of buffer resizes is minimized,
- * by creating new Buffers of the maximum size ever used.
- * The correct maximum size is learned at runtime during use by 
- * recording the maximum size of each packet.
+ * by reserving in new Buffers the room for the largest headers
+ * ever added in front of a Buffer.  This room is learned at
+ * runtime during use by recording the headers of each packet.
+ *
+ * The data storage of the buffers is rounded up to power-of-two
+ * size classes, and recycled through per-thread free lists, one
+ * per size class, which hold at most "BufferPoolMaxBytes" bytes.
+ * See GetPoolStats.
  *
  * \internal
  * The implementation of the Buffer class uses a COW (Copy On Write)
@@ -642,6 +647,41 @@ private:
    */
   Buffer (uint32_t dataSize, bool initialize);
   ~Buffer ();
+
+  /**
+   * \brief Statistics of the buffer data pool of a thread.
+   */
+  struct PoolStats
+  {
+    uint64_t hits;         //!< Data storage reused from the pool
+    uint64_t misses;       //!< Data storage allocated from the heap
+    uint64_t releases;     //!< Data storage returned to the heap, rather than to the pool
+    uint64_t bytesHeld;    //!< Bytes currently held in the pool
+    uint64_t maxBytesHeld; //!< Highest value of bytesHeld
+    uint64_t maxBytes;     //!< Limit on bytesHeld
+  };
+  /**
+   * \brief Get the statistics of the buffer data pool of the
+   * calling thread.
+   *
+   * Each thread recycles the data storage of its buffers in its own
+   * pool: these statistics cover only the buffers created and
+   * destroyed by the calling thread.
+   *
+   * \returns the statistics.
+   */
+  static struct PoolStats GetPoolStats (void);
+  /**
+   * \brief Set the limit on the memory held by the buffer data pool
+   * of the calling thread.
+   *
+   * The limit of a new pool is the value of the "BufferPoolMaxBytes"
+   * global value.  If the pool already holds more than \p maxBytes,
+   * the excess is returned to the heap.
+   *
+   * \param maxBytes the limit, in bytes.
+   */
+  static void SetPoolMaxBytes (uint64_t maxBytes);
 private:
   /**
    * This data structure is variable-sized through its last member whose size
@@ -767,7 +807,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -793,14 +833,25 @@ private:
 #ifdef BUFFER_FREE_LIST
   /// Container for buffer data
   typedef std::vector<struct Buffer::Data*> FreeList;
+  /// The free lists of the size classes and their statistics
+  struct Pool;
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /**
+   * \brief Get the pool of the calling thread, creating it if needed.
+   * \returns the pool, or zero if it has already been destroyed.
+   */
+  static struct Pool *GetPool (void);
+  /**
+   * \brief Return the data in excess of the limit of a pool to the heap.
+   * \param pool the pool
+   */
+  static void TrimPool (struct Pool *pool);
+  static thread_local struct Pool *g_pool; //!< Buffer data pool
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
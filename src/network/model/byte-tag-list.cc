@@ -53,12 +53,15 @@ struct ByteTagListData {
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+};
+static thread_local ByteTagListDataFreeList g_freeList; //!< Container for struct ByteTagListData
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/// Set when g_freeList of the calling thread has been destroyed
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +72,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -159,6 +163,10 @@ ByteTagList::ByteTagList (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
 }
 ByteTagList &
 ByteTagList::operator = (const ByteTagList &o)
@@ -178,6 +186,10 @@ ByteTagList::operator = (const ByteTagList &o)
     {
       m_data->count++;
     }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
+    }
   return *this;
 }
 ByteTagList::~ByteTagList ()
@@ -196,9 +208,12 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
   NS_ASSERT (m_used <= spaceNeeded);
   if (m_data == 0)
     {
-      m_data = Allocate (spaceNeeded);
-      m_used = 0;
-    } 
+      if (spaceNeeded > INLINE_SIZE)
+        {
+          m_data = Allocate (spaceNeeded);
+          std::memcpy (&m_data->data, m_inline, m_used);
+        }
+    }
   else if (m_data->size < spaceNeeded ||
            (m_data->count != 1 && m_data->dirty != m_used))
     {
@@ -207,8 +222,8 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       Deallocate (m_data);
       m_data = newData;
     }
-  TagBuffer tag = TagBuffer (&m_data->data[m_used], 
-                             &m_data->data[spaceNeeded]);
+  uint8_t *data = m_data != 0 ? m_data->data : m_inline;
+  TagBuffer tag = TagBuffer (&data[m_used], &data[spaceNeeded]);
   tag.WriteU32 (tid.GetUid ());
   tag.WriteU32 (bufferSize);
   tag.WriteU32 (start - m_adjustment);
@@ -222,7 +237,10 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_maxEnd = end - m_adjustment;
     }
   m_used = spaceNeeded;
-  m_data->dirty = m_used;
+  if (m_data != 0)
+    {
+      m_data->dirty = m_used;
+    }
   return tag;
 }
 
@@ -266,7 +284,8 @@ ByteTagList::Begin (int32_t offsetStart, int32_t offsetEnd) const
   NS_LOG_FUNCTION (this << offsetStart << offsetEnd);
   if (m_data == 0)
     {
-      return Iterator (0, 0, offsetStart, offsetEnd, 0);
+      return Iterator (const_cast<uint8_t *> (m_inline), const_cast<uint8_t *> (&m_inline[m_used]),
+                       offsetStart, offsetEnd, m_adjustment);
     }
   else
     {
@@ -345,7 +364,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -379,7 +398,10 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      // the packets which outlive the thread, such as those held by
+      // static objects, are destroyed after the free list.
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -49,6 +49,10 @@ struct ByteTagListData;
  *     is shared and, thus, reference-counted. This data structure is unshared
  *     as-needed to emulate COW semantics.
  *
+ *   - As long as the tags fit in INLINE_SIZE bytes, the byte buffer is
+ *     stored in the ByteTagList itself, and copied with it, rather than
+ *     in a struct ByteTagListData: most packets carry a few small tags.
+ *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
  *     Whenever the origin of the offset changes, the Packet adjusts all
@@ -231,6 +235,9 @@ private:
    */
   void AddAtStart (int32_t prependOffset);
 
+  /// The size of the byte buffer stored inline.
+  static const uint32_t INLINE_SIZE = 64;
+
 private:
   /**
    * \brief Returns an iterator pointing to the very first tag in this list.
@@ -256,7 +263,8 @@ private:
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
-  struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  struct ByteTagListData *m_data; //!< the ByteTagListData structure, or zero if the buffer is inline
+  uint8_t m_inline[INLINE_SIZE]; //!< the byte buffer, while the tags fit
 };
 
 void
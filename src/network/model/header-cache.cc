@@ -0,0 +1,124 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "header-cache.h"
+#include "ns3/log.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::HeaderCache implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HeaderCache");
+
+HeaderCache::HeaderCache ()
+  : m_next (0)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      m_entries[i].ops = 0;
+      m_entries[i].offset = 0;
+      m_entries[i].size = 0;
+    }
+}
+
+HeaderCache::HeaderCache (const HeaderCache &o)
+  : SimpleRefCount<HeaderCache> (o),
+    m_next (o.m_next)
+{
+  NS_LOG_FUNCTION (this << &o);
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      const Entry &from = o.m_entries[i];
+      Entry &to = m_entries[i];
+      to.ops = from.ops;
+      to.tid = from.tid;
+      to.offset = from.offset;
+      to.size = from.size;
+      if (from.ops != 0)
+        {
+          from.ops->copy (&to.storage, &from.storage);
+        }
+    }
+}
+
+HeaderCache::~HeaderCache ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      Free (m_entries[i]);
+    }
+}
+
+void
+HeaderCache::Free (Entry &entry)
+{
+  if (entry.ops != 0)
+    {
+      entry.ops->destroy (&entry.storage);
+      entry.ops = 0;
+    }
+}
+
+uint32_t
+HeaderCache::Find (TypeId tid) const
+{
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      if (m_entries[i].ops != 0 && m_entries[i].offset == 0 && m_entries[i].tid == tid)
+        {
+          return i;
+        }
+    }
+  return N_ENTRIES;
+}
+
+void
+HeaderCache::AddAtStart (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      m_entries[i].offset += size;
+    }
+}
+
+void
+HeaderCache::RemoveAtStart (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  for (uint32_t i = 0; i < N_ENTRIES; i++)
+    {
+      if (m_entries[i].offset < size)
+        {
+          Free (m_entries[i]);
+          m_entries[i].offset = 0;
+        }
+      else
+        {
+          m_entries[i].offset -= size;
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef HEADER_CACHE_H
+#define HEADER_CACHE_H
+
+#include <stdint.h>
+#include <new>
+#include <type_traits>
+#include "ns3/simple-ref-count.h"
+#include "ns3/type-id.h"
+
+/**
+ * \file
+ * \ingroup packet
+ * ns3::HeaderCache declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ * \brief The headers already deserialized from the bytes of a packet.
+ *
+ * Each entry holds a copy of a header, as deserialized by
+ * Packet::PeekHeader, with the TypeId of the header and the offset of
+ * its bytes from the start of the packet.  Packet::PeekHeader and
+ * Packet::RemoveHeader return this copy rather than deserialize the
+ * same bytes again.
+ *
+ * A cache is shared by the copies of a packet, which hold the same
+ * bytes, and copied by Packet before it changes its bytes.  Adding or
+ * removing bytes at the start of the packet moves the entries, and
+ * drops those whose bytes were removed; any change at the end of the
+ * packet drops all of them, since a Header::Deserialize may read up to
+ * the end of the packet.
+ *
+ * The cache holds at most four headers: when it is full, a new header
+ * replaces the oldest one.  The copies are stored in the entries
+ * themselves, so that caching a header does not allocate memory;
+ * headers larger than HeaderCache::STORAGE_SIZE bytes are not cached.
+ */
+class HeaderCache : public SimpleRefCount<HeaderCache>
+{
+public:
+  HeaderCache ();
+  /**
+   * Copy constructor.
+   * \param [in] o the cache to copy
+   */
+  HeaderCache (const HeaderCache &o);
+  ~HeaderCache ();
+
+  /// The largest header stored, in bytes.
+  static const uint32_t STORAGE_SIZE = 128;
+
+  /**
+   * \brief Get the header of type T at the start of the packet.
+   *
+   * \param [out] header the copy of the header
+   * \param [out] size the number of bytes of the header
+   * \returns true if the cache holds such a header.
+   */
+  template <typename T>
+  bool Peek (T &header, uint32_t &size) const;
+  /**
+   * \brief Add the header deserialized at the start of the packet.
+   *
+   * \param [in] header the header
+   * \param [in] size the number of bytes of the header
+   */
+  template <typename T>
+  void Insert (const T &header, uint32_t size);
+  /**
+   * \brief Account for bytes added at the start of the packet.
+   *
+   * \param [in] size the number of bytes added
+   */
+  void AddAtStart (uint32_t size);
+  /**
+   * \brief Account for bytes removed from the start of the packet.
+   *
+   * \param [in] size the number of bytes removed
+   */
+  void RemoveAtStart (uint32_t size);
+
+private:
+  /// Copy and destroy a header stored in an entry, whatever its type.
+  struct Operations
+  {
+    /// Copy-construct the header at src into dst.
+    void (*copy) (void *dst, const void *src);
+    /// Destroy the header at p.
+    void (*destroy) (void *p);
+  };
+  /// The Operations of the headers of type T.
+  template <typename T>
+  struct HeaderOperations
+  {
+    /**
+     * Copy-construct a header.
+     * \param [in] dst the storage of the copy
+     * \param [in] src the header to copy
+     */
+    static void Copy (void *dst, const void *src)
+    {
+      new (dst) T (*static_cast<const T *> (src));
+    }
+    /**
+     * Destroy a header.
+     * \param [in] p the header
+     */
+    static void Destroy (void *p)
+    {
+      static_cast<T *> (p)->~T ();
+    }
+    static const Operations ops; //!< the operations
+  };
+  /// A header and the position of its bytes.
+  struct Entry
+  {
+    /// The operations of the header, or zero if the entry is free.
+    const Operations *ops;
+    TypeId tid;      //!< the TypeId of the header
+    uint32_t offset; //!< the offset of the header from the start of the packet
+    uint32_t size;   //!< the number of bytes of the header
+    /// The copy of the header.
+    std::aligned_storage<STORAGE_SIZE>::type storage;
+  };
+
+  /// The number of entries.
+  static const uint32_t N_ENTRIES = 4;
+
+  /**
+   * \brief Find the entry of a header at the start of the packet.
+   * \param [in] tid the TypeId of the header
+   * \returns the index of the entry, or N_ENTRIES.
+   */
+  uint32_t Find (TypeId tid) const;
+  /**
+   * \brief Destroy the header of an entry, if any.
+   * \param [in] entry the entry
+   */
+  static void Free (Entry &entry);
+
+  /**
+   * \brief Assignment operator, not implemented.
+   * \param [in] o the cache to copy
+   * \returns the cache
+   */
+  HeaderCache &operator = (const HeaderCache &o);
+
+  Entry m_entries[N_ENTRIES]; //!< the entries
+  uint32_t m_next;            //!< the entry replaced by the next Insert into a full cache
+};
+
+} // namespace ns3
+
+
+namespace ns3 {
+
+template <typename T>
+const HeaderCache::Operations HeaderCache::HeaderOperations<T>::ops = {
+  &HeaderCache::HeaderOperations<T>::Copy,
+  &HeaderCache::HeaderOperations<T>::Destroy
+};
+
+template <typename T>
+bool
+HeaderCache::Peek (T &header, uint32_t &size) const
+{
+  uint32_t i = Find (T::GetTypeId ());
+  // The TypeId of a class without its own is the one of its parent:
+  // check the type of the copy.
+  if (i == N_ENTRIES || m_entries[i].ops != &HeaderOperations<T>::ops)
+    {
+      return false;
+    }
+  header = *reinterpret_cast<const T *> (&m_entries[i].storage);
+  size = m_entries[i].size;
+  return true;
+}
+
+template <typename T>
+void
+HeaderCache::Insert (const T &header, uint32_t size)
+{
+  if (sizeof (T) > STORAGE_SIZE
+      || alignof (T) > alignof (std::aligned_storage<STORAGE_SIZE>::type))
+    {
+      return;
+    }
+  TypeId tid = T::GetTypeId ();
+  uint32_t i = Find (tid);
+  if (i == N_ENTRIES)
+    {
+      for (i = 0; i < N_ENTRIES; i++)
+        {
+          if (m_entries[i].ops == 0)
+            {
+              break;
+            }
+        }
+    }
+  if (i == N_ENTRIES)
+    {
+      i = m_next;
+      m_next = (m_next + 1) % N_ENTRIES;
+    }
+  Entry &entry = m_entries[i];
+  Free (entry);
+  new (&entry.storage) T (header);
+  entry.ops = &HeaderOperations<T>::ops;
+  entry.tid = tid;
+  entry.offset = 0;
+  entry.size = size;
+}
+
+} // namespace ns3
+
+#endif /* HEADER_CACHE_H */
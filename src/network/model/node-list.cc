@@ -80,9 +80,13 @@ public:
 
   /**
    * \brief Get the node list object
+   *
+   * The node list is not reference-counted by the callers, so that
+   * the threads of a parallel simulator can look up their nodes.
+   *
    * \returns the node list
    */
-  static Ptr<NodeListPriv> Get (void);
+  static NodeListPriv * Get (void);
 
 private:
   /**
@@ -120,11 +124,11 @@ NodeListPriv::GetTypeId (void)
   return tid;
 }
 
-Ptr<NodeListPriv> 
+NodeListPriv *
 NodeListPriv::Get (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  return *DoGet ();
+  return PeekPointer (*DoGet ());
 }
 Ptr<NodeListPriv> *
 NodeListPriv::DoGet (void)
@@ -22,6 +22,9 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -33,10 +36,38 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+bool PacketMetadata::m_compact = false;
+uint32_t PacketMetadata::m_sampling = 1;
+thread_local bool PacketMetadata::m_metadataSkipped = false;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
+thread_local PacketMetadata::RecordsFreeList PacketMetadata::m_recordsFreeList;
+thread_local bool PacketMetadata::m_recordsFreeListDestroyed = false;
+
+/**
+ * \relates PacketMetadata
+ * \brief Store the metadata of the new packets as fixed-size records
+ */
+static GlobalValue g_packetMetadataCompact =
+  GlobalValue ("PacketMetadataCompact",
+               "Store the packet metadata enabled afterwards as fixed-size "
+               "records, which are faster to add and remove than the "
+               "default linked list items but use more memory.",
+               BooleanValue (false),
+               MakeBooleanChecker ());
+
+/**
+ * \relates PacketMetadata
+ * \brief Only 1 in N packets carry metadata
+ */
+static GlobalValue g_packetMetadataSampling =
+  GlobalValue ("PacketMetadataSampling",
+               "When the packet metadata is enabled, only the packets whose "
+               "uid is a multiple of this value carry metadata.",
+               UintegerValue (1),
+               MakeUintegerChecker<uint32_t> (1));
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +76,18 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
+}
+
+PacketMetadata::RecordsFreeList::~RecordsFreeList ()
+{
+  NS_LOG_FUNCTION (this);
+  for (iterator i = begin (); i != end (); i++)
+    {
+      uint8_t *buffer = reinterpret_cast<uint8_t *> (*i);
+      delete [] buffer;
+    }
+  PacketMetadata::m_recordsFreeListDestroyed = true;
 }
 
 void 
@@ -60,6 +102,12 @@ PacketMetadata::Enable (void)
                  "to call ns3::PacketMetadata::Enable () near the beginning of"
                  " the program, before any packets are sent.");
   m_enable = true;
+  BooleanValue compact;
+  g_packetMetadataCompact.GetValue (compact);
+  m_compact = compact.Get ();
+  UintegerValue sampling;
+  g_packetMetadataSampling.GetValue (sampling);
+  m_sampling = sampling.Get ();
 }
 
 void 
@@ -133,6 +181,14 @@ bool
 PacketMetadata::IsStateOk (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_records != 0)
+    {
+      return m_head <= m_tail && m_tail <= m_records->m_size;
+    }
+  if (m_data == 0)
+    {
+      return m_head == 0xffff && m_tail == 0xffff;
+    }
   bool ok = m_used <= m_data->m_size;
   ok &= IsPointerOk (m_head);
   ok &= IsPointerOk (m_tail);
@@ -504,7 +560,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
    */
 
   // create a copy of the packet without its tail.
-  PacketMetadata h (m_packetUid, 0);
+  PacketMetadata h = CreateLinked (m_packetUid);
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -596,7 +652,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -639,6 +695,197 @@ PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
   delete [] buf;
 }
 
+PacketMetadata::PacketMetadata ()
+  : m_data (PacketMetadata::Create (10)),
+    m_records (0),
+    m_head (0xffff),
+    m_tail (0xffff),
+    m_used (0),
+    m_packetUid (0)
+{
+  memset (m_data->m_data, 0xff, 4);
+}
+
+PacketMetadata
+PacketMetadata::CreateLinked (uint64_t uid)
+{
+  NS_LOG_FUNCTION (uid);
+  PacketMetadata metadata;
+  metadata.m_packetUid = uid;
+  return metadata;
+}
+
+void
+PacketMetadata::Drop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_data != 0)
+    {
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+      m_data = 0;
+    }
+  if (m_records != 0)
+    {
+      PacketMetadata::ReleaseRecords (m_records);
+      m_records = 0;
+    }
+  m_head = 0xffff;
+  m_tail = 0xffff;
+  m_used = 0;
+}
+
+struct PacketMetadata::Records *
+PacketMetadata::CreateRecords (uint16_t size)
+{
+  NS_LOG_FUNCTION (size);
+  struct PacketMetadata::Records *records;
+  if (size == RECORDS_SIZE && !m_recordsFreeList.empty ())
+    {
+      records = m_recordsFreeList.back ();
+      m_recordsFreeList.pop_back ();
+    }
+  else
+    {
+      uint32_t n = sizeof (struct Records) + (size - 1) * sizeof (struct Record);
+      records = reinterpret_cast<struct PacketMetadata::Records *> (new uint8_t [n]);
+      records->m_size = size;
+    }
+  records->m_count = 1;
+  return records;
+}
+
+void
+PacketMetadata::RecycleRecords (struct PacketMetadata::Records *records)
+{
+  NS_LOG_FUNCTION (records);
+  NS_ASSERT (records->m_count == 0);
+  if (records->m_size != RECORDS_SIZE ||
+      m_recordsFreeListDestroyed ||
+      m_recordsFreeList.size () > 1000)
+    {
+      uint8_t *buffer = reinterpret_cast<uint8_t *> (records);
+      delete [] buffer;
+      return;
+    }
+  m_recordsFreeList.push_back (records);
+}
+
+void
+PacketMetadata::ReserveRecords (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint16_t n = m_tail - m_head;
+  uint32_t size = RECORDS_SIZE;
+  while (size < 2 * n + 4u)
+    {
+      size *= 2;
+    }
+  if (size > 0xfffe)
+    {
+      NS_FATAL_ERROR ("Too many items in the packet metadata.");
+    }
+  struct PacketMetadata::Records *records = PacketMetadata::CreateRecords (size);
+  // keep two thirds of the free room for the headers
+  uint16_t head = (size - n) - (size - n) / 3;
+  memcpy (&records->m_records[head], &m_records->m_records[m_head],
+          n * sizeof (struct Record));
+  PacketMetadata::ReleaseRecords (m_records);
+  m_records = records;
+  m_head = head;
+  m_tail = head + n;
+  m_records->m_dirtyStart = m_head;
+  m_records->m_dirtyEnd = m_tail;
+}
+
+void
+PacketMetadata::UnshareRecords (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_records->m_count > 1)
+    {
+      ReserveRecords ();
+    }
+}
+
+struct PacketMetadata::Record *
+PacketMetadata::PrependRecord (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_head == 0 ||
+      (m_records->m_count != 1 && m_records->m_dirtyStart != m_head))
+    {
+      /* (not enough room) or (the record before the head is used by
+       * another copy) */
+      ReserveRecords ();
+    }
+  m_head--;
+  m_records->m_dirtyStart = m_head;
+  return &m_records->m_records[m_head];
+}
+
+struct PacketMetadata::Record *
+PacketMetadata::AppendRecord (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_tail == m_records->m_size ||
+      (m_records->m_count != 1 && m_records->m_dirtyEnd != m_tail))
+    {
+      /* (not enough room) or (the record after the tail is used by
+       * another copy) */
+      ReserveRecords ();
+    }
+  m_tail++;
+  m_records->m_dirtyEnd = m_tail;
+  return &m_records->m_records[m_tail - 1];
+}
+
+bool
+PacketMetadata::NextItem (uint16_t &current,
+                          struct PacketMetadata::SmallItem *item,
+                          struct PacketMetadata::ExtraItem *extraItem) const
+{
+  NS_LOG_FUNCTION (this << current);
+  if (m_records != 0)
+    {
+      if (current >= m_tail)
+        {
+          return false;
+        }
+      const struct Record &record = m_records->m_records[current];
+      bool isExtra = record.fragmentStart != 0 ||
+        record.fragmentEnd != record.size ||
+        record.packetUid != m_packetUid;
+      item->next = current + 1;
+      item->prev = current - 1;
+      item->typeUid = (record.tid << 1) | (isExtra ? 1 : 0);
+      item->size = record.size;
+      item->chunkUid = record.chunkUid;
+      extraItem->fragmentStart = record.fragmentStart;
+      extraItem->fragmentEnd = record.fragmentEnd;
+      extraItem->packetUid = record.packetUid;
+      current++;
+      return true;
+    }
+  if (current == 0xffff)
+    {
+      return false;
+    }
+  ReadItems (current, item, extraItem);
+  if (current == m_tail)
+    {
+      current = 0xffff;
+    }
+  else
+    {
+      NS_ASSERT (current != item->next);
+      current = item->next;
+    }
+  return true;
+}
 
 PacketMetadata 
 PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
@@ -668,6 +915,22 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_records != 0)
+    {
+      struct PacketMetadata::Record *record = PrependRecord ();
+      record->packetUid = m_packetUid;
+      record->size = size;
+      record->fragmentStart = 0;
+      record->fragmentEnd = size;
+      record->tid = uid >> 1;
+      record->chunkUid = m_chunkUid;
+      m_chunkUid++;
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -690,6 +953,35 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_records != 0)
+    {
+      if (m_head == m_tail ||
+          m_records->m_records[m_head].tid != (uid >> 1) ||
+          m_records->m_records[m_head].size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected header.");
+            }
+          return;
+        }
+      else if (m_records->m_records[m_head].fragmentStart != 0 ||
+               m_records->m_records[m_head].fragmentEnd != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing incomplete header.");
+            }
+          return;
+        }
+      m_head++;
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -738,6 +1030,23 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_records != 0)
+    {
+      struct PacketMetadata::Record *record = AppendRecord ();
+      record->packetUid = m_packetUid;
+      record->size = size;
+      record->fragmentStart = 0;
+      record->fragmentEnd = size;
+      record->tid = uid >> 1;
+      record->chunkUid = m_chunkUid;
+      m_chunkUid++;
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -760,6 +1069,35 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_records != 0)
+    {
+      if (m_head == m_tail ||
+          m_records->m_records[m_tail - 1].tid != (uid >> 1) ||
+          m_records->m_records[m_tail - 1].size != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing unexpected trailer.");
+            }
+          return;
+        }
+      else if (m_records->m_records[m_tail - 1].fragmentStart != 0 ||
+               m_records->m_records[m_tail - 1].fragmentEnd != size)
+        {
+          if (m_enableChecking)
+            {
+              NS_FATAL_ERROR ("Removing incomplete trailer.");
+            }
+          return;
+        }
+      m_tail--;
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -807,6 +1145,57 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_data == 0 && m_records == 0)
+    {
+      // this packet does not carry metadata.
+      return;
+    }
+  if ((m_records != 0 && o.m_records == 0) ||
+      (m_data != 0 && o.m_data == 0))
+    {
+      /* The other packet does not carry metadata, or not in our
+       * layout, so we cannot describe the whole packet anymore.
+       */
+      Drop ();
+      return;
+    }
+  if (m_records != 0)
+    {
+      if (m_head == m_tail)
+        {
+          *this = o;
+          NS_ASSERT (IsStateOk ());
+          return;
+        }
+      // keep the records of o if o is *this.
+      PacketMetadata other = o;
+      uint16_t current = other.m_head;
+      if (current == other.m_tail)
+        {
+          return;
+        }
+      const struct PacketMetadata::Record &first = other.m_records->m_records[current];
+      const struct PacketMetadata::Record &tail = m_records->m_records[m_tail - 1];
+      if (first.packetUid == tail.packetUid &&
+          first.tid == tail.tid &&
+          first.chunkUid == tail.chunkUid &&
+          first.size == tail.size &&
+          first.fragmentStart == tail.fragmentEnd)
+        {
+          // merge our tail with the head of the other packet.
+          uint32_t fragmentEnd = first.fragmentEnd;
+          UnshareRecords ();
+          m_records->m_records[m_tail - 1].fragmentEnd = fragmentEnd;
+          current++;
+        }
+      for (; current < other.m_tail; current++)
+        {
+          struct PacketMetadata::Record record = other.m_records->m_records[current];
+          *AppendRecord () = record;
+        }
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -895,7 +1284,34 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
+  if (m_records != 0)
+    {
+      uint32_t leftToRemove = start;
+      while (m_head < m_tail && leftToRemove > 0)
+        {
+          const struct PacketMetadata::Record &record = m_records->m_records[m_head];
+          uint32_t itemRealSize = record.fragmentEnd - record.fragmentStart;
+          if (itemRealSize <= leftToRemove)
+            {
+              m_head++;
+              leftToRemove -= itemRealSize;
+            }
+          else
+            {
+              // fragment the record.
+              UnshareRecords ();
+              m_records->m_records[m_head].fragmentStart += leftToRemove;
+              leftToRemove = 0;
+            }
+        }
+      NS_ASSERT (leftToRemove == 0);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
   while (current != 0xffff && leftToRemove > 0)
@@ -921,7 +1337,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment = CreateLinked (m_packetUid);
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -958,7 +1374,34 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
-  NS_ASSERT (m_data != 0);
+  if (m_records != 0)
+    {
+      uint32_t leftToRemove = end;
+      while (m_head < m_tail && leftToRemove > 0)
+        {
+          const struct PacketMetadata::Record &record = m_records->m_records[m_tail - 1];
+          uint32_t itemRealSize = record.fragmentEnd - record.fragmentStart;
+          if (itemRealSize <= leftToRemove)
+            {
+              m_tail--;
+              leftToRemove -= itemRealSize;
+            }
+          else
+            {
+              // fragment the record.
+              UnshareRecords ();
+              m_records->m_records[m_tail - 1].fragmentEnd -= leftToRemove;
+              leftToRemove = 0;
+            }
+        }
+      NS_ASSERT (leftToRemove == 0);
+      NS_ASSERT (IsStateOk ());
+      return;
+    }
+  if (m_data == 0)
+    {
+      return;
+    }
 
   uint32_t leftToRemove = end;
   uint16_t current = m_tail;
@@ -985,7 +1428,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       else
         {
           // fragment the list item.
-          PacketMetadata fragment (m_packetUid, 0);
+          PacketMetadata fragment = CreateLinked (m_packetUid);
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1019,19 +1462,11 @@ PacketMetadata::GetTotalSize (void) const
   NS_LOG_FUNCTION (this);
   uint32_t totalSize = 0;
   uint16_t current = m_head;
-  uint16_t tail = m_tail;
-  while (current != 0xffff)
+  struct PacketMetadata::SmallItem item;
+  PacketMetadata::ExtraItem extraItem;
+  while (NextItem (current, &item, &extraItem))
     {
-      struct PacketMetadata::SmallItem item;
-      PacketMetadata::ExtraItem extraItem;
-      ReadItems (current, &item, &extraItem);
       totalSize += extraItem.fragmentEnd - extraItem.fragmentStart;
-      if (current == tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
   return totalSize;
 }
@@ -1052,8 +1487,7 @@ PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buff
   : m_metadata (metadata),
     m_buffer (buffer),
     m_current (metadata->m_head),
-    m_offset (0),
-    m_hasReadTail (false)
+    m_offset (0)
 {
   NS_LOG_FUNCTION (this << metadata << &buffer);
 }
@@ -1065,9 +1499,9 @@ PacketMetadata::ItemIterator::HasNext (void) const
     {
       return false;
     }
-  if (m_hasReadTail)
+  if (m_metadata->m_records != 0)
     {
-      return false;
+      return m_current < m_metadata->m_tail;
     }
   return true;
 }
@@ -1078,12 +1512,7 @@ PacketMetadata::ItemIterator::Next (void)
   struct PacketMetadata::Item item;
   struct PacketMetadata::SmallItem smallItem;
   struct PacketMetadata::ExtraItem extraItem;
-  m_metadata->ReadItems (m_current, &smallItem, &extraItem);
-  if (m_current == m_metadata->m_tail)
-    {
-      m_hasReadTail = true;
-    }
-  m_current = smallItem.next;
+  m_metadata->NextItem (m_current, &smallItem, &extraItem);
   uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
   item.tid.SetUid (uid);
   item.currentTrimedFromStart = extraItem.fragmentStart;
@@ -1148,10 +1577,9 @@ PacketMetadata::GetSerializedSize (void) const
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  uint16_t current = m_head;
+  while (NextItem (current, &item, &extraItem))
     {
-      ReadItems (current, &item, &extraItem);
       uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
       if (uid == 0)
         {
@@ -1164,12 +1592,6 @@ PacketMetadata::GetSerializedSize (void) const
           totalSize += 4 + tid.GetName ().size ();
         }
       totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-      if (current == m_tail)
-        {
-          break;
-        }
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
   return totalSize;
 }
@@ -1188,10 +1610,9 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
-  uint32_t current = m_head;
-  while (current != 0xffff)
+  uint16_t current = m_head;
+  while (NextItem (current, &item, &extraItem))
     {
-      ReadItems (current, &item, &extraItem);
       NS_LOG_LOGIC ("bytesWritten=" << static_cast<uint32_t> (buffer - start) << ", typeUid="<<
                     item.typeUid << ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
                     ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
@@ -1261,14 +1682,6 @@ PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
         {
           return 0;
         }
-
-      if (current == m_tail)
-        {
-          break;
-        }
-
-      NS_ASSERT (current != item.next);
-      current = item.next;
     }
 
   NS_ASSERT (static_cast<uint32_t> (buffer - start) == maxSize);
@@ -1284,6 +1697,11 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 
   buffer = ReadFromRawU64 (m_packetUid, start, buffer, size);
   desSize -= 8;
+  if (!IsSampled (m_packetUid))
+    {
+      Drop ();
+      return 1;
+    }
 
   struct PacketMetadata::SmallItem item = {0};
   struct PacketMetadata::ExtraItem extraItem = {0};
@@ -1329,6 +1747,17 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
                     ", size="<<item.size<<", chunkUid="<<item.chunkUid<<
                     ", fragmentStart="<<extraItem.fragmentStart<<", fragmentEnd="<<
                     extraItem.fragmentEnd<< ", packetUid="<<extraItem.packetUid);
+      if (m_records != 0)
+        {
+          struct PacketMetadata::Record *record = AppendRecord ();
+          record->packetUid = extraItem.packetUid;
+          record->size = item.size;
+          record->fragmentStart = extraItem.fragmentStart;
+          record->fragmentEnd = extraItem.fragmentEnd;
+          record->tid = uid;
+          record->chunkUid = item.chunkUid;
+          continue;
+        }
       uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
       UpdateTail (tmp);
     }
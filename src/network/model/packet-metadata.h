@@ -74,6 +74,19 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * If the "PacketMetadataCompact" global value is set when the metadata
+ * is enabled, the items of the packets created afterwards are stored
+ * instead as fixed-size records, in order, in an array shared by the
+ * copies of the packet (struct PacketMetadata::Records).  The array
+ * keeps free room before the first record and after the last one, so
+ * that adding a header or a trailer only writes a record, and removing
+ * one only moves an index.
+ *
+ * If the "PacketMetadataSampling" global value is set to N > 1 when the
+ * metadata is enabled, only the packets whose uid is a multiple of N
+ * carry metadata: the other packets print nothing.  A packet made of
+ * the bytes of packets with and without metadata has no metadata.
  */
 class PacketMetadata 
 {
@@ -149,11 +162,15 @@ private:
     Buffer m_buffer; //!< buffer the metadata refers to
     uint16_t m_current; //!< current position
     uint32_t m_offset; //!< offset
-    bool m_hasReadTail; //!< true if the metadata tail has been read
   };
 
   /**
    * \brief Enable the packet metadata
+   *
+   * The layout of the metadata and the sampling of the packets which
+   * carry it are read from the "PacketMetadataCompact" and
+   * "PacketMetadataSampling" global values, and apply to the packets
+   * created afterwards.
    */
   static void Enable (void);
   /**
@@ -494,6 +511,55 @@ private:
     uint64_t packetUid;
   };
 
+  /**
+   * \brief A header, trailer or payload in the compact layout
+   */
+  struct Record {
+    /** the packetUid of the packet in which this header or trailer
+       was first added. */
+    uint64_t packetUid;
+    /** the size (in bytes) of the whole header or trailer */
+    uint32_t size;
+    /** offset (in bytes) from start of original header to
+       the start of the fragment still present. */
+    uint32_t fragmentStart;
+    /** offset (in bytes) from start of original header to
+       the end of the fragment still present. */
+    uint32_t fragmentEnd;
+    /** the uid of the TypeId of the header or trailer; zero
+       represents payload. */
+    uint16_t tid;
+    /** the chunkUid of the header or trailer instance, as in
+       SmallItem. */
+    uint16_t chunkUid;
+  };
+
+  /**
+   * \brief The records of the compact layout
+   *
+   * The records are shared by the copies of a packet, which each use
+   * the range [m_head, m_tail) of the array.
+   */
+  struct Records {
+    /** number of references to this struct Records instance. */
+    uint32_t m_count;
+    /** number of records in m_records below */
+    uint16_t m_size;
+    /** min of the m_head field over all objects which
+       reference this struct Records instance */
+    uint16_t m_dirtyStart;
+    /** max of the m_tail field over all objects which
+       reference this struct Records instance */
+    uint16_t m_dirtyEnd;
+    /** variable-sized array of records */
+    Record m_records[1];
+  };
+
+  /// The number of records of a new struct Records.
+  static const uint16_t RECORDS_SIZE = 12;
+  /// The number of free records before the first one of a new packet.
+  static const uint16_t RECORDS_HEADROOM = 8;
+
   /**
    * \brief Class to hold all the metadata
    */
@@ -503,11 +569,101 @@ public:
     ~DataFreeList ();
   };
 
+  /**
+   * \brief Class to hold the unused struct Records
+   */
+  class RecordsFreeList : public std::vector<struct Records *>
+  {
+public:
+    ~RecordsFreeList ();
+  };
+
   friend DataFreeList::~DataFreeList ();
+  friend RecordsFreeList::~RecordsFreeList ();
   /// Friend class
   friend class ItemIterator;
 
+  /**
+   * \brief Constructor of the metadata of a packet without items, in
+   * the linked list layout, whatever the layout of the new packets.
+   */
   PacketMetadata ();
+  /**
+   * \brief Create the metadata of a packet without items, in the
+   * linked list layout.
+   * \param uid packet uid
+   * \returns the metadata
+   */
+  static PacketMetadata CreateLinked (uint64_t uid);
+
+  /**
+   * \brief Check if a packet carries metadata
+   * \param uid packet uid
+   * \returns true if the packet is sampled
+   */
+  static inline bool IsSampled (uint64_t uid);
+  /**
+   * \brief Drop the metadata of this packet
+   */
+  void Drop (void);
+
+  /**
+   * \brief Read an item and move to the next one
+   *
+   * This reads the items of both layouts.
+   *
+   * \param [in,out] current the position of the item, updated to the
+   *        position of the next one
+   * \param item pointer to where we should store the data to return to the caller
+   * \param extraItem pointer to where we should store the data to return to the caller
+   * \returns false if there is no item at current.
+   */
+  bool NextItem (uint16_t &current,
+                 struct PacketMetadata::SmallItem *item,
+                 struct PacketMetadata::ExtraItem *extraItem) const;
+
+  /**
+   * \brief Get a free record before the first one
+   *
+   * The first record of the packet is the returned one.
+   *
+   * \returns the record
+   */
+  struct Record *PrependRecord (void);
+  /**
+   * \brief Get a free record after the last one
+   *
+   * The last record of the packet is the returned one.
+   *
+   * \returns the record
+   */
+  struct Record *AppendRecord (void);
+  /**
+   * \brief Make sure that the records are not shared, before they are
+   * changed in place
+   */
+  void UnshareRecords (void);
+  /**
+   * \brief Copy the records to a new array, with free room before and
+   * after them
+   */
+  void ReserveRecords (void);
+  /**
+   * \brief Create a struct Records
+   * \param size the number of records
+   * \returns the struct Records
+   */
+  static struct PacketMetadata::Records *CreateRecords (uint16_t size);
+  /**
+   * \brief Release a reference to a struct Records
+   * \param records the struct Records
+   */
+  static inline void ReleaseRecords (struct PacketMetadata::Records *records);
+  /**
+   * \brief Recycle an unused struct Records
+   * \param records the struct Records
+   */
+  static void RecycleRecords (struct PacketMetadata::Records *records);
 
   /**
    * \brief Add a SmallItem
@@ -661,25 +817,39 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage
+  /// Set when m_freeList of the calling thread has been destroyed
+  static thread_local bool m_freeListDestroyed;
+  static thread_local RecordsFreeList m_recordsFreeList; //!< the unused struct Records
+  /// Set when m_recordsFreeList of the calling thread has been destroyed
+  static thread_local bool m_recordsFreeListDestroyed;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
+  static bool m_compact; //!< Store the metadata of the new packets as records
+  static uint32_t m_sampling; //!< Only 1 in m_sampling packets carry metadata
 
   /**
    * Set to true when adding metadata to a packet is skipped because
    * m_enable is false; used to detect enabling of metadata in the
    * middle of a simulation, which isn't allowed.
    */
-  static bool m_metadataSkipped;
+  static thread_local bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
 
-  struct Data *m_data; //!< Metadata storage
+  /// Metadata storage in the linked list layout, or zero
+  struct Data *m_data;
+  /// Metadata storage in the compact layout, or zero
+  struct Records *m_records;
   /*
      head -(next)-> tail
        ^             |
         \---(prev)---|
+
+     In the compact layout, the records of the packet are
+     [m_head, m_tail).  A packet without metadata has
+     m_head == m_tail == 0xffff and no storage.
    */
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
@@ -691,14 +861,47 @@ public:
 
 namespace ns3 {
 
+bool
+PacketMetadata::IsSampled (uint64_t uid)
+{
+  return m_sampling <= 1 || uid % m_sampling == 0;
+}
+
+void
+PacketMetadata::ReleaseRecords (struct PacketMetadata::Records *records)
+{
+  records->m_count--;
+  if (records->m_count == 0)
+    {
+      PacketMetadata::RecycleRecords (records);
+    }
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
-  : m_data (PacketMetadata::Create (10)),
+  : m_data (0),
+    m_records (0),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
     m_packetUid (uid)
 {
-  memset (m_data->m_data, 0xff, 4);
+  if (!IsSampled (uid))
+    {
+      return;
+    }
+  if (m_compact)
+    {
+      m_records = PacketMetadata::CreateRecords (RECORDS_SIZE);
+      m_head = RECORDS_HEADROOM;
+      m_tail = RECORDS_HEADROOM;
+      m_records->m_dirtyStart = m_head;
+      m_records->m_dirtyEnd = m_tail;
+    }
+  else
+    {
+      m_data = PacketMetadata::Create (10);
+      memset (m_data->m_data, 0xff, 4);
+    }
   if (size > 0)
     {
       DoAddHeader (0, size);
@@ -706,14 +909,22 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
 }
 PacketMetadata::PacketMetadata (PacketMetadata const &o)
   : m_data (o.m_data),
+    m_records (o.m_records),
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
     m_packetUid (o.m_packetUid)
 {
-  NS_ASSERT (m_data != 0);
-  NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
-  m_data->m_count++;
+  if (m_data != 0)
+    {
+      NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
+      m_data->m_count++;
+    }
+  if (m_records != 0)
+    {
+      NS_ASSERT (m_records->m_count < std::numeric_limits<uint32_t>::max());
+      m_records->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -721,15 +932,31 @@ PacketMetadata::operator = (PacketMetadata const& o)
   if (m_data != o.m_data) 
     {
       // not self assignment
-      NS_ASSERT (m_data != 0);
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (m_data != 0)
         {
-          PacketMetadata::Recycle (m_data);
+          m_data->m_count--;
+          if (m_data->m_count == 0) 
+            {
+              PacketMetadata::Recycle (m_data);
+            }
         }
       m_data = o.m_data;
-      NS_ASSERT (m_data != 0);
-      m_data->m_count++;
+      if (m_data != 0)
+        {
+          m_data->m_count++;
+        }
+    }
+  if (m_records != o.m_records)
+    {
+      if (m_records != 0)
+        {
+          PacketMetadata::ReleaseRecords (m_records);
+        }
+      m_records = o.m_records;
+      if (m_records != 0)
+        {
+          m_records->m_count++;
+        }
     }
   m_head = o.m_head;
   m_tail = o.m_tail;
@@ -739,11 +966,17 @@ PacketMetadata::operator = (PacketMetadata const& o)
 }
 PacketMetadata::~PacketMetadata ()
 {
-  NS_ASSERT (m_data != 0);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (m_data != 0)
+    {
+      m_data->m_count--;
+      if (m_data->m_count == 0) 
+        {
+          PacketMetadata::Recycle (m_data);
+        }
+    }
+  if (m_records != 0)
     {
-      PacketMetadata::Recycle (m_data);
+      PacketMetadata::ReleaseRecords (m_records);
     }
 }
 
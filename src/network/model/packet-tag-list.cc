@@ -44,13 +44,33 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
   void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  // The matching frees are in RemoveAll and FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+PacketTagList::TagData *
+PacketTagList::CreateInlineTagData (size_t dataSize)
+{
+  if (sizeof (TagData) + dataSize - 1 > INLINE_TAG_SIZE)
+    {
+      return 0;
+    }
+  for (uint32_t slot = 0; slot < INLINE_TAGS; slot++)
+    {
+      if ((m_inlineUsed & (1U << slot)) == 0)
+        {
+          m_inlineUsed |= 1U << slot;
+          TagData * tag = new (&m_inline[slot]) TagData;
+          tag->size = dataSize;
+          return tag;
+        }
+    }
+  return 0;
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -194,8 +214,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      FreeTagData (cur);
     }
   else
     {
@@ -266,14 +285,29 @@ PacketTagList::Add (const Tag &tag) const
       NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
                      "Error: cannot add the same kind of tag twice.");
     }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
+  PacketTagList *list = const_cast<PacketTagList *> (this);
+  uint32_t size = tag.GetSerializedSize ();
+  struct TagData * head = list->CreateInlineTagData (size);
+  if (head != 0)
+    {
+      head->next = m_next;
+      list->m_next = head;
+    }
+  else
+    {
+      // the tags on the heap go after the inline ones
+      struct TagData ** prevNext = &list->m_next;
+      while (*prevNext != 0 && IsInline (*prevNext))
+        {
+          prevNext = &(*prevNext)->next;
+        }
+      head = CreateTagData (size);
+      head->next = *prevNext;
+      *prevNext = head;
+    }
   head->count = 1;
-  head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
 }
 
 bool
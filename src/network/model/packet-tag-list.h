@@ -26,7 +26,10 @@
 */
 
 #include <stdint.h>
+#include <cstring>
+#include <new>
 #include <ostream>
+#include <type_traits>
 #include "ns3/type-id.h"
 
 namespace ns3 {
@@ -119,6 +122,20 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Inline tags </b>
+ *
+ *   - The first #INLINE_TAGS tags whose TagData fits in #INLINE_TAG_SIZE
+ *     bytes are stored in the PacketTagList itself rather than in the
+ *     heap, so that most packets never allocate a TagData.
+ *
+ *   - The inline TagData are never shared: they always come first
+ *     in the list, before the tree of TagData on the heap, which never
+ *     points back to them.  #Add prepends the inline tags, and inserts
+ *     the others after the inline ones.
+ *
+ *   - Copy constructor and assignment copy the inline TagData, then join
+ *     the tree at the same place as the original for the remaining ones.
  */
 class PacketTagList 
 {
@@ -218,7 +235,41 @@ public:
    */
   const struct PacketTagList::TagData *Head (void) const;
 
+  /// The number of tags stored inline.
+  static const uint32_t INLINE_TAGS = 3;
+  /// The size of an inline TagData, including its data.
+  static const uint32_t INLINE_TAG_SIZE = 48;
+
 private:
+  /// Storage of an inline TagData.
+  typedef std::aligned_storage<INLINE_TAG_SIZE, alignof (TagData)>::type InlineSlot;
+
+  /**
+   * \param [in] data A TagData of this list.
+   * \returns True if \pname{data} is stored inline.
+   */
+  inline bool IsInline (const struct TagData *data) const;
+  /**
+   * Construct a TagData in a free inline slot.
+   *
+   * \param [in] dataSize The serialized size of the Tag.
+   * \returns The newly constructed TagData object, or zero if there is
+   *          no free slot or the data don't fit in one.
+   */
+  TagData * CreateInlineTagData (size_t dataSize);
+  /**
+   * Destroy a TagData, and free its memory or its inline slot.
+   *
+   * \param [in] data The TagData to free.
+   */
+  inline void FreeTagData (struct TagData *data);
+  /**
+   * Copy the inline tags and join the tree of another list.
+   *
+   * \param [in] o The PacketTagList to copy.
+   */
+  inline void CopyFrom (PacketTagList const &o);
+
   /**
    * Allocate and construct a TagData struct, sizing the data area
    * large enough to serialize dataSize bytes from a Tag.
@@ -282,6 +333,10 @@ private:
    * Pointer to first \ref TagData on the list
    */
   struct TagData *m_next;
+  /// Bit i is set if inline slot i holds a TagData.
+  uint32_t m_inlineUsed;
+  /// Storage of the inline TagData.
+  InlineSlot m_inline[INLINE_TAGS];
 };
 
 } // namespace ns3
@@ -293,33 +348,28 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_next (),
+    m_inlineUsed (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_next (),
+    m_inlineUsed (0)
 {
-  if (m_next != 0)
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
 }
 
 PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
-    {
-      m_next->count++;
-    }
+  CopyFrom (o);
   return *this;
 }
 
@@ -328,11 +378,67 @@ PacketTagList::~PacketTagList ()
   RemoveAll ();
 }
 
+bool
+PacketTagList::IsInline (const struct TagData *data) const
+{
+  const void *p = data;
+  return p >= static_cast<const void *> (&m_inline[0])
+         && p < static_cast<const void *> (&m_inline[INLINE_TAGS]);
+}
+
+void
+PacketTagList::FreeTagData (struct TagData *data)
+{
+  if (IsInline (data))
+    {
+      std::ptrdiff_t slot = reinterpret_cast<InlineSlot *> (data) - m_inline;
+      data->~TagData ();
+      m_inlineUsed &= ~(1U << slot);
+    }
+  else
+    {
+      data->~TagData ();
+      std::free (data);
+    }
+}
+
+void
+PacketTagList::CopyFrom (PacketTagList const &o)
+{
+  struct TagData **prevNext = &m_next;
+  struct TagData *cur = o.m_next;
+  for (; cur != 0 && o.IsInline (cur); cur = cur->next)
+    {
+      void *slot = &m_inline[reinterpret_cast<const InlineSlot *> (cur) - o.m_inline];
+      struct TagData *copy = new (slot) TagData;
+      copy->count = 1;
+      copy->tid = cur->tid;
+      copy->size = cur->size;
+      std::memcpy (copy->data, cur->data, cur->size);
+      *prevNext = copy;
+      prevNext = &copy->next;
+    }
+  m_inlineUsed = o.m_inlineUsed;
+  *prevNext = cur;
+  if (cur != 0)
+    {
+      cur->count++;
+    }
+}
+
 void
 PacketTagList::RemoveAll (void)
 {
+  // the inline tags, which are not shared
+  struct TagData *cur = m_next;
+  while (cur != 0 && IsInline (cur))
+    {
+      struct TagData *next = cur->next;
+      FreeTagData (cur);
+      cur = next;
+    }
   struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
+  for (; cur != 0; cur = cur->next)
     {
       cur->count--;
       if (cur->count > 0) 
@@ -21,6 +21,9 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/global-value.h"
 #include <string>
 #include <cstdarg>
 
@@ -28,7 +31,8 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_globalUid = 0;
+bool Packet::m_enableHeaderCache = false;
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -146,7 +150,8 @@ Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
-    m_metadata (o.m_metadata)
+    m_metadata (o.m_metadata),
+    m_headerCache (o.m_headerCache)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
     : m_nixVector = 0;
@@ -165,6 +170,7 @@ Packet::operator = (const Packet &o)
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
+  m_headerCache = o.m_headerCache;
   return *this;
 }
 
@@ -262,6 +268,10 @@ Packet::AddHeader (const Header &header)
   m_byteTagList.AddAtStart (size);
   header.Serialize (m_buffer.Begin ());
   m_metadata.AddHeader (header, size);
+  if (m_headerCache != 0)
+    {
+      HeaderCacheAddAtStart (size);
+    }
 }
 uint32_t
 Packet::RemoveHeader (Header &header, uint32_t size)
@@ -271,9 +281,7 @@ Packet::RemoveHeader (Header &header, uint32_t size)
   end.Next (size);
   uint32_t deserialized = header.Deserialize (m_buffer.Begin (), end);
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  DoRemoveHeader (header, deserialized);
   return deserialized;
 }
 uint32_t
@@ -281,11 +289,20 @@ Packet::RemoveHeader (Header &header)
 {
   uint32_t deserialized = header.Deserialize (m_buffer.Begin ());
   NS_LOG_FUNCTION (this << header.GetInstanceTypeId ().GetName () << deserialized);
-  m_buffer.RemoveAtStart (deserialized);
-  m_byteTagList.Adjust (-deserialized);
-  m_metadata.RemoveHeader (header, deserialized);
+  DoRemoveHeader (header, deserialized);
   return deserialized;
 }
+void
+Packet::DoRemoveHeader (const Header &header, uint32_t size)
+{
+  m_buffer.RemoveAtStart (size);
+  m_byteTagList.Adjust (-size);
+  m_metadata.RemoveHeader (header, size);
+  if (m_headerCache != 0)
+    {
+      HeaderCacheRemoveAtStart (size);
+    }
+}
 uint32_t
 Packet::PeekHeader (Header &header) const
 {
@@ -313,6 +330,7 @@ Packet::AddTrailer (const Trailer &trailer)
   Buffer::Iterator end = m_buffer.End ();
   trailer.Serialize (end);
   m_metadata.AddTrailer (trailer, size);
+  m_headerCache = 0;
 }
 uint32_t
 Packet::RemoveTrailer (Trailer &trailer)
@@ -321,6 +339,7 @@ Packet::RemoveTrailer (Trailer &trailer)
   NS_LOG_FUNCTION (this << trailer.GetInstanceTypeId ().GetName () << deserialized);
   m_buffer.RemoveAtEnd (deserialized);
   m_metadata.RemoveTrailer (trailer, deserialized);
+  m_headerCache = 0;
   return deserialized;
 }
 uint32_t
@@ -342,6 +361,7 @@ Packet::AddAtEnd (Ptr<const Packet> packet)
   m_byteTagList.Add (copy);
   m_buffer.AddAtEnd (packet->m_buffer);
   m_metadata.AddAtEnd (packet->m_metadata);
+  m_headerCache = 0;
 }
 void
 Packet::AddPaddingAtEnd (uint32_t size)
@@ -350,6 +370,7 @@ Packet::AddPaddingAtEnd (uint32_t size)
   m_byteTagList.AddAtEnd (GetSize ());
   m_buffer.AddAtEnd (size);
   m_metadata.AddPaddingAtEnd (size);
+  m_headerCache = 0;
 }
 void 
 Packet::RemoveAtEnd (uint32_t size)
@@ -357,6 +378,7 @@ Packet::RemoveAtEnd (uint32_t size)
   NS_LOG_FUNCTION (this << size);
   m_buffer.RemoveAtEnd (size);
   m_metadata.RemoveAtEnd (size);
+  m_headerCache = 0;
 }
 void 
 Packet::RemoveAtStart (uint32_t size)
@@ -365,6 +387,32 @@ Packet::RemoveAtStart (uint32_t size)
   m_buffer.RemoveAtStart (size);
   m_byteTagList.Adjust (-size);
   m_metadata.RemoveAtStart (size);
+  if (m_headerCache != 0)
+    {
+      HeaderCacheRemoveAtStart (size);
+    }
+}
+
+void
+Packet::HeaderCacheAddAtStart (uint32_t size)
+{
+  if (m_headerCache->GetReferenceCount () > 1)
+    {
+      // shared with the copies of this packet, which keep the old bytes
+      m_headerCache = Create<HeaderCache> (*m_headerCache);
+    }
+  m_headerCache->AddAtStart (size);
+}
+
+void
+Packet::HeaderCacheRemoveAtStart (uint32_t size)
+{
+  if (m_headerCache->GetReferenceCount () > 1)
+    {
+      // shared with the copies of this packet, which keep the old bytes
+      m_headerCache = Create<HeaderCache> (*m_headerCache);
+    }
+  m_headerCache->RemoveAtStart (size);
 }
 
 void 
@@ -582,6 +630,17 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableHeaderCache (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  BooleanValue checksumEnabled;
+  GlobalValue::GetValueByName ("ChecksumEnabled", checksumEnabled);
+  NS_ABORT_MSG_IF (checksumEnabled.Get (),
+                   "The header cache can't be enabled with ChecksumEnabled");
+  m_enableHeaderCache = true;
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
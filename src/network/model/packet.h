@@ -29,11 +29,13 @@
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
 #include "nix-vector.h"
+#include "header-cache.h"
 #include "ns3/mac48-address.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#include <type_traits>
 
 namespace ns3 {
 
@@ -356,6 +358,41 @@ public:
    * \returns the number of bytes read from the packet.
    */
   uint32_t PeekHeader (Header &header, uint32_t size) const;
+  /**
+   * \brief Deserialize and remove the header from the internal buffer,
+   * through the header cache.
+   *
+   * This overload is selected for the concrete header classes.  When
+   * the header cache is enabled, it returns the copy of the header
+   * deserialized by a previous PeekHeader, if any, rather than
+   * invoke Header::Deserialize again.
+   *
+   * \param header a reference to the header to remove from the internal buffer.
+   * \returns the number of bytes removed from the packet.
+   *
+   * \sa EnableHeaderCache
+   */
+  template <typename T>
+  typename std::enable_if<!std::is_abstract<T>::value, uint32_t>::type
+  RemoveHeader (T &header);
+  /**
+   * \brief Deserialize but does _not_ remove the header from the
+   * internal buffer, through the header cache.
+   *
+   * This overload is selected for the concrete header classes.  When
+   * the header cache is enabled, it returns the copy of the header
+   * deserialized by a previous PeekHeader, if any, rather than
+   * invoke Header::Deserialize again, and keeps a copy of the
+   * headers it deserializes.
+   *
+   * \param header a reference to the header to read from the internal buffer.
+   * \returns the number of bytes read from the packet.
+   *
+   * \sa EnableHeaderCache
+   */
+  template <typename T>
+  typename std::enable_if<!std::is_abstract<T>::value, uint32_t>::type
+  PeekHeader (T &header) const;
   /**
    * \brief Add trailer to this packet.
    *
@@ -530,6 +567,28 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable the header cache.
+   *
+   * By default, each PeekHeader and RemoveHeader deserializes the
+   * header from the packet buffer, even when another layer has
+   * already peeked at the same header of the same packet, as the
+   * IPv4, TCP and flow monitor layers do.  With the header cache,
+   * a packet and its copies keep the headers deserialized by
+   * PeekHeader (see HeaderCache), and the next PeekHeader or
+   * RemoveHeader of a header of the same type at the same offset
+   * gets a copy of it.
+   *
+   * A copy is only equivalent to a new deserialization if
+   * Header::Deserialize depends on nothing but the bytes of the
+   * packet.  The IPv4, TCP and UDP headers also verify their checksum
+   * against state set before their deserialization: the cache can't
+   * be enabled if the "ChecksumEnabled" global value is set.
+   *
+   * This method must be called during the simulation setup, before
+   * any packet is created.
+   */
+  static void EnableHeaderCache (void);
 
   /**
    * \brief Returns number of bytes required for packet
@@ -748,6 +807,25 @@ private:
    */
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
+  /**
+   * \brief Remove a header already deserialized.
+   * \param [in] header the header
+   * \param [in] size the number of bytes of the header
+   */
+  void DoRemoveHeader (const Header &header, uint32_t size);
+  /**
+   * \brief Move the entries of the header cache after bytes were
+   * added at the start of the packet.
+   * \param [in] size the number of bytes added
+   */
+  void HeaderCacheAddAtStart (uint32_t size);
+  /**
+   * \brief Move the entries of the header cache after bytes were
+   * removed from the start of the packet.
+   * \param [in] size the number of bytes removed
+   */
+  void HeaderCacheRemoveAtStart (uint32_t size);
+
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
@@ -756,7 +834,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /// The headers already deserialized from the buffer, or zero
+  mutable Ptr<HeaderCache> m_headerCache;
+
+  static thread_local uint32_t m_globalUid; //!< Per-thread counter of packets Uid
+  static bool m_enableHeaderCache; //!< Enable the header cache
 };
 
 /**
@@ -823,6 +905,45 @@ Packet::GetSize (void) const
   return m_buffer.GetSize ();
 }
 
+template <typename T>
+typename std::enable_if<!std::is_abstract<T>::value, uint32_t>::type
+Packet::RemoveHeader (T &header)
+{
+  uint32_t size;
+  if (m_headerCache == 0
+      || static_cast<const Header &> (header).GetInstanceTypeId () != T::GetTypeId ()
+      || !m_headerCache->Peek (header, size))
+    {
+      return RemoveHeader (static_cast<Header &> (header));
+    }
+  DoRemoveHeader (header, size);
+  return size;
+}
+
+template <typename T>
+typename std::enable_if<!std::is_abstract<T>::value, uint32_t>::type
+Packet::PeekHeader (T &header) const
+{
+  // A header of a derived class without its own TypeId would be
+  // sliced by the copy: deserialize it.
+  if (!m_enableHeaderCache || static_cast<const Header &> (header).GetInstanceTypeId () != T::GetTypeId ())
+    {
+      return PeekHeader (static_cast<Header &> (header));
+    }
+  uint32_t size;
+  if (m_headerCache != 0 && m_headerCache->Peek (header, size))
+    {
+      return size;
+    }
+  size = PeekHeader (static_cast<Header &> (header));
+  if (m_headerCache == 0)
+    {
+      m_headerCache = Create<HeaderCache> ();
+    }
+  m_headerCache->Insert (header, size);
+  return size;
+}
+
 } // namespace ns3
 
 #endif /* PACKET_H */
@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <sstream>
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/trace-helper.h"
+#include "ns3/binary-trace-stream-wrapper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the decoded binary trace is the ascii
+ * trace the default sinks write.
+ */
+class BinaryTraceDecodeTestCase : public TestCase
+{
+public:
+  BinaryTraceDecodeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Fire every default sink with a packet, on both streams.
+   * \param context the context of the sinks which take one
+   * \param p the packet
+   */
+  void FireSinks (std::string context, Ptr<const Packet> p);
+
+  Ptr<OutputStreamWrapper> m_ascii;  //!< The ascii trace
+  Ptr<OutputStreamWrapper> m_binary; //!< The binary trace
+};
+
+BinaryTraceDecodeTestCase::BinaryTraceDecodeTestCase ()
+  : TestCase ("Check that BinaryTraceStreamWrapper::Decode regenerates the ascii trace")
+{
+}
+
+void
+BinaryTraceDecodeTestCase::FireSinks (std::string context, Ptr<const Packet> p)
+{
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      Ptr<OutputStreamWrapper> stream = i ? m_binary : m_ascii;
+      AsciiTraceHelper::DefaultEnqueueSinkWithContext (stream, context, p);
+      AsciiTraceHelper::DefaultDequeueSinkWithContext (stream, context, p);
+      AsciiTraceHelper::DefaultDropSinkWithContext (stream, context, p);
+      AsciiTraceHelper::DefaultReceiveSinkWithContext (stream, context, p);
+      AsciiTraceHelper::DefaultEnqueueSinkWithoutContext (stream, p);
+      AsciiTraceHelper::DefaultDequeueSinkWithoutContext (stream, p);
+      AsciiTraceHelper::DefaultDropSinkWithoutContext (stream, p);
+      AsciiTraceHelper::DefaultReceiveSinkWithoutContext (stream, p);
+    }
+}
+
+void
+BinaryTraceDecodeTestCase::DoRun (void)
+{
+  Packet::EnablePrinting ();
+
+  std::ostringstream ascii;
+  std::stringstream binary;
+  m_ascii = Create<OutputStreamWrapper> (&ascii);
+  m_binary = Create<BinaryTraceStreamWrapper> (&binary);
+
+  std::string context1 = "/NodeList/3/DeviceList/1/$ns3::CsmaNetDevice/TxQueue/Enqueue";
+  std::string context2 = "/NodeList/0/DeviceList/0/$ns3::CsmaNetDevice/MacRx";
+
+  Ptr<Packet> p = Create<Packet> (100);
+  EthernetHeader header;
+  header.SetLengthType (0x800);
+  p->AddHeader (header);
+  Ptr<Packet> fragment = p->CreateFragment (10, 50);
+  Ptr<Packet> payload = Create<Packet> (1000);
+
+  Simulator::Schedule (Seconds (1.5), &BinaryTraceDecodeTestCase::FireSinks, this, context1, p);
+  Simulator::Schedule (MicroSeconds (2000001), &BinaryTraceDecodeTestCase::FireSinks, this, context2, fragment);
+  Simulator::Schedule (Seconds (3), &BinaryTraceDecodeTestCase::FireSinks, this, context1, payload);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_ascii = 0;
+  m_binary = 0;
+
+  std::string trace = binary.str ();
+  NS_TEST_EXPECT_MSG_EQ (trace.find (context1), trace.rfind (context1), "Context written more than once");
+
+  std::istringstream is (trace);
+  std::ostringstream decoded;
+  NS_TEST_ASSERT_MSG_EQ (BinaryTraceStreamWrapper::Decode (is, decoded), true, "Decode failed");
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), ascii.str (), "Decoded trace differs from the ascii trace");
+
+  std::istringstream truncated (trace.substr (0, trace.size () - 3));
+  std::ostringstream ignored;
+  NS_TEST_EXPECT_MSG_EQ (BinaryTraceStreamWrapper::Decode (truncated, ignored), false,
+                         "Decode accepted a truncated trace");
+
+  std::istringstream text (ascii.str ());
+  NS_TEST_EXPECT_MSG_EQ (BinaryTraceStreamWrapper::Decode (text, ignored), false,
+                         "Decode accepted an ascii trace");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Binary ascii trace TestSuite
+ */
+class BinaryTraceTestSuite : public TestSuite
+{
+public:
+  BinaryTraceTestSuite ();
+};
+
+BinaryTraceTestSuite::BinaryTraceTestSuite ()
+  : TestSuite ("binary-trace", UNIT)
+{
+  AddTestCase (new BinaryTraceDecodeTestCase, TestCase::QUICK);
+}
+
+static BinaryTraceTestSuite g_binaryTraceTestSuite; //!< Static variable for test initialization
@@ -378,6 +378,166 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer data pool unit tests.
+ */
+class BufferPoolTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferPoolTest ();
+};
+
+BufferPoolTest::BufferPoolTest ()
+  : TestCase ("Buffer data pool") {
+}
+
+void
+BufferPoolTest::DoRun (void)
+{
+  Buffer::PoolStats initial = Buffer::GetPoolStats ();
+  Buffer::SetPoolMaxBytes (1 << 20);
+
+  // Mixed sizes, as with ACKs, data packets and aggregates: after the
+  // first round, all the sizes are served from the pool.
+  Buffer::PoolStats before = Buffer::GetPoolStats ();
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Buffer ack;
+      ack.AddAtEnd (40);
+      Buffer data;
+      data.AddAtEnd (1400);
+      Buffer aggregate;
+      aggregate.AddAtEnd (7900);
+    }
+  Buffer::PoolStats after = Buffer::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_LT (after.misses - before.misses, 10, "Mixed sizes not reused");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (after.hits - before.hits, 297, "Mixed sizes not reused");
+  NS_TEST_EXPECT_MSG_GT (after.bytesHeld, 0, "Nothing held in the pool");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (after.bytesHeld, after.maxBytes, "Limit exceeded");
+
+  // Data above the largest size class bypasses the pool.
+  before = after;
+  {
+    Buffer jumbo;
+    jumbo.AddAtEnd (100000);
+  }
+  after = Buffer::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.releases - before.releases, 1, "Large data held in the pool");
+  NS_TEST_EXPECT_MSG_EQ (after.bytesHeld, before.bytesHeld, "Large data held in the pool");
+
+  // Lowering the limit releases the excess, and stops the recycling.
+  Buffer::SetPoolMaxBytes (0);
+  after = Buffer::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.bytesHeld, 0, "Pool not trimmed");
+  NS_TEST_EXPECT_MSG_GT (after.releases, before.releases + 1, "Pool not trimmed");
+  {
+    Buffer data;
+    data.AddAtEnd (1400);
+  }
+  after = Buffer::GetPoolStats ();
+  NS_TEST_EXPECT_MSG_EQ (after.bytesHeld, 0, "Limit exceeded");
+  NS_TEST_EXPECT_MSG_EQ (after.maxBytes, 0, "Wrong limit");
+
+  Buffer::SetPoolMaxBytes (initial.maxBytes);
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer Internet checksum unit tests.
+ */
+class BufferChecksumTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferChecksumTest ();
+private:
+  /**
+   * Calculate a checksum one word at a time.
+   * \param i the iterator to read from
+   * \param size the number of bytes to read
+   * \return the checksum
+   */
+  uint16_t Reference (Buffer::Iterator i, uint32_t size);
+};
+
+BufferChecksumTest::BufferChecksumTest ()
+  : TestCase ("Buffer Internet checksum") {
+}
+
+uint16_t
+BufferChecksumTest::Reference (Buffer::Iterator i, uint32_t size)
+{
+  uint32_t sum = 0;
+  for (uint32_t j = 0; j < size / 2; j++)
+    {
+      sum += i.ReadU16 ();
+    }
+  if (size & 1)
+    {
+      sum += i.ReadU8 ();
+    }
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return ~sum;
+}
+
+void
+BufferChecksumTest::DoRun (void)
+{
+  Ptr<UniformRandomVariable> bytesRng = CreateObject<UniformRandomVariable> ();
+  bytesRng->SetAttribute ("Min", DoubleValue (0));
+  bytesRng->SetAttribute ("Max", DoubleValue (256));
+
+  // A virtual zero area of 300 bytes between 1000 random bytes on each side
+  Buffer buffer (300);
+  buffer.AddAtStart (1000);
+  buffer.AddAtEnd (1000);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      i.WriteU8 (static_cast<uint8_t> (bytesRng->GetValue ()));
+    }
+  i = buffer.End ();
+  i.Prev (1000);
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      i.WriteU8 (static_cast<uint8_t> (bytesRng->GetValue ()));
+    }
+
+  // Odd and even starts and sizes, short and long enough to use vector
+  // instructions, before, across and after the zero area.
+  uint32_t starts[] = { 0, 1, 7, 500, 933, 999, 1000, 1001, 1299, 1300, 1301, 1800 };
+  uint32_t sizes[] = { 0, 1, 2, 15, 63, 64, 65, 200, 301, 1024, 1500 };
+  for (uint32_t s = 0; s < sizeof (starts) / sizeof (starts[0]); s++)
+    {
+      for (uint32_t z = 0; z < sizeof (sizes) / sizeof (sizes[0]); z++)
+        {
+          if (starts[s] + sizes[z] > buffer.GetSize ())
+            {
+              continue;
+            }
+          Buffer::Iterator it = buffer.Begin ();
+          it.Next (starts[s]);
+          uint16_t expected = Reference (it, sizes[z]);
+          uint16_t actual = it.CalculateIpChecksum (sizes[z]);
+          NS_TEST_EXPECT_MSG_EQ (actual, expected, "Wrong checksum of " << sizes[z] << " bytes at " << starts[s]);
+          NS_TEST_EXPECT_MSG_EQ (it.GetDistanceFrom (buffer.Begin ()), starts[s] + sizes[z], "Iterator not moved");
+        }
+    }
+
+  // The initial checksum is added to the sum
+  Buffer::Iterator it = buffer.Begin ();
+  uint16_t partial = ~it.CalculateIpChecksum (700);
+  uint16_t expected = Reference (buffer.Begin (), 1500);
+  NS_TEST_EXPECT_MSG_EQ (it.CalculateIpChecksum (800, partial), expected, "Wrong checksum in two parts");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +554,8 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferPoolTest, TestCase::QUICK);
+  AddTestCase (new BufferChecksumTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
@@ -19,6 +19,9 @@
 #include "ns3/test.h"
 #include "ns3/drop-tail-queue.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/ring-buffer.h"
+#include <deque>
 
 using namespace ns3;
 
@@ -83,6 +86,90 @@ DropTailQueueTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ ((packet == 0), true, "There are really no packets in there");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the ring buffer keeps its items in order across wrap
+ * arounds and growths, and that the drop tail queue using it stays FIFO.
+ */
+class RingBufferTestCase : public TestCase
+{
+public:
+  RingBufferTestCase ();
+  virtual void DoRun (void);
+};
+
+RingBufferTestCase::RingBufferTestCase ()
+  : TestCase ("Check the ring buffer storage of the drop tail queue")
+{
+}
+
+void
+RingBufferTestCase::DoRun (void)
+{
+  RingBuffer<uint32_t> ring;
+  std::deque<uint32_t> reference;
+  uint32_t next = 0;
+  for (uint32_t round = 0; round < 200; round++)
+    {
+      // Grow for the first rounds, then push and pop the same number of items
+      uint32_t pushes = round < 100 ? 3 : 2;
+      for (uint32_t i = 0; i < pushes; i++, next++)
+        {
+          if (next % 5 == 0)
+            {
+              ring.PushFront (next);
+              reference.push_front (next);
+            }
+          else
+            {
+              ring.PushBack (next);
+              reference.push_back (next);
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (ring.PopFront (), reference.front (), "Wrong item at the front");
+      reference.pop_front ();
+      NS_TEST_EXPECT_MSG_EQ (ring.PopBack (), reference.back (), "Wrong item at the back");
+      reference.pop_back ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), reference.size (), "Wrong number of items");
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (ring[i], reference[i], "Wrong item at position " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (ring.GetCapacity (), 128, "The capacity should be the smallest power of two above 100");
+  ring.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (ring.IsEmpty (), true, "The buffer should be empty");
+  NS_TEST_EXPECT_MSG_EQ (ring.GetCapacity (), 128, "Clear should keep the capacity");
+
+  Ptr<DropTailQueue<Packet> > queue = CreateObject<DropTailQueue<Packet> > ();
+  queue->SetMaxSize (QueueSize ("50p"));
+  std::deque<Ptr<Packet> > packets;
+  for (uint32_t round = 0; round < 100; round++)
+    {
+      for (uint32_t i = 0; i < 3; i++)
+        {
+          Ptr<Packet> p = Create<Packet> (round + 1);
+          if (queue->Enqueue (p))
+            {
+              packets.push_back (p);
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (queue->Peek (), packets.front (), "Wrong packet at the head");
+      NS_TEST_EXPECT_MSG_EQ (queue->Dequeue (), packets.front (), "Packet dequeued out of order");
+      packets.pop_front ();
+      NS_TEST_EXPECT_MSG_EQ (queue->Remove (), packets.front (), "Packet removed out of order");
+      packets.pop_front ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (queue->GetNPackets (), 48, "Wrong number of packets in the queue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsBeforeEnqueue (), 52, "Wrong number of packets dropped before enqueue");
+  NS_TEST_EXPECT_MSG_EQ (queue->GetTotalDroppedPacketsAfterDequeue (), 100, "Wrong number of packets removed");
+  queue->Flush ();
+  NS_TEST_EXPECT_MSG_EQ (queue->IsEmpty (), true, "The queue should be empty");
+  NS_TEST_EXPECT_MSG_EQ ((queue->Dequeue () == 0), true, "There are really no packets in there");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -96,6 +183,7 @@ public:
     : TestSuite ("drop-tail-queue", UNIT)
   {
     AddTestCase (new DropTailQueueTestCase (), TestCase::QUICK);
+    AddTestCase (new RingBufferTestCase (), TestCase::QUICK);
   }
 };
 
@@ -21,6 +21,9 @@
 #include <iostream>
 #include <sstream>
 #include "ns3/test.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
 #include "ns3/header.h"
 #include "ns3/trailer.h"
 #include "ns3/packet.h"
@@ -318,7 +321,11 @@ HistoryTrailer<N>::Deserialize (Buffer::Iterator start)
  */
 class PacketMetadataTest : public TestCase {
 public:
-  PacketMetadataTest ();
+  /**
+   * Constructor
+   * \param compact true to store the metadata as fixed-size records
+   */
+  PacketMetadataTest (bool compact);
   virtual ~PacketMetadataTest ();
   /**
    * Checks the packet header and trailer history
@@ -337,10 +344,13 @@ private:
    * \return The packet with the header added.
    */
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
+
+  bool m_compact; //!< true to store the metadata as fixed-size records
 };
 
-PacketMetadataTest::PacketMetadataTest ()
-  : TestCase ("Packet metadata")
+PacketMetadataTest::PacketMetadataTest (bool compact)
+  : TestCase (compact ? "Packet metadata, compact layout" : "Packet metadata"),
+    m_compact (compact)
 {
 }
 
@@ -477,6 +487,7 @@ PacketMetadataTest::DoAddHeader (Ptr<Packet> p)
 void
 PacketMetadataTest::DoRun (void)
 {
+  Config::SetGlobal ("PacketMetadataCompact", BooleanValue (m_compact));
   PacketMetadata::Enable ();
 
   Ptr<Packet> p = Create<Packet> (0);
@@ -900,6 +911,100 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  Config::SetGlobal ("PacketMetadataCompact", BooleanValue (false));
+  PacketMetadata::Enable ();
+}
+
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet Metadata sampling unit tests.
+ */
+class PacketMetadataSamplingTest : public TestCase {
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Counts the items of the packet metadata
+   * \param p The packet
+   * \return The number of items
+   */
+  uint32_t CountItems (Ptr<const Packet> p);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : TestCase ("Packet metadata sampling")
+{
+}
+
+uint32_t
+PacketMetadataSamplingTest::CountItems (Ptr<const Packet> p)
+{
+  uint32_t n = 0;
+  PacketMetadata::ItemIterator k = p->BeginItem ();
+  while (k.HasNext ())
+    {
+      k.Next ();
+      n++;
+    }
+  return n;
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  Config::SetGlobal ("PacketMetadataSampling", UintegerValue (4));
+  PacketMetadata::Enable ();
+
+  Ptr<Packet> sampled = 0;
+  Ptr<Packet> unsampled = 0;
+  while (sampled == 0 || unsampled == 0)
+    {
+      Ptr<Packet> p = Create<Packet> (10);
+      if (p->GetUid () % 4 == 0)
+        {
+          sampled = p;
+        }
+      else
+        {
+          unsampled = p;
+        }
+    }
+  ADD_HEADER (sampled, 2);
+  ADD_HEADER (unsampled, 2);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (sampled), 2, "Sampled packet lost its metadata");
+  NS_TEST_EXPECT_MSG_EQ (CountItems (unsampled), 0, "Unsampled packet has metadata");
+  REM_HEADER (unsampled, 2);
+  NS_TEST_EXPECT_MSG_EQ (unsampled->GetSize (), 10, "Could not remove the header");
+
+  uint32_t size = sampled->GetSerializedSize ();
+  uint8_t *buffer = new uint8_t[size];
+  sampled->Serialize (buffer, size);
+  Ptr<Packet> other = Create<Packet> (buffer, size, true);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (other), 2, "Deserialized packet lost its metadata");
+  delete [] buffer;
+  size = unsampled->GetSerializedSize ();
+  buffer = new uint8_t[size];
+  unsampled->Serialize (buffer, size);
+  other = Create<Packet> (buffer, size, true);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (other), 0, "Deserialized packet has metadata");
+  delete [] buffer;
+
+  // a packet made of sampled and unsampled bytes is not sampled.
+  Ptr<Packet> p = sampled->Copy ();
+  p->AddAtEnd (unsampled);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (p), 0, "Aggregate packet has metadata");
+  NS_TEST_EXPECT_MSG_EQ (CountItems (sampled), 2, "Sampled packet lost its metadata");
+  p = unsampled->Copy ();
+  p->AddAtEnd (sampled);
+  NS_TEST_EXPECT_MSG_EQ (CountItems (p), 0, "Aggregate packet has metadata");
+
+  Config::SetGlobal ("PacketMetadataSampling", UintegerValue (1));
+  PacketMetadata::Enable ();
 }
 
 
@@ -918,7 +1023,9 @@ public:
 PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
-  AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (false), TestCase::QUICK);
+  AddTestCase (new PacketMetadataTest (true), TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
 }
 
 static PacketMetadataTestSuite g_packetMetadataTest; //!< Static variable for test initialization
@@ -22,6 +22,7 @@
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
+#include <sstream>
 #include <string>
 #include <cstdarg>
 #include <iostream>
@@ -1035,6 +1036,240 @@ PacketTagListTest::DoRun (void)
     
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Tags stored inline in the packet and spilled over to the heap.
+ */
+class PacketTagStorageTest : public TestCase
+{
+public:
+  PacketTagStorageTest ();
+  virtual void DoRun (void);
+};
+
+PacketTagStorageTest::PacketTagStorageTest ()
+  : TestCase ("Inline and heap tag storage") {
+}
+
+void
+PacketTagStorageTest::DoRun (void)
+{
+  // More packet tags than fit inline, one of them too large.
+  Ptr<Packet> p = Create<Packet> (10);
+  p->AddPacketTag (ATestTag<1> (1));
+  p->AddPacketTag (ATestTag<40> (2));
+  p->AddPacketTag (ATestTag<3> (3));
+  p->AddPacketTag (ATestTag<4> (4));
+  p->AddPacketTag (ATestTag<5> (5));
+  Ptr<Packet> copy = p->Copy ();
+  ATestTag<1> t1;
+  ATestTag<40> t2;
+  ATestTag<4> t4;
+  ATestTag<5> t5;
+  NS_TEST_EXPECT_MSG_EQ (copy->RemovePacketTag (t1), true, "Tag not copied");
+  NS_TEST_EXPECT_MSG_EQ (t1.GetData (), 1, "Wrong tag");
+  NS_TEST_EXPECT_MSG_EQ (copy->RemovePacketTag (t5), true, "Tag not copied");
+  NS_TEST_EXPECT_MSG_EQ (t5.GetData (), 5, "Wrong tag");
+  t4.m_data = 14;
+  copy->ReplacePacketTag (t4);
+  copy->AddPacketTag (ATestTag<6> (6));
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (t1), true, "Original changed");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (t4), true, "Original changed");
+  NS_TEST_EXPECT_MSG_EQ (t4.GetData (), 4, "Original changed");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (t5), true, "Original changed");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (t4), true, "Tag not copied");
+  NS_TEST_EXPECT_MSG_EQ (t4.GetData (), 14, "Tag not replaced");
+  NS_TEST_EXPECT_MSG_EQ (copy->PeekPacketTag (t2), true, "Tag not copied");
+  NS_TEST_EXPECT_MSG_EQ (t2.GetData (), 2, "Wrong tag");
+  uint32_t count = 0;
+  for (PacketTagIterator i = copy->GetPacketTagIterator (); i.HasNext (); i.Next ())
+    {
+      count++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, 4, "Wrong number of tags");
+  copy->RemoveAllPacketTags ();
+  NS_TEST_EXPECT_MSG_EQ (copy->GetPacketTagIterator ().HasNext (), false, "Tags not removed");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (t2), true, "Original changed");
+
+  // Byte tags beyond the inline buffer, added to a copy.
+  Ptr<Packet> q = Create<Packet> (10);
+  q->AddByteTag (ATestTag<1> (1));
+  Ptr<Packet> qcopy = q->Copy ();
+  for (uint8_t i = 2; i <= 5; i++)
+    {
+      qcopy->AddByteTag (ATestTag<20> (i));
+    }
+  count = 0;
+  for (ByteTagIterator i = q->GetByteTagIterator (); i.HasNext (); i.Next ())
+    {
+      count++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, 1, "Original changed");
+  count = 0;
+  ByteTagIterator i = qcopy->GetByteTagIterator ();
+  while (i.HasNext ())
+    {
+      ByteTagIterator::Item item = i.Next ();
+      ATestTagBase *tag = dynamic_cast<ATestTagBase *> (item.GetTypeId ().GetConstructor () ());
+      item.GetTag (*tag);
+      NS_TEST_EXPECT_MSG_EQ (tag->GetData (), ++count, "Wrong tag");
+      NS_TEST_EXPECT_MSG_EQ (tag->m_error, false, "Wrong tag");
+      delete tag;
+    }
+  NS_TEST_EXPECT_MSG_EQ (count, 5, "Wrong number of tags");
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Header which counts its deserializations.
+ *
+ * \note Class internal to packet-test-suite.cc
+ */
+template <int N>
+class CountingHeader : public Header
+{
+public:
+  /// Constructor \param value the value of the header
+  CountingHeader (uint32_t value = 0) : m_value (value) {}
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    std::ostringstream oss;
+    oss << "anon::CountingHeader<" << N << ">";
+    static TypeId tid = TypeId (oss.str ().c_str ())
+      .SetParent<Header> ()
+      .SetGroupName ("Network")
+      .HideFromDocumentation ()
+      .AddConstructor<CountingHeader<N> > ()
+    ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const
+  {
+    return GetTypeId ();
+  }
+  virtual void Print (std::ostream &os) const
+  {
+    os << m_value;
+  }
+  virtual uint32_t GetSerializedSize (void) const
+  {
+    return 4;
+  }
+  virtual void Serialize (Buffer::Iterator start) const
+  {
+    start.WriteHtonU32 (m_value);
+  }
+  virtual uint32_t Deserialize (Buffer::Iterator start)
+  {
+    m_value = start.ReadNtohU32 ();
+    g_deserialized++;
+    return 4;
+  }
+  /// \returns the value of the header
+  uint32_t GetValue (void) const
+  {
+    return m_value;
+  }
+  static uint32_t g_deserialized; //!< The number of deserializations
+private:
+  uint32_t m_value; //!< The value of the header
+};
+
+template <int N>
+uint32_t CountingHeader<N>::g_deserialized = 0;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Packet header cache unit tests.
+ *
+ * The test enables the header cache for the rest of the process.
+ */
+class PacketHeaderCacheTest : public TestCase
+{
+public:
+  PacketHeaderCacheTest ();
+  virtual void DoRun (void);
+};
+
+PacketHeaderCacheTest::PacketHeaderCacheTest ()
+  : TestCase ("Packet header cache") {
+}
+
+void
+PacketHeaderCacheTest::DoRun (void)
+{
+  typedef CountingHeader<1> Inner;
+  typedef CountingHeader<2> Outer;
+  Packet::EnableHeaderCache ();
+
+  // The layers peek at the same header: it is deserialized once.
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddHeader (Inner (7));
+  uint32_t deserialized = Inner::g_deserialized;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Inner inner;
+      NS_TEST_EXPECT_MSG_EQ (p->PeekHeader (inner), 4, "Wrong size");
+      NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 7, "Wrong header");
+    }
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 1, "Header not cached");
+
+  // The copies share the headers already deserialized.
+  Ptr<Packet> copy = p->Copy ();
+  Inner inner;
+  copy->PeekHeader (inner);
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 7, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 1, "Header not shared");
+
+  // The headers added and removed in front move the cached header.
+  p->AddHeader (Outer (9));
+  Outer outer;
+  p->PeekHeader (outer);
+  NS_TEST_EXPECT_MSG_EQ (outer.GetValue (), 9, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 1, "Wrong header cached");
+  uint32_t outerDeserialized = Outer::g_deserialized;
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (outer), 4, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (Outer::g_deserialized, outerDeserialized, "Header not cached");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 104, "Header not removed");
+  inner = Inner ();
+  NS_TEST_EXPECT_MSG_EQ (p->RemoveHeader (inner), 4, "Wrong size");
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 7, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "Header not removed");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 1, "Header not moved");
+
+  // A header replaced in front of the packet is deserialized again,
+  // and the copy keeps the old one.
+  p->AddHeader (Inner (8));
+  p->PeekHeader (inner);
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 8, "Stale header");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 2, "Stale header");
+  copy->PeekHeader (inner);
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 7, "Copy changed");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 2, "Copy changed");
+
+  // Removing a part of the cached header drops it.
+  copy->RemoveAtStart (2);
+  copy->PeekHeader (inner);
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 7 << 16, "Stale header");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 3, "Stale header");
+
+  // Any change at the end of the packet drops the cached headers.
+  p->AddPaddingAtEnd (10);
+  p->PeekHeader (inner);
+  NS_TEST_EXPECT_MSG_EQ (inner.GetValue (), 8, "Wrong header");
+  NS_TEST_EXPECT_MSG_EQ (Inner::g_deserialized, deserialized + 4, "Header not dropped");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1052,6 +1287,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagStorageTest, TestCase::QUICK);
+  AddTestCase (new PacketHeaderCacheTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
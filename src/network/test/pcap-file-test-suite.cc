@@ -1144,6 +1144,97 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the asynchronous writes of a
+ * Pcap File Object produce the same file as the synchronous ones.
+ */
+class AsyncWriteTestCase : public TestCase
+{
+public:
+  AsyncWriteTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  std::string m_syncFilename;  //!< File name of the synchronous writes
+  std::string m_asyncFilename; //!< File name of the asynchronous writes
+};
+
+AsyncWriteTestCase::AsyncWriteTestCase ()
+  : TestCase ("Check that PcapFile::EnableAsyncWrite writes the same file")
+{
+}
+
+void
+AsyncWriteTestCase::DoSetup (void)
+{
+  std::stringstream filename;
+  uint32_t n = rand ();
+  filename << n;
+  m_syncFilename = CreateTempDirFilename (filename.str () + "-sync.pcap");
+  m_asyncFilename = CreateTempDirFilename (filename.str () + "-async.pcap");
+}
+
+void
+AsyncWriteTestCase::DoTeardown (void)
+{
+  if (remove (m_syncFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_syncFilename);
+    }
+  if (remove (m_asyncFilename.c_str ()))
+    {
+      NS_LOG_ERROR ("Failed to delete file " << m_asyncFilename);
+    }
+}
+
+void
+AsyncWriteTestCase::DoRun (void)
+{
+  //
+  // Write the known packets many times over, with blocks small enough that
+  // records straddle blocks and the writer runs out of blocks.
+  //
+  for (uint32_t async = 0; async < 2; ++async)
+    {
+      std::string filename = async ? m_asyncFilename : m_syncFilename;
+      PcapFile f;
+      f.Open (filename, std::ios::out);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+      if (async)
+        {
+          f.EnableAsyncWrite (256, 2);
+        }
+      f.Init (1, N_PACKET_BYTES);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Init (1, " << N_PACKET_BYTES << ") returns error");
+
+      for (uint32_t j = 0; j < 100; ++j)
+        {
+          for (uint32_t i = 0; i < N_KNOWN_PACKETS; ++i)
+            {
+              PacketEntry const & p = knownPackets[i];
+              f.Write (p.tsSec + j, p.tsUsec, (uint8_t const *)p.data, p.origLen);
+            }
+          if (j == 50)
+            {
+              f.Flush ();
+            }
+        }
+      NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Write must not fail");
+      f.Close ();
+    }
+
+  uint32_t sec (0), usec (0), packets (0);
+  bool diff = PcapFile::Diff (m_syncFilename, m_asyncFilename, sec, usec, packets);
+  NS_TEST_EXPECT_MSG_EQ (diff, false, "Asynchronous writes differ at " << sec << "." << usec);
+  NS_TEST_EXPECT_MSG_EQ (packets, 100 * N_KNOWN_PACKETS, "Asynchronous writes lost packets");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1167,6 +1258,7 @@ PcapFileTestSuite::PcapFileTestSuite ()
   AddTestCase (new RecordHeaderTestCase, TestCase::QUICK);
   AddTestCase (new ReadFileTestCase, TestCase::QUICK);
   AddTestCase (new DiffTestCase, TestCase::QUICK);
+  AddTestCase (new AsyncWriteTestCase, TestCase::QUICK);
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
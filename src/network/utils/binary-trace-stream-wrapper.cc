@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "binary-trace-stream-wrapper.h"
+#include "ns3/log.h"
+#include "ns3/packet.h"
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTraceStreamWrapper");
+
+namespace {
+
+/// First byte of the file header; it can't be mistaken for a record type.
+const char MAGIC[4] = { '\x93', 'T', 'R', 'B' };
+/// Version of the format
+const uint32_t VERSION = 1;
+/// Record type of a new context
+const char CONTEXT = 'c';
+/// Context index of the events without a context
+const uint32_t NO_CONTEXT = 0xffffffff;
+
+/**
+ * \brief Read a field of a binary trace.
+ * \param is the binary trace
+ * \param value the field
+ * \returns true if the field could be read
+ */
+template <typename T>
+bool
+ReadField (std::istream &is, T &value)
+{
+  is.read (reinterpret_cast<char *> (&value), sizeof (value));
+  return is.good ();
+}
+
+} // anonymous namespace
+
+BinaryTraceStreamWrapper::BinaryTraceStreamWrapper (std::string filename, std::ios::openmode filemode)
+  : OutputStreamWrapper (filename, filemode | std::ios::binary)
+{
+  NS_LOG_FUNCTION (this << filename << filemode);
+  WriteFileHeader ();
+}
+
+BinaryTraceStreamWrapper::BinaryTraceStreamWrapper (std::ostream* os)
+  : OutputStreamWrapper (os)
+{
+  NS_LOG_FUNCTION (this << os);
+  WriteFileHeader ();
+}
+
+BinaryTraceStreamWrapper::~BinaryTraceStreamWrapper ()
+{
+  NS_LOG_FUNCTION (this);
+  GetStream ()->flush ();
+}
+
+void
+BinaryTraceStreamWrapper::WriteFileHeader (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::ostream *os = GetStream ();
+  os->write (MAGIC, sizeof (MAGIC));
+  os->write (reinterpret_cast<const char *> (&VERSION), sizeof (VERSION));
+}
+
+uint32_t
+BinaryTraceStreamWrapper::Intern (std::string const &context)
+{
+  std::map<std::string, uint32_t>::const_iterator i = m_contexts.find (context);
+  if (i != m_contexts.end ())
+    {
+      return i->second;
+    }
+  uint32_t index = m_contexts.size ();
+  uint32_t length = context.size ();
+  m_contexts.insert (std::make_pair (context, index));
+
+  std::ostream *os = GetStream ();
+  os->put (CONTEXT);
+  os->write (reinterpret_cast<const char *> (&index), sizeof (index));
+  os->write (reinterpret_cast<const char *> (&length), sizeof (length));
+  os->write (context.data (), length);
+  return index;
+}
+
+void
+BinaryTraceStreamWrapper::WriteEvent (char event, std::string const *context, double time, Ptr<const Packet> p)
+{
+  NS_LOG_FUNCTION (this << event << time << p);
+  uint32_t index = context != 0 ? Intern (*context) : NO_CONTEXT;
+  uint64_t uid = p->GetUid ();
+  uint32_t size = p->GetSerializedSize ();
+  m_buffer.resize ((size + 3) / 4);
+  uint32_t serialized = p->Serialize (reinterpret_cast<uint8_t *> (&m_buffer[0]), size);
+  NS_ASSERT (serialized);
+
+  std::ostream *os = GetStream ();
+  os->put (event);
+  os->write (reinterpret_cast<const char *> (&index), sizeof (index));
+  os->write (reinterpret_cast<const char *> (&time), sizeof (time));
+  os->write (reinterpret_cast<const char *> (&uid), sizeof (uid));
+  os->write (reinterpret_cast<const char *> (&size), sizeof (size));
+  os->write (reinterpret_cast<const char *> (&m_buffer[0]), size);
+}
+
+bool
+BinaryTraceStreamWrapper::Decode (std::istream &is, std::ostream &os)
+{
+  NS_LOG_FUNCTION (&is << &os);
+  Packet::EnablePrinting ();
+
+  std::vector<std::string> contexts;
+  std::vector<uint32_t> buffer;
+  bool header = false;
+  char type;
+  while (is.get (type))
+    {
+      if (type == MAGIC[0])
+        {
+          // A new file header, written by a stream appending to the file.
+          char magic[sizeof (MAGIC) - 1];
+          uint32_t version;
+          is.read (magic, sizeof (magic));
+          if (!ReadField (is, version)
+              || std::memcmp (magic, MAGIC + 1, sizeof (magic)) != 0
+              || version != VERSION)
+            {
+              return false;
+            }
+          contexts.clear ();
+          header = true;
+          continue;
+        }
+      if (!header)
+        {
+          return false;
+        }
+      uint32_t index;
+      if (!ReadField (is, index))
+        {
+          return false;
+        }
+      if (type == CONTEXT)
+        {
+          uint32_t length;
+          if (index != contexts.size () || !ReadField (is, length))
+            {
+              return false;
+            }
+          std::string context (length, '\0');
+          if (length != 0 && !is.read (&context[0], length))
+            {
+              return false;
+            }
+          contexts.push_back (context);
+          continue;
+        }
+      if (type != '+' && type != '-' && type != 'd' && type != 'r')
+        {
+          return false;
+        }
+
+      double time;
+      uint64_t uid;
+      uint32_t size;
+      if (!ReadField (is, time) || !ReadField (is, uid) || !ReadField (is, size)
+          || (index != NO_CONTEXT && index >= contexts.size ()))
+        {
+          return false;
+        }
+      buffer.resize ((size + 3) / 4);
+      if (size == 0 || !is.read (reinterpret_cast<char *> (&buffer[0]), size))
+        {
+          return false;
+        }
+      Ptr<Packet> p = Create<Packet> (reinterpret_cast<const uint8_t *> (&buffer[0]), size, true);
+
+      os << type << " " << time << " ";
+      if (index != NO_CONTEXT)
+        {
+          os << contexts[index] << " ";
+        }
+      os << *p << '\n';
+    }
+  os.flush ();
+  return header;
+}
+
+} // namespace ns3
@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TRACE_STREAM_WRAPPER_H
+#define BINARY_TRACE_STREAM_WRAPPER_H
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "output-stream-wrapper.h"
+
+namespace ns3 {
+
+class Packet;
+
+/**
+ * @brief An output stream which stores the events of the ascii trace
+ * sinks in a compact binary format.
+ *
+ * The default sinks of AsciiTraceHelper format every event with
+ * iostreams, which can take longer than simulating the event.  When
+ * they are handed one of these wrappers instead (see
+ * AsciiTraceHelper::CreateBinaryFileStream), they store the event type,
+ * the time, the context, the packet uid and the serialized packet, and
+ * Decode turns the file back into the exact ascii text offline.  The
+ * utils/decode-ascii-trace program does this from the command line.
+ *
+ * Each context string, such as "/NodeList/3/DeviceList/1/...", is
+ * written once, the first time it is seen, and later events refer to
+ * it by an index.
+ *
+ * The file starts with a 4 byte magic number and a 4 byte version.  It
+ * then holds a sequence of records, each starting with a type byte:
+ *
+ * \verbatim
+ *   'c' uint32 index, uint32 length, length bytes   a new context
+ *   '+', '-', 'd', 'r' uint32 context index, double seconds,
+ *     uint64 packet uid, uint32 size, size bytes     a packet event
+ * \endverbatim
+ *
+ * The events without a context use the index 0xffffffff.  All the
+ * fields are in host byte order: the files are meant to be decoded on
+ * the machine which wrote them.
+ *
+ * Other sinks which write to the stream directly (through GetStream)
+ * would corrupt the file, so only hand these wrappers to the default
+ * sinks.
+ */
+class BinaryTraceStreamWrapper : public OutputStreamWrapper
+{
+public:
+  /**
+   * Constructor
+   * \param filename file name
+   * \param filemode std::ios::openmode flags; std::ios::binary is added
+   */
+  BinaryTraceStreamWrapper (std::string filename, std::ios::openmode filemode);
+  /**
+   * Constructor
+   * \param os output stream
+   */
+  BinaryTraceStreamWrapper (std::ostream* os);
+  virtual ~BinaryTraceStreamWrapper ();
+
+  /**
+   * \brief Store an event of the ascii trace sinks.
+   *
+   * \param event the event character: '+', '-', 'd' or 'r'
+   * \param context the context of the event, or 0 if it has none
+   * \param time the time of the event, in seconds
+   * \param p the packet of the event
+   */
+  void WriteEvent (char event, std::string const *context, double time, Ptr<const Packet> p);
+
+  /**
+   * \brief Regenerate the ascii text of a binary trace.
+   *
+   * The packets are printed with Packet::Print, so the headers and
+   * trailers they carry must be registered in the calling program.
+   * Packet printing is enabled by this method.
+   *
+   * \param is the binary trace
+   * \param os the stream the ascii text is written to
+   * \returns false if the input is not a binary trace or is truncated
+   */
+  static bool Decode (std::istream &is, std::ostream &os);
+
+private:
+  /// Write the magic number and the version of the format.
+  void WriteFileHeader (void);
+  /**
+   * \brief Get the index of a context, writing it the first time.
+   * \param context the context
+   * \returns the index of the context
+   */
+  uint32_t Intern (std::string const &context);
+
+  /// The index of every context already written
+  std::map<std::string, uint32_t> m_contexts;
+  /// Scratch space to serialize the packets, 4-byte aligned
+  std::vector<uint32_t> m_buffer;
+};
+
+} // namespace ns3
+
+#endif /* BINARY_TRACE_STREAM_WRAPPER_H */
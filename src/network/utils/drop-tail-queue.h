@@ -27,6 +27,8 @@ namespace ns3 {
  * \ingroup queue
  *
  * \brief A FIFO packet queue that drops tail-end packets on overflow
+ *
+ * The items are stored in a RingBuffer.
  */
 template <typename Item>
 class DropTailQueue : public Queue<Item>
@@ -52,8 +54,6 @@ public:
   virtual Ptr<const Item> Peek (void) const;
 
 private:
-  using Queue<Item>::Head;
-  using Queue<Item>::Tail;
   using Queue<Item>::DoEnqueue;
   using Queue<Item>::DoDequeue;
   using Queue<Item>::DoRemove;
@@ -81,7 +81,7 @@ DropTailQueue<Item>::GetTypeId (void)
 
 template <typename Item>
 DropTailQueue<Item>::DropTailQueue () :
-  Queue<Item> (),
+  Queue<Item> (Queue<Item>::RING_BUFFER),
   NS_LOG_TEMPLATE_DEFINE ("DropTailQueue")
 {
   NS_LOG_FUNCTION (this);
@@ -99,7 +99,7 @@ DropTailQueue<Item>::Enqueue (Ptr<Item> item)
 {
   NS_LOG_FUNCTION (this << item);
 
-  return DoEnqueue (Tail (), item);
+  return DoEnqueue (item);
 }
 
 template <typename Item>
@@ -108,7 +108,7 @@ DropTailQueue<Item>::Dequeue (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoDequeue (Head ());
+  Ptr<Item> item = DoDequeue ();
 
   NS_LOG_LOGIC ("Popped " << item);
 
@@ -121,7 +121,7 @@ DropTailQueue<Item>::Remove (void)
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<Item> item = DoRemove (Head ());
+  Ptr<Item> item = DoRemove ();
 
   NS_LOG_LOGIC ("Removed " << item);
 
@@ -134,7 +134,7 @@ DropTailQueue<Item>::Peek (void) const
 {
   NS_LOG_FUNCTION (this);
 
-  return DoPeek (Head ());
+  return DoPeek ();
 }
 
 } // namespace ns3
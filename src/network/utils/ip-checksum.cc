@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/*
+ * See RFC 1071 for the properties of the one's complement sum used
+ * here: the sum can be computed on words of any size, as long as the
+ * carries are added back when folding the result to 16 bits, and the
+ * sum of byte-swapped words is the byte-swapped sum.
+ */
+
+#include "ip-checksum.h"
+#include <cstring>
+
+#if defined (__GNUC__) && defined (__SSE2__) && (defined (__x86_64__) || defined (__i386__))
+#define IP_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * \param sum a one's complement sum
+ * \returns the sum, folded to 16 bits
+ */
+uint16_t
+Fold (uint64_t sum)
+{
+  while (sum >> 16)
+    {
+      sum = (sum & 0xffff) + (sum >> 16);
+    }
+  return sum;
+}
+
+/**
+ * \returns true if the host stores the least significant byte first
+ */
+bool
+IsLittleEndian (void)
+{
+  uint16_t one = 1;
+  uint8_t first;
+  std::memcpy (&first, &one, 1);
+  return first == 1;
+}
+
+/**
+ * Sum a buffer eight bytes at a time, without vector instructions.
+ *
+ * \param data buffer to sum
+ * \param size the length of the buffer (bytes)
+ * \returns the sum, folded to 16 bits
+ */
+uint16_t
+SumPortable (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  uint32_t i = 0;
+  for (; i + 8 <= size; i += 8)
+    {
+      uint64_t word;
+      std::memcpy (&word, data + i, 8);
+      sum += (word & 0xffffffff) + (word >> 32);
+    }
+  uint16_t folded = Fold (sum);
+  if (!IsLittleEndian ())
+    {
+      // the words were loaded with the even bytes in their high order bits
+      folded = (folded >> 8) | (folded << 8);
+    }
+
+  sum = folded;
+  for (; i < size; i++)
+    {
+      sum += (i & 1) ? data[i] << 8 : data[i];
+    }
+  return Fold (sum);
+}
+
+#ifdef IP_CHECKSUM_X86
+
+/**
+ * The number of blocks summed in the 32 bit lanes of a vector before
+ * the lanes are added to the 64 bit sum: each block adds less than
+ * 2^17 to a lane.
+ */
+const uint32_t LANE_BLOCKS = 16384;
+
+/**
+ * Sum 16 byte blocks with SSE2 instructions.
+ *
+ * \param data buffer to sum
+ * \param blocks the number of 16 byte blocks in the buffer
+ * \returns the sum, not folded
+ */
+uint64_t
+SumSse2 (const uint8_t *data, uint32_t blocks)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  uint64_t sum = 0;
+  while (blocks > 0)
+    {
+      uint32_t n = blocks < LANE_BLOCKS ? blocks : LANE_BLOCKS;
+      blocks -= n;
+      __m128i acc = zero;
+      for (uint32_t i = 0; i < n; i++, data += 16)
+        {
+          __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i *> (data));
+          acc = _mm_add_epi32 (acc, _mm_unpacklo_epi16 (v, zero));
+          acc = _mm_add_epi32 (acc, _mm_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[4];
+      _mm_storeu_si128 (reinterpret_cast<__m128i *> (lanes), acc);
+      sum += static_cast<uint64_t> (lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+  return sum;
+}
+
+/**
+ * Sum 32 byte blocks with AVX2 instructions.
+ *
+ * \param data buffer to sum
+ * \param blocks the number of 32 byte blocks in the buffer
+ * \returns the sum, not folded
+ */
+__attribute__ ((target ("avx2")))
+uint64_t
+SumAvx2 (const uint8_t *data, uint32_t blocks)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  uint64_t sum = 0;
+  while (blocks > 0)
+    {
+      uint32_t n = blocks < LANE_BLOCKS ? blocks : LANE_BLOCKS;
+      blocks -= n;
+      __m256i acc = zero;
+      for (uint32_t i = 0; i < n; i++, data += 32)
+        {
+          __m256i v = _mm256_loadu_si256 (reinterpret_cast<const __m256i *> (data));
+          acc = _mm256_add_epi32 (acc, _mm256_unpacklo_epi16 (v, zero));
+          acc = _mm256_add_epi32 (acc, _mm256_unpackhi_epi16 (v, zero));
+        }
+      uint32_t lanes[8];
+      _mm256_storeu_si256 (reinterpret_cast<__m256i *> (lanes), acc);
+      for (uint32_t j = 0; j < 8; j++)
+        {
+          sum += lanes[j];
+        }
+    }
+  return sum;
+}
+
+/**
+ * \returns true if the host supports the AVX2 instructions
+ */
+bool
+HasAvx2 (void)
+{
+  static bool avx2 = (__builtin_cpu_init (), __builtin_cpu_supports ("avx2"));
+  return avx2;
+}
+
+#endif /* IP_CHECKSUM_X86 */
+
+} // anonymous namespace
+
+uint16_t
+IpChecksumPartial (const uint8_t *data, uint32_t size)
+{
+  uint64_t sum = 0;
+  uint32_t done = 0;
+#ifdef IP_CHECKSUM_X86
+  // The vector loops only pay off beyond a few blocks; the blocks have
+  // an even size, so the remaining bytes start on an even byte.
+  if (size >= 64)
+    {
+      if (HasAvx2 ())
+        {
+          sum = SumAvx2 (data, size / 32);
+          done = size & ~31U;
+        }
+      else
+        {
+          sum = SumSse2 (data, size / 16);
+          done = size & ~15U;
+        }
+    }
+#endif
+  sum += SumPortable (data + done, size - done);
+  return Fold (sum);
+}
+
+} // namespace ns3
@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IP_CHECKSUM_H
+#define IP_CHECKSUM_H
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * Calculates the one's complement sum of a byte array, as defined by
+ * RFC 1071 for the Internet checksum.
+ *
+ * The array is summed as 16 bit words made of an even byte in the low
+ * order bits and of the following odd byte in the high order bits,
+ * which is the order in which Buffer::Iterator::ReadU16 reads them.
+ * An odd last byte is summed as a word whose high order bits are zero.
+ * The data may have any alignment.
+ *
+ * The sum is computed with SSE2 or AVX2 instructions when the host
+ * supports them.
+ *
+ * \param data buffer to sum
+ * \param size the length of the buffer (bytes)
+ * \returns the sum, folded to 16 bits, which is zero only if all the
+ *          bytes are zero.
+ */
+uint16_t IpChecksumPartial (const uint8_t *data, uint32_t size);
+
+} // namespace ns3
+
+#endif
@@ -81,7 +81,7 @@ public:
    * \param os output stream
    */
   OutputStreamWrapper (std::ostream* os);
-  ~OutputStreamWrapper ();
+  virtual ~OutputStreamWrapper ();
 
   /**
    * Return a pointer to an ostream previously set in the wrapper.
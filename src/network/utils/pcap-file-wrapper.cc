@@ -21,6 +21,7 @@
 #include "ns3/uinteger.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
+#include "ns3/simulator.h"
 #include "pcap-file-wrapper.h"
 
 namespace ns3 {
@@ -46,12 +47,30 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("AsyncWrite",
+                   "Whether the records are written to the file by a background "
+                   "thread, in blocks of AsyncBlockSize bytes.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_asyncWrite),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AsyncBlockSize",
+                   "The size of the blocks of records written by the background thread.",
+                   UintegerValue (1 << 20),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_asyncBlockSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("AsyncMaxBlocks",
+                   "The maximum number of blocks of records waiting for the "
+                   "background thread, beyond which writing a packet waits.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_asyncMaxBlocks),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_flushScheduled (false)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -59,6 +78,10 @@ PcapFileWrapper::PcapFileWrapper ()
 PcapFileWrapper::~PcapFileWrapper ()
 {
   NS_LOG_FUNCTION (this);
+  if (m_flushScheduled)
+    {
+      Simulator::Cancel (m_flushEvent);
+    }
   Close ();   
 }
 
@@ -89,6 +112,21 @@ PcapFileWrapper::Close (void)
   m_file.Close ();
 }
 
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_file.Flush ();
+}
+
+void
+PcapFileWrapper::FlushAtDestroy (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_flushScheduled = false;
+  m_file.Flush ();
+}
+
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
@@ -113,6 +151,18 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
     {
       m_file.Init (dataLinkType, m_snapLen, tzCorrection, false, m_nanosecMode);
     } 
+  if (m_asyncWrite)
+    {
+      m_file.EnableAsyncWrite (m_asyncBlockSize, m_asyncMaxBlocks);
+      if (!m_flushScheduled)
+        {
+          // The wrapper is often kept alive by a trace callback until
+          // the end of the program, so make sure the records are
+          // written when the simulation is destroyed.
+          m_flushEvent = Simulator::ScheduleDestroy (&PcapFileWrapper::FlushAtDestroy, this);
+          m_flushScheduled = true;
+        }
+    }
 }
 
 void
@@ -26,6 +26,7 @@
 #include "ns3/packet.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 #include "pcap-file.h"
 
 namespace ns3 {
@@ -35,6 +36,11 @@ namespace ns3 {
  * ns-3 interface to the low-level public methods of PcapFile.  Users are
  * encouraged to use this object instead of class ns3::PcapFile in ns-3
  * public APIs.
+ *
+ * If the AsyncWrite attribute is set, the file written after Init is
+ * written by a background thread (see PcapFile::EnableAsyncWrite), and
+ * the pending records are written when the wrapper is closed or
+ * destroyed, or at the latest by Simulator::Destroy.
  */
 class PcapFileWrapper : public Object
 {
@@ -82,6 +88,11 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the pending records to the underlying pcap file.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -221,9 +232,19 @@ public:
   uint32_t GetDataLinkType (void);
 
 private:
+  /**
+   * Write the pending records at Simulator::Destroy.
+   */
+  void FlushAtDestroy (void);
+
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  bool     m_asyncWrite; //!< Write the records from a background thread
+  uint32_t m_asyncBlockSize; //!< Size of the blocks of records
+  uint32_t m_asyncMaxBlocks; //!< Maximum number of blocks waiting to be written
+  EventId  m_flushEvent; //!< The flush at Simulator::Destroy
+  bool     m_flushScheduled; //!< True if m_flushEvent is pending
 };
 
 } // namespace ns3
@@ -20,6 +20,8 @@
 
 #include <iostream>
 #include <cstring>
+#include <deque>
+#include <vector>
 #include "ns3/assert.h"
 #include "ns3/packet.h"
 #include "ns3/fatal-error.h"
@@ -29,6 +31,12 @@
 #include "pcap-file.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include <condition_variable>
+#include <mutex>
+#include "ns3/system-thread.h"
+#endif
 //
 // This file is used as part of the ns-3 test framework, so please refrain from 
 // adding any ns-3 specific constructs such as Packet to this file.
@@ -47,10 +55,36 @@ const uint32_t NS_SWAPPED_MAGIC = 0x4d3cb2a1; /**< Looks this way if byte swappi
 const uint16_t VERSION_MAJOR = 2;             /**< Major version of supported pcap file format */
 const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pcap file format */
 
+/**
+ * The blocks of records and the background thread which writes them.
+ *
+ * The block being filled belongs to the simulation thread.  The other
+ * fields are protected by the mutex, and m_file belongs to the background
+ * thread while it writes a block.
+ */
+struct PcapFile::AsyncWriter
+{
+  std::vector<uint8_t> block;             //!< the block being filled
+  uint32_t blockSize;                     //!< the size of the blocks
+  uint32_t maxBlocks;                     //!< the maximum number of full blocks
+#ifdef HAVE_PTHREAD_H
+  Ptr<SystemThread> thread;               //!< the background thread
+  std::mutex mutex;                       //!< protects the fields below
+  std::condition_variable ready;          //!< signals a full block or stop
+  std::condition_variable written;        //!< signals a written block
+  std::deque<std::vector<uint8_t> > full; //!< the full blocks, in order
+  std::vector<std::vector<uint8_t> > free; //!< the written blocks, for reuse
+  bool writing;                           //!< a block is being written
+  bool stop;                              //!< the thread must stop
+  bool failed;                            //!< a write failed
+#endif
+};
+
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_async (0)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,6 +102,13 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_async != 0)
+    {
+      std::lock_guard<std::mutex> lock (m_async->mutex);
+      return m_async->failed || (!m_async->writing && m_file.fail ());
+    }
+#endif
   return m_file.fail ();
 }
 bool 
@@ -88,9 +129,174 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  if (m_async != 0)
+    {
+      Flush ();
+#ifdef HAVE_PTHREAD_H
+      {
+        std::lock_guard<std::mutex> lock (m_async->mutex);
+        m_async->stop = true;
+      }
+      m_async->ready.notify_one ();
+      m_async->thread->Join ();
+#endif
+      delete m_async;
+      m_async = 0;
+    }
   m_file.close ();
 }
 
+void
+PcapFile::EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks)
+{
+  NS_LOG_FUNCTION (this << blockSize << maxBlocks);
+  NS_ASSERT (blockSize > 0 && maxBlocks > 0);
+#ifdef HAVE_PTHREAD_H
+  if (m_async != 0)
+    {
+      return;
+    }
+  m_async = new AsyncWriter;
+  m_async->blockSize = blockSize;
+  m_async->maxBlocks = maxBlocks;
+  m_async->block.reserve (blockSize);
+  m_async->writing = false;
+  m_async->stop = false;
+  m_async->failed = m_file.fail ();
+  m_async->thread = Create<SystemThread> (MakeCallback (&PcapFile::WriteBlocks, this));
+  m_async->thread->Start ();
+#else
+  NS_LOG_WARN ("No thread support: the pcap records are written directly");
+#endif
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_async != 0)
+    {
+      if (!m_async->block.empty ())
+        {
+          SubmitBlock ();
+        }
+      std::unique_lock<std::mutex> lock (m_async->mutex);
+      while (!m_async->full.empty () || m_async->writing)
+        {
+          m_async->written.wait (lock);
+        }
+      // the thread is idle until the next block.
+      m_file.flush ();
+      m_async->failed |= m_file.fail ();
+      return;
+    }
+#endif
+  m_file.flush ();
+}
+
+void
+PcapFile::SubmitBlock (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  {
+    std::unique_lock<std::mutex> lock (m_async->mutex);
+    while (m_async->full.size () >= m_async->maxBlocks)
+      {
+        m_async->written.wait (lock);
+      }
+    m_async->full.push_back (std::vector<uint8_t> ());
+    m_async->full.back ().swap (m_async->block);
+    if (!m_async->free.empty ())
+      {
+        m_async->block.swap (m_async->free.back ());
+        m_async->free.pop_back ();
+      }
+  }
+  m_async->ready.notify_one ();
+  m_async->block.reserve (m_async->blockSize);
+#endif
+}
+
+void
+PcapFile::WriteBlocks (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  std::unique_lock<std::mutex> lock (m_async->mutex);
+  while (true)
+    {
+      while (!m_async->stop && m_async->full.empty ())
+        {
+          m_async->ready.wait (lock);
+        }
+      if (m_async->full.empty ())
+        {
+          // stopped, and all the blocks are written.
+          break;
+        }
+      std::vector<uint8_t> block;
+      block.swap (m_async->full.front ());
+      m_async->full.pop_front ();
+      m_async->writing = true;
+      lock.unlock ();
+
+      m_file.write ((const char *)&block[0], block.size ());
+      bool failed = m_file.fail ();
+      block.clear ();
+
+      lock.lock ();
+      m_async->writing = false;
+      m_async->failed |= failed;
+      if (m_async->free.size () < m_async->maxBlocks)
+        {
+          m_async->free.push_back (std::vector<uint8_t> ());
+          m_async->free.back ().swap (block);
+        }
+      m_async->written.notify_all ();
+    }
+#endif
+}
+
+void
+PcapFile::WriteData (const uint8_t *data, uint32_t size)
+{
+  if (m_async != 0)
+    {
+      m_async->block.insert (m_async->block.end (), data, data + size);
+    }
+  else
+    {
+      m_file.write ((const char *)data, size);
+    }
+}
+
+uint8_t *
+PcapFile::ReserveData (uint32_t size)
+{
+  NS_ASSERT (m_async != 0);
+  uint32_t used = m_async->block.size ();
+  m_async->block.resize (used + size);
+  return m_async->block.data () + used;
+}
+
+void
+PcapFile::EndRecord (void)
+{
+  if (m_async != 0)
+    {
+      if (m_async->block.size () >= m_async->blockSize)
+        {
+          SubmitBlock ();
+        }
+    }
+  else
+    {
+      NS_BUILD_DEBUG (m_file.flush ());
+    }
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -396,6 +602,11 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   //
   m_swapMode = swapMode | bigEndian;
 
+  if (m_async != 0)
+    {
+      // the pending records go before the new header.
+      Flush ();
+    }
   WriteFileHeader ();
 }
 
@@ -403,7 +614,7 @@ uint32_t
 PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_ASSERT (m_async != 0 || m_file.good ());
 
   uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
 
@@ -422,11 +633,10 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
   // Watch out for memory alignment differences between machines, so write
   // them all individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
+  WriteData ((const uint8_t *)&header.m_tsSec, sizeof(header.m_tsSec));
+  WriteData ((const uint8_t *)&header.m_tsUsec, sizeof(header.m_tsUsec));
+  WriteData ((const uint8_t *)&header.m_inclLen, sizeof(header.m_inclLen));
+  WriteData ((const uint8_t *)&header.m_origLen, sizeof(header.m_origLen));
   return inclLen;
 }
 
@@ -435,8 +645,8 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, ui
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  WriteData (data, inclLen);
+  EndRecord ();
 }
 
 void 
@@ -444,8 +654,15 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
   uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  if (m_async != 0)
+    {
+      p->CopyData (ReserveData (inclLen), inclLen);
+    }
+  else
+    {
+      p->CopyData (&m_file, inclLen);
+    }
+  EndRecord ();
 }
 
 void 
@@ -460,9 +677,19 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
-  inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  if (m_async != 0)
+    {
+      headerBuffer.CopyData (ReserveData (toCopy), toCopy);
+      inclLen -= toCopy;
+      p->CopyData (ReserveData (inclLen), inclLen);
+    }
+  else
+    {
+      headerBuffer.CopyData (&m_file, toCopy);
+      inclLen -= toCopy;
+      p->CopyData (&m_file, inclLen);
+    }
+  EndRecord ();
 }
 
 void
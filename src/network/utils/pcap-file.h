@@ -82,9 +82,38 @@ public:
 
   /**
    * Close the underlying file.
+   *
+   * The records written asynchronously are written first.
    */
   void Close (void);
 
+  /**
+   * \brief Write the records from a background thread
+   *
+   * From this call, the records are serialized into blocks in memory,
+   * and each block of at least \p blockSize bytes is handed to a
+   * background thread which writes it to the file with a single call.
+   * At most \p maxBlocks blocks wait for the thread: Write waits when
+   * they are all in use, so the memory used stays around
+   * 2 * (\p maxBlocks + 1) * \p blockSize bytes.  Flush and Close write
+   * the pending records.
+   *
+   * The file must have been opened for writing and initialized.  If
+   * threads are not supported, the records are still written directly.
+   *
+   * \param blockSize The size of the blocks, in bytes.
+   * \param maxBlocks The maximum number of full blocks waiting to be written.
+   */
+  void EnableAsyncWrite (uint32_t blockSize, uint32_t maxBlocks);
+
+  /**
+   * \brief Write the pending records to the file
+   *
+   * This waits for the background thread to write the records written
+   * asynchronously, if any, and flushes the underlying iostream.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -366,11 +395,43 @@ private:
    */
   void ReadAndVerifyFileHeader (void);
 
+  /**
+   * \brief Write data to the file, or to the current block
+   * \param data the data
+   * \param size the size of the data, in bytes
+   */
+  void WriteData (const uint8_t *data, uint32_t size);
+  /**
+   * \brief Get room for data in the current block
+   * \param size the size of the data, in bytes
+   * \returns a pointer to the room
+   */
+  uint8_t *ReserveData (uint32_t size);
+  /**
+   * \brief Complete the writing of a record
+   */
+  void EndRecord (void);
+  /**
+   * \brief Hand the current block to the background thread
+   */
+  void SubmitBlock (void);
+  /**
+   * \brief Write the blocks handed to the background thread
+   *
+   * This is the body of the background thread.
+   */
+  void WriteBlocks (void);
+
+  /// The state of the asynchronous writes.
+  struct AsyncWriter;
+
   std::string    m_filename;    //!< file name
   std::fstream   m_file;        //!< file stream
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  /// The state of the asynchronous writes, or zero
+  struct AsyncWriter *m_async;
 };
 
 } // namespace ns3
@@ -30,6 +30,7 @@
 #include "ns3/unused.h"
 #include "ns3/log.h"
 #include "ns3/queue-size.h"
+#include "ns3/ring-buffer.h"
 #include <string>
 #include <sstream>
 #include <list>
@@ -295,7 +296,15 @@ private:
  * Queue is a template class. The type of the objects stored within the queue
  * is specified by the type parameter, which can be any class providing a
  * GetSize () method (e.g., Packet, QueueDiscItem, etc.). Subclasses need to
- * implement the DoEnqueue, DoDequeue, DoRemove and DoPeek methods.
+ * implement the Enqueue, Dequeue, Remove and Peek methods, which they build
+ * on the DoEnqueue, DoDequeue, DoRemove and DoPeek methods.
+ *
+ * Subclasses choose how the items are stored when they construct the Queue:
+ * in a std::list (the default), which lets them browse the queue and insert
+ * or remove items at any position through a ConstIterator, or in a RingBuffer,
+ * which is contiguous and does not allocate per item, but only supports the
+ * FIFO operations: enqueue at the tail, and dequeue, remove and peek at the
+ * head.
  *
  * Users of the Queue template class usually hold a queue through a smart pointer,
  * hence forward declaration is recommended to avoid pulling the implementation
@@ -318,7 +327,21 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief How a Queue stores its items
+   */
+  enum Storage
+  {
+    LIST,         /**< A std::list, supporting the ConstIterator based operations */
+    RING_BUFFER   /**< A RingBuffer, supporting the FIFO operations only */
+  };
+
   Queue ();
+  /**
+   * \brief Constructor
+   * \param storage how the queue stores its items
+   */
+  explicit Queue (Storage storage);
   virtual ~Queue ();
 
   /**
@@ -371,6 +394,8 @@ protected:
    *     }
    * \endcode
    *
+   * The queue must use the LIST storage.
+   *
    * \returns a const iterator which refers to the first item in the queue.
    */
   ConstIterator Head (void) const;
@@ -387,6 +412,8 @@ protected:
    *     }
    * \endcode
    *
+   * The queue must use the LIST storage.
+   *
    * \returns a const iterator which indicates past-the-last item in the queue.
    */
   ConstIterator Tail (void) const;
@@ -420,6 +447,31 @@ protected:
    */
   Ptr<const Item> DoPeek (ConstIterator pos) const;
 
+  /**
+   * Push an item at the tail of the queue, whatever the storage
+   * \param item the item to enqueue
+   * \return true if success, false if the packet has been dropped.
+   */
+  bool DoEnqueue (Ptr<Item> item);
+
+  /**
+   * Pull the item at the head of the queue, whatever the storage
+   * \return the item, or 0 if the queue is empty.
+   */
+  Ptr<Item> DoDequeue (void);
+
+  /**
+   * Pull the item at the head of the queue to drop it, whatever the storage
+   * \return the item, or 0 if the queue is empty.
+   */
+  Ptr<Item> DoRemove (void);
+
+  /**
+   * Peek the item at the head of the queue, whatever the storage
+   * \return the item, or 0 if the queue is empty.
+   */
+  Ptr<const Item> DoPeek (void) const;
+
   /**
    * \brief Drop a packet before enqueue
    * \param item item that was dropped
@@ -441,7 +493,28 @@ protected:
   void DropAfterDequeue (Ptr<Item> item);
 
 private:
-  std::list<Ptr<Item> > m_packets;          //!< the items in the queue
+  /**
+   * Check that an item fits in the queue, and drop it otherwise
+   * \param item the item to enqueue
+   * \return true if the item fits in the queue
+   */
+  bool CanEnqueue (Ptr<Item> item);
+
+  /**
+   * Update the statistics and fire the trace of an enqueued item
+   * \param item the enqueued item
+   */
+  void NotifyEnqueue (Ptr<Item> item);
+
+  /**
+   * Update the statistics and fire the trace of a dequeued item
+   * \param item the dequeued item
+   */
+  void NotifyDequeue (Ptr<Item> item);
+
+  Storage m_storage;                        //!< how the items are stored
+  std::list<Ptr<Item> > m_packets;          //!< the items in the queue, with the LIST storage
+  RingBuffer<Ptr<Item> > m_ring;            //!< the items in the queue, with the RING_BUFFER storage
   NS_LOG_TEMPLATE_DECLARE;                  //!< the log component
 
   /// Traced callback: fired when a packet is enqueued
@@ -490,7 +563,15 @@ Queue<Item>::GetTypeId (void)
 
 template <typename Item>
 Queue<Item>::Queue ()
-  : NS_LOG_TEMPLATE_DEFINE ("Queue")
+  : m_storage (LIST),
+    NS_LOG_TEMPLATE_DEFINE ("Queue")
+{
+}
+
+template <typename Item>
+Queue<Item>::Queue (Storage storage)
+  : m_storage (storage),
+    NS_LOG_TEMPLATE_DEFINE ("Queue")
 {
 }
 
@@ -501,19 +582,33 @@ Queue<Item>::~Queue ()
 
 template <typename Item>
 bool
-Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
+Queue<Item>::CanEnqueue (Ptr<Item> item)
 {
-  NS_LOG_FUNCTION (this << item);
+  // Same as GetCurrentSize () + item > GetMaxSize (), without building the
+  // QueueSize objects on every enqueue
+  bool full;
+  if (m_maxSize.GetUnit () == QueueSizeUnit::PACKETS)
+    {
+      full = m_nPackets.Get () + 1 > m_maxSize.GetValue ();
+    }
+  else
+    {
+      full = m_nBytes.Get () + item->GetSize () > m_maxSize.GetValue ();
+    }
 
-  if (GetCurrentSize () + item > GetMaxSize ())
+  if (full)
     {
       NS_LOG_LOGIC ("Queue full -- dropping pkt");
       DropBeforeEnqueue (item);
       return false;
     }
+  return true;
+}
 
-  m_packets.insert (pos, item);
-
+template <typename Item>
+void
+Queue<Item>::NotifyEnqueue (Ptr<Item> item)
+{
   uint32_t size = item->GetSize ();
   m_nBytes += size;
   m_nTotalReceivedBytes += size;
@@ -523,6 +618,36 @@ Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
 
   NS_LOG_LOGIC ("m_traceEnqueue (p)");
   m_traceEnqueue (item);
+}
+
+template <typename Item>
+void
+Queue<Item>::NotifyDequeue (Ptr<Item> item)
+{
+  NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
+  NS_ASSERT (m_nPackets.Get () > 0);
+
+  m_nBytes -= item->GetSize ();
+  m_nPackets--;
+
+  NS_LOG_LOGIC ("m_traceDequeue (p)");
+  m_traceDequeue (item);
+}
+
+template <typename Item>
+bool
+Queue<Item>::DoEnqueue (ConstIterator pos, Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
+  NS_ASSERT_MSG (m_storage == LIST, "Positional enqueue on a queue which does not use the LIST storage");
+
+  if (!CanEnqueue (item))
+    {
+      return false;
+    }
+
+  m_packets.insert (pos, item);
+  NotifyEnqueue (item);
 
   return true;
 }
@@ -532,6 +657,7 @@ Ptr<Item>
 Queue<Item>::DoDequeue (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_storage == LIST, "Positional dequeue on a queue which does not use the LIST storage");
 
   if (m_nPackets.Get () == 0)
     {
@@ -544,14 +670,7 @@ Queue<Item>::DoDequeue (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
-
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
-
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+      NotifyDequeue (item);
     }
   return item;
 }
@@ -561,6 +680,7 @@ Ptr<Item>
 Queue<Item>::DoRemove (ConstIterator pos)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_storage == LIST, "Positional remove on a queue which does not use the LIST storage");
 
   if (m_nPackets.Get () == 0)
     {
@@ -573,16 +693,77 @@ Queue<Item>::DoRemove (ConstIterator pos)
 
   if (item != 0)
     {
-      NS_ASSERT (m_nBytes.Get () >= item->GetSize ());
-      NS_ASSERT (m_nPackets.Get () > 0);
+      // packets are first dequeued and then dropped
+      NotifyDequeue (item);
+      DropAfterDequeue (item);
+    }
+  return item;
+}
+
+template <typename Item>
+bool
+Queue<Item>::DoEnqueue (Ptr<Item> item)
+{
+  NS_LOG_FUNCTION (this << item);
 
-      m_nBytes -= item->GetSize ();
-      m_nPackets--;
+  if (!CanEnqueue (item))
+    {
+      return false;
+    }
 
-      // packets are first dequeued and then dropped
-      NS_LOG_LOGIC ("m_traceDequeue (p)");
-      m_traceDequeue (item);
+  if (m_storage == RING_BUFFER)
+    {
+      m_ring.PushBack (item);
+    }
+  else
+    {
+      m_packets.push_back (item);
+    }
+  NotifyEnqueue (item);
+
+  return true;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoDequeue (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
 
+  Ptr<Item> item;
+  if (m_storage == RING_BUFFER)
+    {
+      item = m_ring.PopFront ();
+    }
+  else
+    {
+      item = m_packets.front ();
+      m_packets.pop_front ();
+    }
+
+  if (item != 0)
+    {
+      NotifyDequeue (item);
+    }
+  return item;
+}
+
+template <typename Item>
+Ptr<Item>
+Queue<Item>::DoRemove (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Ptr<Item> item = DoDequeue ();
+  if (item != 0)
+    {
+      // packets are first dequeued and then dropped
       DropAfterDequeue (item);
     }
   return item;
@@ -604,6 +785,7 @@ Ptr<const Item>
 Queue<Item>::DoPeek (ConstIterator pos) const
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_storage == LIST, "Positional peek on a queue which does not use the LIST storage");
 
   if (m_nPackets.Get () == 0)
     {
@@ -614,15 +796,36 @@ Queue<Item>::DoPeek (ConstIterator pos) const
   return *pos;
 }
 
+template <typename Item>
+Ptr<const Item>
+Queue<Item>::DoPeek (void) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_nPackets.Get () == 0)
+    {
+      NS_LOG_LOGIC ("Queue empty");
+      return 0;
+    }
+
+  if (m_storage == RING_BUFFER)
+    {
+      return m_ring.Front ();
+    }
+  return m_packets.front ();
+}
+
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Head (void) const
 {
+  NS_ASSERT_MSG (m_storage == LIST, "Iterating a queue which does not use the LIST storage");
   return m_packets.cbegin ();
 }
 
 template <typename Item>
 typename Queue<Item>::ConstIterator Queue<Item>::Tail (void) const
 {
+  NS_ASSERT_MSG (m_storage == LIST, "Iterating a queue which does not use the LIST storage");
   return m_packets.cend ();
 }
 
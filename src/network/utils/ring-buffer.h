@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include "ns3/assert.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup queue
+ * \brief A double-ended queue stored in a contiguous, growable ring buffer
+ *
+ * The items are stored in a single array whose size is a power of two,
+ * so that pushing and popping at either end neither allocates nor
+ * follows pointers.  When the array is full, it is replaced with an
+ * array twice as large; the array never shrinks, so a queue which
+ * reached its steady state size no longer allocates.
+ *
+ * Popped slots are reset to a default constructed T, so that the
+ * buffer does not keep references to the popped items.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+  RingBuffer ();
+
+  /**
+   * \return true if the buffer holds no item
+   */
+  bool IsEmpty (void) const;
+  /**
+   * \return the number of items in the buffer
+   */
+  uint32_t GetSize (void) const;
+  /**
+   * \return the number of items the buffer can hold before it grows
+   */
+  uint32_t GetCapacity (void) const;
+
+  /**
+   * \return the first item.  The buffer must not be empty.
+   */
+  T const &Front (void) const;
+  /**
+   * \return the last item.  The buffer must not be empty.
+   */
+  T const &Back (void) const;
+  /**
+   * \param i the position of the item, from the front
+   * \return the item at position i
+   */
+  T const &operator [] (uint32_t i) const;
+
+  /**
+   * \brief Append an item
+   * \param item the item
+   */
+  void PushBack (T const &item);
+  /**
+   * \brief Prepend an item
+   * \param item the item
+   */
+  void PushFront (T const &item);
+  /**
+   * \brief Remove the first item.  The buffer must not be empty.
+   * \return the removed item
+   */
+  T PopFront (void);
+  /**
+   * \brief Remove the last item.  The buffer must not be empty.
+   * \return the removed item
+   */
+  T PopBack (void);
+  /**
+   * \brief Remove all the items, keeping the capacity
+   */
+  void Clear (void);
+
+private:
+  /**
+   * \brief Double the capacity, moving the items to the start of the new array
+   */
+  void Grow (void);
+
+  std::vector<T> m_items; //!< the slots; their number is 0 or a power of two
+  uint32_t m_head;        //!< the slot of the first item
+  uint32_t m_size;        //!< the number of items
+};
+
+
+/**
+ * Implementation of the templates declared above.
+ */
+
+template <typename T>
+RingBuffer<T>::RingBuffer ()
+  : m_head (0),
+    m_size (0)
+{
+}
+
+template <typename T>
+bool
+RingBuffer<T>::IsEmpty (void) const
+{
+  return m_size == 0;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetSize (void) const
+{
+  return m_size;
+}
+
+template <typename T>
+uint32_t
+RingBuffer<T>::GetCapacity (void) const
+{
+  return m_items.size ();
+}
+
+template <typename T>
+T const &
+RingBuffer<T>::Front (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return m_items[m_head];
+}
+
+template <typename T>
+T const &
+RingBuffer<T>::Back (void) const
+{
+  NS_ASSERT (m_size > 0);
+  return m_items[(m_head + m_size - 1) & (m_items.size () - 1)];
+}
+
+template <typename T>
+T const &
+RingBuffer<T>::operator [] (uint32_t i) const
+{
+  NS_ASSERT (i < m_size);
+  return m_items[(m_head + i) & (m_items.size () - 1)];
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushBack (T const &item)
+{
+  if (m_size == m_items.size ())
+    {
+      Grow ();
+    }
+  m_items[(m_head + m_size) & (m_items.size () - 1)] = item;
+  m_size++;
+}
+
+template <typename T>
+void
+RingBuffer<T>::PushFront (T const &item)
+{
+  if (m_size == m_items.size ())
+    {
+      Grow ();
+    }
+  m_head = (m_head - 1) & (m_items.size () - 1);
+  m_items[m_head] = item;
+  m_size++;
+}
+
+template <typename T>
+T
+RingBuffer<T>::PopFront (void)
+{
+  NS_ASSERT (m_size > 0);
+  T item = m_items[m_head];
+  m_items[m_head] = T ();
+  m_head = (m_head + 1) & (m_items.size () - 1);
+  m_size--;
+  return item;
+}
+
+template <typename T>
+T
+RingBuffer<T>::PopBack (void)
+{
+  NS_ASSERT (m_size > 0);
+  uint32_t slot = (m_head + m_size - 1) & (m_items.size () - 1);
+  T item = m_items[slot];
+  m_items[slot] = T ();
+  m_size--;
+  return item;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Clear (void)
+{
+  while (m_size > 0)
+    {
+      PopBack ();
+    }
+  m_head = 0;
+}
+
+template <typename T>
+void
+RingBuffer<T>::Grow (void)
+{
+  uint32_t capacity = m_items.empty () ? 8 : 2 * m_items.size ();
+  std::vector<T> items (capacity);
+  for (uint32_t i = 0; i < m_size; i++)
+    {
+      items[i] = m_items[(m_head + i) & (m_items.size () - 1)];
+    }
+  m_items.swap (items);
+  m_head = 0;
+}
+
+} // namespace ns3
+
+#endif /* RING_BUFFER_H */
@@ -69,7 +69,7 @@ public:
    * \brief Attach a given netdevice to this channel
    * \param device pointer to the netdevice to attach to the channel
    */
-  void Attach (Ptr<PointToPointNetDevice> device);
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
 
   /**
    * \brief Transmit a packet over this channel
@@ -23,6 +23,7 @@
 #include "point-to-point-remote-channel.h"
 #include "point-to-point-net-device.h"
 #include "ns3/packet.h"
+#include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/mpi-interface.h"
@@ -47,12 +48,30 @@ PointToPointRemoteChannel::GetTypeId (void)
 PointToPointRemoteChannel::PointToPointRemoteChannel ()
   : PointToPointChannel ()
 {
+  for (int i = 0; i < N_DEVICES; ++i)
+    {
+      m_devices[i] = 0;
+      m_nodeIds[i] = 0;
+      m_ifIndexes[i] = 0;
+    }
 }
 
 PointToPointRemoteChannel::~PointToPointRemoteChannel ()
 {
 }
 
+void
+PointToPointRemoteChannel::Attach (Ptr<PointToPointNetDevice> device)
+{
+  NS_LOG_FUNCTION (this << device);
+  PointToPointChannel::Attach (device);
+
+  uint32_t i = GetNDevices () - 1;
+  m_devices[i] = PeekPointer (device);
+  m_nodeIds[i] = device->GetNode ()->GetId ();
+  m_ifIndexes[i] = device->GetIfIndex ();
+}
+
 bool
 PointToPointRemoteChannel::TransmitStart (
   Ptr<const Packet> p,
@@ -64,16 +83,13 @@ PointToPointRemoteChannel::TransmitStart (
 
   IsInitialized ();
 
-  uint32_t wire = src == GetSource (0) ? 0 : 1;
-  Ptr<PointToPointNetDevice> dst = GetDestination (wire);
+  // The destination device may be run by another thread of a
+  // ThreadedSimulatorImpl: only use the values recorded by Attach.
+  uint32_t dst = PeekPointer (src) == m_devices[0] ? 1 : 0;
 
-#ifdef NS3_MPI
   // Calculate the rxTime (absolute)
   Time rxTime = Simulator::Now () + txTime + GetDelay ();
-  MpiInterface::SendPacket (p->Copy (), rxTime, dst->GetNode ()->GetId (), dst->GetIfIndex ());
-#else
-  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-#endif
+  MpiInterface::SendPacket (p->Copy (), rxTime, m_nodeIds[dst], m_ifIndexes[dst]);
   return true;
 }
 
@@ -58,6 +58,16 @@ public:
    */
   ~PointToPointRemoteChannel ();
 
+  /**
+   * \brief Attach a given netdevice to this channel
+   *
+   * The node and interface index of the device are recorded, so that
+   * transmitting a packet does not touch the remote device.
+   *
+   * \param device pointer to the netdevice to attach to the channel
+   */
+  virtual void Attach (Ptr<PointToPointNetDevice> device);
+
   /**
    * \brief Transmit the packet
    *
@@ -68,6 +78,13 @@ public:
    */
   virtual bool TransmitStart (Ptr<const Packet> p, Ptr<PointToPointNetDevice> src,
                               Time txTime);
+
+private:
+  static const int N_DEVICES = 2;
+
+  PointToPointNetDevice *m_devices[N_DEVICES]; //!< Attached devices, not reference-counted
+  uint32_t m_nodeIds[N_DEVICES];               //!< Node ids of the attached devices
+  uint32_t m_ifIndexes[N_DEVICES];             //!< Interface indexes of the attached devices
 };
 
 } // namespace ns3
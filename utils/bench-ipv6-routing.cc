@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-static-routing-helper.h"
+#include "ns3/ipv6-static-routing.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/simple-net-device.h"
+
+/**
+ * \file
+ * \ingroup ipv6Routing
+ * Benchmark of the Ipv6StaticRouting lookups, for several table sizes.
+ *
+ * For each size, a node is given that many routes, a mix of /64
+ * network routes and /128 host routes as found on the spines of a
+ * data-center fabric, through two interfaces.  The lookups are made
+ * through RouteOutput, for destinations drawn from the routed
+ * prefixes, so that most of them match a /64 or a /128 route.  The
+ * results are printed as CSV, one line per size.
+ */
+
+using namespace ns3;
+
+/**
+ * Draw an address in 2001:db8::/32, whose /64 prefix is one of the
+ * first \p prefixes ones.
+ *
+ * \param [in] rng The random variable.
+ * \param [in] prefixes The number of /64 prefixes.
+ * \returns The address.
+ */
+Ipv6Address
+DrawAddress (Ptr<UniformRandomVariable> rng, uint32_t prefixes)
+{
+  uint32_t prefix = rng->GetInteger (0, prefixes - 1);
+  uint32_t host = rng->GetInteger (1, 0xffff);
+  uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+  bytes[4] = prefix >> 24;
+  bytes[5] = prefix >> 16;
+  bytes[6] = prefix >> 8;
+  bytes[7] = prefix;
+  bytes[14] = host >> 8;
+  bytes[15] = host;
+  return Ipv6Address (bytes);
+}
+
+/**
+ * Run the benchmark for one table size.
+ *
+ * \param [in] routes The number of routes.
+ * \param [in] lookups The number of lookups.
+ * \param [in] hosts The fraction of /128 routes.
+ */
+void
+Bench (uint32_t routes, uint32_t lookups, double hosts)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  uint32_t ifIndex[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      ifIndex[i] = ipv6->AddInterface (device);
+      ipv6->SetUp (ifIndex[i]);
+    }
+  Ptr<Ipv6StaticRouting> routing = Ipv6StaticRoutingHelper ().GetStaticRouting (ipv6);
+
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  uint32_t prefixes = std::max (1U, (uint32_t)(routes * (1 - hosts)));
+  std::vector<Ipv6Address> destinations;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      destinations.push_back (DrawAddress (rng, prefixes));
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      Ipv6Address gateway ("fe80::1");
+      if (rng->GetValue () < hosts)
+        {
+          routing->AddHostRouteTo (DrawAddress (rng, prefixes), gateway, ifIndex[i % 2]);
+        }
+      else
+        {
+          uint8_t bytes[16] = { 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+          uint32_t prefix = i % prefixes;
+          bytes[4] = prefix >> 24;
+          bytes[5] = prefix >> 16;
+          bytes[6] = prefix >> 8;
+          bytes[7] = prefix;
+          routing->AddNetworkRouteTo (Ipv6Address (bytes), Ipv6Prefix (64), gateway, ifIndex[i % 2]);
+        }
+    }
+  int64_t addMs = clock.End ();
+
+  Ipv6Header header;
+  Socket::SocketErrno err;
+  uint32_t found = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      header.SetDestinationAddress (destinations[i % destinations.size ()]);
+      if (routing->RouteOutput (0, header, 0, err) != 0)
+        {
+          found++;
+        }
+    }
+  int64_t lookupMs = clock.End ();
+
+  std::cout << routes << ","
+            << (addMs > 0 ? routes * 1000.0 / addMs : 0) << ","
+            << lookupMs * 1e6 / lookups << ","
+            << found * 1.0 / lookups
+            << std::endl;
+
+  Simulator::Destroy ();
+}
+
+
+int main (int argc, char *argv[])
+{
+  std::string sizes = "1000,10000,100000,1000000";
+  uint32_t lookups = 1000000;
+  double hosts = 0.25;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the Ipv6StaticRouting lookups for several table sizes.\n"
+             "\n"
+             "The routes are /64 network routes and a fraction of /128 host routes.\n"
+             "The results are printed as CSV, one line per table size: the number\n"
+             "of routes, the routes added per second, the time per lookup (ns) and\n"
+             "the fraction of the lookups which found a route.");
+  cmd.AddValue ("sizes", "comma-separated list of table sizes", sizes);
+  cmd.AddValue ("lookups", "number of lookups per table size", lookups);
+  cmd.AddValue ("hosts", "fraction of /128 host routes", hosts);
+  cmd.Parse (argc, argv);
+
+  std::cout << "routes,adds/s,lookup ns,found" << std::endl;
+  std::istringstream list (sizes);
+  std::string size;
+  while (std::getline (list, size, ','))
+    {
+      if (!size.empty ())
+        {
+          Bench (std::stoul (size), lookups, hosts);
+        }
+    }
+
+  return 0;
+}
@@ -282,6 +282,33 @@ benchC (uint32_t n)
   }
 }
 
+static void
+benchPeek (uint32_t n)
+{
+  BenchHeader<25> ipv4;
+  BenchHeader<8> udp;
+
+  for (uint32_t i = 0; i < n; i++) {
+    Ptr<Packet> p = Create<Packet> (2000);
+    p->AddHeader (udp);
+    p->AddHeader (ipv4);
+    Ptr<Packet> o = p->Copy ();
+    // Several layers look at the same headers before the one which
+    // removes them, as the queue disc filters, the flow monitor
+    // classifiers and the demultiplexers do.
+    for (uint32_t j = 0; j < 3; j++)
+      {
+        o->PeekHeader (ipv4);
+      }
+    o->RemoveHeader (ipv4);
+    for (uint32_t j = 0; j < 3; j++)
+      {
+        o->PeekHeader (udp);
+      }
+    o->RemoveHeader (udp);
+  }
+}
+
 static void
 benchFragment (uint32_t n)
 {
@@ -310,6 +337,31 @@ benchFragment (uint32_t n)
   }
 }
 
+static void
+benchCopyTags (uint32_t n)
+{
+  BenchTag<4> flowId;
+  BenchTag<1> priority;
+  BenchTag<8> bearer;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddByteTag (flowId);
+      p->AddPacketTag (priority);
+      p->AddPacketTag (bearer);
+      // Each copy changes its tags, as the layers which forward a
+      // copy of the packet do.
+      for (uint32_t j = 0; j < 3; j++)
+        {
+          Ptr<Packet> o = p->Copy ();
+          o->ReplacePacketTag (priority);
+          o->RemovePacketTag (bearer);
+          o->AddByteTag (flowId);
+        }
+    }
+}
+
 static void
 benchByteTags (uint32_t n)
 {
@@ -362,14 +414,27 @@ int main (int argc, char *argv[])
   uint32_t n = 0;
   uint32_t minIterations = 1;
   bool enablePrinting = false;
+  bool enableHeaderCache = false;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark Packet class");
   cmd.AddValue ("n", "number of iterations", n);
   cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
   cmd.AddValue ("enable-printing", "enable packet printing", enablePrinting);
+  cmd.AddValue ("enable-header-cache", "enable the packet header cache", enableHeaderCache);
   cmd.Parse (argc, argv);
 
+  if (enablePrinting)
+    {
+      // the layout and the sampling of the metadata are set by the
+      // --PacketMetadataCompact and --PacketMetadataSampling global values
+      Packet::EnablePrinting ();
+    }
+  if (enableHeaderCache)
+    {
+      Packet::EnableHeaderCache ();
+    }
+
   if (n == 0)
     {
       std::cerr << "Error-- number of packets must be specified " <<
@@ -383,8 +448,10 @@ int main (int argc, char *argv[])
   runBench (&benchB, n, minIterations, "Just add headers");
   runBench (&benchC, n, minIterations, "Remove by func call");
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
+  runBench (&benchPeek, n, minIterations, "Peek headers three times, remove them");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchCopyTags, n, minIterations, "Copy packets with small tags, change them");
 
   return 0;
 }
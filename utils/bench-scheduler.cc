@@ -0,0 +1,484 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Benchmark of the Scheduler subclasses, driven directly rather than
+ * through the Simulator, with several event-time distributions.
+ *
+ * Each scheduler is run in turn against each distribution, in a
+ * forked process so that its peak memory use can be measured.  A run
+ * is made of four phases:
+ *
+ *  - fill: insert the event population;
+ *  - cancel: remove a random subset of the population, as
+ *    EventId::Cancel does when a timer is stopped, and insert it
+ *    back (the second insertion is not timed);
+ *  - hold: remove the next event and insert a new one, as each
+ *    simulation event does in the steady state;
+ *  - drain: remove all the remaining events.
+ *
+ * The delays are drawn before the run starts, so that only the
+ * scheduler operations are timed.  The results are printed as CSV,
+ * one line per run.
+ */
+
+using namespace ns3;
+
+/// A distribution: its name and the delays drawn from it.
+struct Distribution
+{
+  std::string name;                ///< name, in the CSV output
+  std::vector<uint64_t> delays;    ///< the event delays, in time steps
+};
+
+/// The result of a run.
+struct Result
+{
+  double inserts;       ///< fill phase, inserts per second
+  double cancelNs;      ///< cancel phase, nanoseconds per Remove
+  double holds;         ///< hold phase, RemoveNext + Insert per second
+  double removes;       ///< drain phase, RemoveNext per second
+  long peakRss;         ///< peak resident set size, in KiB
+  long growthRss;       ///< growth of the peak RSS during the run, in KiB
+};
+
+/// The event shared by all the runs, never invoked.
+void
+Noop (void)
+{
+}
+
+/**
+ * \returns The peak resident set size of the process, in KiB.
+ */
+long
+GetPeakRss (void)
+{
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+/**
+ * \param [in] start The start of the interval.
+ * \returns The time elapsed since \p start, in seconds.
+ */
+double
+Elapsed (const std::chrono::steady_clock::time_point &start)
+{
+  std::chrono::duration<double> d = std::chrono::steady_clock::now () - start;
+  return d.count ();
+}
+
+/**
+ * Run a scheduler against a distribution.
+ *
+ * \param [in] type The scheduler TypeId.
+ * \param [in] dist The distribution.
+ * \param [in] pop The event population.
+ * \param [in] total The number of hold operations.
+ * \param [in] cancel The fraction of the population to cancel.
+ * \param [in] seed The seed of the cancelled events choice.
+ * \returns The measurements.
+ */
+Result
+RunScheduler (TypeId type, const Distribution &dist,
+              uint32_t pop, uint32_t total, double cancel, uint32_t seed)
+{
+  Result result;
+  long startRss = GetPeakRss ();
+
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  Ptr<Scheduler> scheduler = factory.Create<Scheduler> ();
+
+  // The schedulers never invoke the events: they can all share one.
+  EventImpl *impl = MakeEvent (&Noop);
+  const std::vector<uint64_t> &delays = dist.delays;
+  std::size_t next = 0;
+  uint32_t uid = 4;
+
+  std::vector<Scheduler::Event> events;
+  events.reserve (pop);
+  for (uint32_t i = 0; i < pop; i++)
+    {
+      Scheduler::Event ev;
+      ev.impl = impl;
+      ev.key.m_ts = delays[next];
+      ev.key.m_context = 0;
+      ev.key.m_uid = uid++;
+      events.push_back (ev);
+      next = (next + 1) % delays.size ();
+    }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < pop; i++)
+    {
+      scheduler->Insert (events[i]);
+    }
+  result.inserts = pop / Elapsed (start);
+
+  std::vector<Scheduler::Event> cancelled;
+  std::mt19937 rng (seed);
+  std::shuffle (events.begin (), events.end (), rng);
+  cancelled.assign (events.begin (), events.begin () + (std::size_t)(cancel * pop));
+  start = std::chrono::steady_clock::now ();
+  for (std::size_t i = 0; i < cancelled.size (); i++)
+    {
+      scheduler->Remove (cancelled[i]);
+    }
+  result.cancelNs = cancelled.empty () ? 0 : Elapsed (start) * 1e9 / cancelled.size ();
+  for (std::size_t i = 0; i < cancelled.size (); i++)
+    {
+      scheduler->Insert (cancelled[i]);
+    }
+  std::vector<Scheduler::Event> ().swap (events);
+  std::vector<Scheduler::Event> ().swap (cancelled);
+
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < total && !scheduler->IsEmpty (); i++)
+    {
+      Scheduler::Event ev = scheduler->RemoveNext ();
+      ev.key.m_ts += delays[next];
+      ev.key.m_uid = uid++;
+      scheduler->Insert (ev);
+      next = (next + 1) % delays.size ();
+    }
+  result.holds = total / Elapsed (start);
+
+  start = std::chrono::steady_clock::now ();
+  uint32_t removed = 0;
+  while (!scheduler->IsEmpty ())
+    {
+      scheduler->RemoveNext ();
+      removed++;
+    }
+  result.removes = removed / Elapsed (start);
+
+  result.peakRss = GetPeakRss ();
+  result.growthRss = result.peakRss - startRss;
+  impl->Unref ();
+  return result;
+}
+
+/**
+ * Draw delays from a random variable.
+ *
+ * \param [in] name The distribution name.
+ * \param [in] rv The random variable, in time steps.
+ * \param [in] n The number of delays.
+ * \returns The distribution.
+ */
+Distribution
+Draw (std::string name, Ptr<RandomVariableStream> rv, uint32_t n)
+{
+  Distribution dist;
+  dist.name = name;
+  dist.delays.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      dist.delays.push_back (rv->GetInteger ());
+    }
+  return dist;
+}
+
+/**
+ * Draw delays from a timer-heavy bimodal distribution: most events
+ * are short (packet transmissions, exponential with the given mean),
+ * the others are long timers, such as TCP retransmission timeouts,
+ * uniform within 10% of a much longer delay.
+ *
+ * \param [in] mean The mean of the short delays, in time steps.
+ * \param [in] timers The fraction of timers.
+ * \param [in] n The number of delays.
+ * \returns The distribution.
+ */
+Distribution
+DrawBimodal (double mean, double timers, uint32_t n)
+{
+  Ptr<UniformRandomVariable> choice = CreateObject<UniformRandomVariable> ();
+  Ptr<ExponentialRandomVariable> shortDelay = CreateObject<ExponentialRandomVariable> ();
+  shortDelay->SetAttribute ("Mean", DoubleValue (mean));
+  Ptr<UniformRandomVariable> longDelay = CreateObject<UniformRandomVariable> ();
+  longDelay->SetAttribute ("Min", DoubleValue (mean * 1000 * 0.9));
+  longDelay->SetAttribute ("Max", DoubleValue (mean * 1000 * 1.1));
+
+  Distribution dist;
+  dist.name = "bimodal";
+  dist.delays.reserve (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<RandomVariableStream> rv = shortDelay;
+      if (choice->GetValue () < timers)
+        {
+          rv = longDelay;
+        }
+      dist.delays.push_back (rv->GetInteger ());
+    }
+  return dist;
+}
+
+/**
+ * Read the delays of the events of a trace.
+ *
+ * Two formats are understood: the JSON traces written by DesMetrics
+ * (configure with --enable-des-metrics, and run any script which
+ * uses CommandLine), from which the delay of each event is its
+ * timestamp minus the time it was scheduled at, both in time steps;
+ * and the ascii files of relative event times in seconds read by
+ * bench-simulator.
+ *
+ * \param [in] filename The trace file.
+ * \returns The distribution.
+ */
+Distribution
+ReadTrace (std::string filename)
+{
+  Distribution dist;
+  dist.name = "trace:" + filename.substr (filename.find_last_of ('/') + 1);
+  std::ifstream input (filename.c_str ());
+  if (!input.good ())
+    {
+      NS_FATAL_ERROR ("Can't open " << filename);
+    }
+  std::stringstream content;
+  content << input.rdbuf ();
+  std::string s = content.str ();
+
+  std::size_t pos = s.find ("\"events\"");
+  if (pos != std::string::npos)
+    {
+      // Each event is ["sender", "now", "receiver", "timestamp"]
+      while ((pos = s.find ('[', pos + 1)) != std::string::npos)
+        {
+          std::vector<std::string> fields;
+          std::size_t end = s.find (']', pos);
+          if (end == std::string::npos)
+            {
+              break;
+            }
+          std::size_t quote = pos;
+          while (fields.size () < 4
+                 && (quote = s.find ('"', quote + 1)) < end)
+            {
+              std::size_t close = s.find ('"', quote + 1);
+              fields.push_back (s.substr (quote + 1, close - quote - 1));
+              quote = close;
+            }
+          if (fields.size () == 4)
+            {
+              uint64_t now = std::stoull (fields[1]);
+              uint64_t ts = std::stoull (fields[3]);
+              dist.delays.push_back (ts - now);
+            }
+          // The '[' which opens the event list is followed by the
+          // first event: skip to its end either way.
+          pos = end;
+        }
+    }
+  else
+    {
+      std::istringstream values (s);
+      std::string word;
+      while (values >> word)
+        {
+          std::istringstream value (word);
+          double seconds;
+          if (value >> seconds)
+            {
+              dist.delays.push_back (Seconds (seconds).GetTimeStep ());
+            }
+        }
+    }
+  if (dist.delays.empty ())
+    {
+      NS_FATAL_ERROR ("No event found in " << filename);
+    }
+  return dist;
+}
+
+/**
+ * Split a comma-separated list.
+ *
+ * \param [in] list The list.
+ * \returns The items of \p list.
+ */
+std::vector<std::string>
+Split (std::string list)
+{
+  std::vector<std::string> items;
+  std::istringstream is (list);
+  std::string item;
+  while (std::getline (is, item, ','))
+    {
+      if (!item.empty ())
+        {
+          items.push_back (item);
+        }
+    }
+  return items;
+}
+
+
+int main (int argc, char *argv[])
+{
+  uint32_t pop   =  10000;
+  uint32_t total = 100000;
+  double mean = 100;
+  double timers = 0.1;
+  double cancel = 0.1;
+  std::string schedulers = "";
+  std::string distributions = "uniform,exponential,bimodal";
+  std::string traces = "";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the event schedulers with several event-time distributions.\n"
+             "\n"
+             "The distributions are:\n"
+             "  uniform:     uniform in [0, 2 * mean],\n"
+             "  exponential: exponential with the given mean,\n"
+             "  bimodal:     exponential with the given mean, mixed with a fraction\n"
+             "               of long timers around 1000 times the mean,\n"
+             "and the delays of the events of the --traces files, which are either\n"
+             "DesMetrics JSON traces or ascii relative event times in seconds\n"
+             "(use --distributions=none to only replay traces).\n"
+             "All times are in time steps (ns by default).\n"
+             "\n"
+             "The results are printed as CSV, one line per scheduler and distribution.");
+  cmd.AddValue ("schedulers", "comma-separated list of scheduler TypeIds (default: all)", schedulers);
+  cmd.AddValue ("distributions", "comma-separated list of distributions", distributions);
+  cmd.AddValue ("traces", "comma-separated list of trace files", traces);
+  cmd.AddValue ("pop",    "event population size", pop);
+  cmd.AddValue ("total",  "number of hold operations", total);
+  cmd.AddValue ("mean",   "mean event delay", mean);
+  cmd.AddValue ("timers", "fraction of long timers in the bimodal distribution", timers);
+  cmd.AddValue ("cancel", "fraction of the population cancelled", cancel);
+  cmd.Parse (argc, argv);
+
+  std::vector<TypeId> types;
+  if (schedulers.empty ())
+    {
+      for (uint32_t i = 0; i < TypeId::GetRegisteredN (); i++)
+        {
+          TypeId tid = TypeId::GetRegistered (i);
+          if (tid != Scheduler::GetTypeId ()
+              && tid.IsChildOf (Scheduler::GetTypeId ())
+              && tid.HasConstructor ())
+            {
+              types.push_back (tid);
+            }
+        }
+    }
+  else
+    {
+      std::vector<std::string> names = Split (schedulers);
+      for (std::size_t i = 0; i < names.size (); i++)
+        {
+          types.push_back (TypeId::LookupByName (names[i]));
+        }
+    }
+
+  std::vector<Distribution> dists;
+  std::vector<std::string> names = Split (distributions);
+  for (std::size_t i = 0; i < names.size (); i++)
+    {
+      if (names[i] == "uniform")
+        {
+          Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+          rv->SetAttribute ("Max", DoubleValue (2 * mean));
+          dists.push_back (Draw (names[i], rv, pop + total));
+        }
+      else if (names[i] == "exponential")
+        {
+          Ptr<ExponentialRandomVariable> rv = CreateObject<ExponentialRandomVariable> ();
+          rv->SetAttribute ("Mean", DoubleValue (mean));
+          dists.push_back (Draw (names[i], rv, pop + total));
+        }
+      else if (names[i] == "bimodal")
+        {
+          dists.push_back (DrawBimodal (mean, timers, pop + total));
+        }
+      else if (names[i] != "none")
+        {
+          NS_FATAL_ERROR ("Unknown distribution " << names[i]);
+        }
+    }
+  names = Split (traces);
+  for (std::size_t i = 0; i < names.size (); i++)
+    {
+      dists.push_back (ReadTrace (names[i]));
+    }
+
+  std::cout << "scheduler,distribution,population,holds,inserts_per_s,"
+            << "cancel_ns,holds_per_s,removes_per_s,peak_rss_kb,rss_growth_kb"
+            << std::endl;
+  for (std::size_t d = 0; d < dists.size (); d++)
+    {
+      for (std::size_t t = 0; t < types.size (); t++)
+        {
+          // Run each scheduler in its own process, so that the peak
+          // RSS and the state of the allocator do not depend on the
+          // runs before it.
+          std::cout.flush ();
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("fork failed");
+            }
+          if (pid == 0)
+            {
+              Result r = RunScheduler (types[t], dists[d], pop, total, cancel, d + 1);
+              std::cout << types[t].GetName () << "," << dists[d].name << ","
+                        << pop << "," << total << ","
+                        << r.inserts << "," << r.cancelNs << ","
+                        << r.holds << "," << r.removes << ","
+                        << r.peakRss << "," << r.growthRss << std::endl;
+              _exit (0);
+            }
+          int status;
+          waitpid (pid, &status, 0);
+          if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            {
+              std::cerr << types[t].GetName () << "," << dists[d].name
+                        << ": run failed" << std::endl;
+            }
+        }
+    }
+  return 0;
+}
@@ -0,0 +1,301 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2018
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup time
+ * Benchmark of the conversions between Time and the time units, for
+ * each resolution.
+ *
+ * Each conversion of Time is timed against the generic path it
+ * replaces:
+ *
+ *  - to-integer: Time::ToInteger (GetMilliSeconds () and the like),
+ *    against a Time and a multiply or a hardware divide by the unit
+ *    factor;
+ *  - from-integer: Time::FromInteger (MilliSeconds () and the like),
+ *    against a multiply or a hardware divide by the unit factor and
+ *    a Time;
+ *  - to-double: Time::ToDouble (GetSeconds () and the like), against
+ *    the int64x64_t conversion Time::To ().GetDouble ().
+ *
+ * The results of both paths are compared on every value, and the
+ * number of differences is reported.  Time::SetResolution can only be
+ * called once, so each resolution runs in a forked process.  The
+ * results are printed as CSV, one line per resolution, unit and
+ * conversion.
+ */
+
+using namespace ns3;
+
+namespace {
+
+/// The names of the units, in the order of Time::Unit.
+const char * const g_unitNames[Time::LAST] = {
+  "Y", "D", "H", "MIN", "S", "MS", "US", "NS", "PS", "FS"
+};
+
+/// Keep the results alive, so that the conversions are not optimized out.
+volatile int64_t g_sink;
+
+/// The result of timing the two paths of a conversion.
+struct Result
+{
+  double referenceNs;        ///< generic path, ns per conversion
+  double fastNs;             ///< new path, ns per conversion
+  uint64_t differences;      ///< values converted differently by the two paths
+};
+
+/**
+ * Time a conversion over the values.
+ *
+ * \param [in] values The values to convert.
+ * \param [in] repeat The number of passes over the values.
+ * \param [in] convert The conversion.
+ * \param [out] results The result of each conversion.
+ * \returns The time of a conversion, in ns.
+ */
+template <typename T, typename F>
+double
+Measure (const std::vector<int64_t> &values, uint32_t repeat, F convert,
+         std::vector<T> &results)
+{
+  results.resize (values.size ());
+  int64_t sum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  for (uint32_t r = 0; r < repeat; r++)
+    {
+      for (std::size_t i = 0; i < values.size (); i++)
+        {
+          T result = convert (values[i]);
+          results[i] = result;
+          sum += static_cast<int64_t> (result);
+        }
+    }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+  g_sink = sum;
+  return 1e9 * elapsed.count () / (static_cast<double> (repeat) * values.size ());
+}
+
+/**
+ * Compare the results of two paths, bit for bit.
+ *
+ * \param [in] a The results of the first path.
+ * \param [in] b The results of the second path.
+ * \returns The number of different results.
+ */
+template <typename T>
+uint64_t
+Differences (const std::vector<T> &a, const std::vector<T> &b)
+{
+  uint64_t count = 0;
+  for (std::size_t i = 0; i < a.size (); i++)
+    {
+      if (std::memcmp (&a[i], &b[i], sizeof (T)) != 0)
+        {
+          count++;
+        }
+    }
+  return count;
+}
+
+/**
+ * Draw values spread evenly over the bit lengths up to a limit,
+ * of both signs.
+ *
+ * \param [in] count The number of values.
+ * \param [in] limit The largest absolute value.
+ * \param [in] positive Draw only positive values.
+ * \param [in,out] rng The random number generator.
+ * \returns The values.
+ */
+std::vector<int64_t>
+DrawValues (uint32_t count, uint64_t limit, bool positive, std::mt19937_64 &rng)
+{
+  int bits = 0;
+  while (bits < 63 && (static_cast<uint64_t> (1) << bits) <= limit)
+    {
+      bits++;
+    }
+  std::vector<int64_t> values;
+  values.reserve (count);
+  while (values.size () < count)
+    {
+      int length = static_cast<int> (rng () % (bits + 1));
+      uint64_t v = length == 0 ? 0 : rng () >> (64 - length);
+      if (v > limit)
+        {
+          continue;
+        }
+      bool negative = !positive && (rng () & 1);
+      values.push_back (negative ? -static_cast<int64_t> (v) : static_cast<int64_t> (v));
+    }
+  return values;
+}
+
+/**
+ * Print a result as a CSV line.
+ *
+ * \param [in] resolution The resolution.
+ * \param [in] unit The unit.
+ * \param [in] conversion The name of the conversion.
+ * \param [in] divide Whether the conversion divides by the unit factor.
+ * \param [in] result The result.
+ */
+void
+Print (Time::Unit resolution, Time::Unit unit, std::string conversion,
+       bool divide, const Result &result)
+{
+  std::cout << g_unitNames[resolution] << ","
+            << g_unitNames[unit] << ","
+            << conversion << ","
+            << (divide ? "divide" : "multiply") << ","
+            << result.referenceNs << ","
+            << result.fastNs << ","
+            << result.referenceNs / result.fastNs << ","
+            << result.differences << std::endl;
+}
+
+/**
+ * Run the benchmark for a resolution.
+ *
+ * \param [in] resolution The resolution.
+ * \param [in] count The number of values converted.
+ * \param [in] repeat The number of passes over the values.
+ */
+void
+RunResolution (Time::Unit resolution, uint32_t count, uint32_t repeat)
+{
+  Time::SetResolution (resolution);
+  std::mt19937_64 rng (1);
+  const uint64_t max = std::numeric_limits<int64_t>::max ();
+
+  for (int u = 0; u < Time::LAST; u++)
+    {
+      Time::Unit unit = static_cast<Time::Unit> (u);
+      // The factor between the unit and the resolution, as the
+      // generic paths use it, hidden from the optimizer.
+      volatile int64_t hidden;
+      bool toDivide = unit < resolution;
+      hidden = toDivide ? Time::FromInteger (1, unit).GetTimeStep () : Time (1).ToInteger (unit);
+      const int64_t factor = hidden;
+      Result result;
+
+      // to-integer
+      std::vector<int64_t> values = DrawValues (count, toDivide ? max : max / factor, false, rng);
+      std::vector<int64_t> reference;
+      std::vector<int64_t> fast;
+      result.referenceNs = Measure (values, repeat, [factor, toDivide] (int64_t v)
+                                    {
+                                      int64_t step = TimeStep (v).GetTimeStep ();
+                                      return toDivide ? step / factor : step * factor;
+                                    },
+                                    reference);
+      result.fastNs = Measure (values, repeat, [unit] (int64_t v)
+                               { return TimeStep (v).ToInteger (unit); },
+                               fast);
+      result.differences = Differences (reference, fast);
+      Print (resolution, unit, "to-integer", toDivide, result);
+
+      // from-integer
+      bool fromDivide = !toDivide && factor != 1;
+      values = DrawValues (count, fromDivide ? max : max / factor, true, rng);
+      result.referenceNs = Measure (values, repeat, [factor, fromDivide] (int64_t v)
+                                    {
+                                      uint64_t value = v;
+                                      value = fromDivide ? value / factor : value * factor;
+                                      return TimeStep (value).GetTimeStep ();
+                                    },
+                                    reference);
+      result.fastNs = Measure (values, repeat, [unit] (int64_t v)
+                               { return Time::FromInteger (v, unit).GetTimeStep (); },
+                               fast);
+      result.differences = Differences (reference, fast);
+      Print (resolution, unit, "from-integer", fromDivide, result);
+
+      // to-double
+      std::vector<double> referenceDouble;
+      std::vector<double> fastDouble;
+      values = DrawValues (count, (static_cast<uint64_t> (1) << 53) - 1, false, rng);
+      result.referenceNs = Measure (values, repeat, [unit] (int64_t v)
+                                    { return TimeStep (v).To (unit).GetDouble (); },
+                                    referenceDouble);
+      result.fastNs = Measure (values, repeat, [unit] (int64_t v)
+                               { return TimeStep (v).ToDouble (unit); },
+                               fastDouble);
+      result.differences = Differences (referenceDouble, fastDouble);
+      Print (resolution, unit, "to-double", toDivide, result);
+    }
+}
+
+} // unnamed namespace
+
+
+int main (int argc, char *argv[])
+{
+  uint32_t count = 1 << 16;
+  uint32_t repeat = 50;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark of the conversions between Time and the time units.\n"
+             "\n"
+             "For each resolution, unit and conversion, prints the time of the\n"
+             "generic path and of the new one, in ns per conversion, their ratio\n"
+             "and the number of values they convert differently.");
+  cmd.AddValue ("count",  "number of values converted", count);
+  cmd.AddValue ("repeat", "number of passes over the values", repeat);
+  cmd.Parse (argc, argv);
+
+  std::cout << "resolution,unit,conversion,path,reference_ns,fast_ns,speedup,differences"
+            << std::endl;
+  // Years and days can't be resolutions: the units would overflow.
+  for (int r = Time::H; r < Time::LAST; r++)
+    {
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("fork failed");
+        }
+      if (pid == 0)
+        {
+          RunResolution (static_cast<Time::Unit> (r), count, repeat);
+          std::cout.flush ();
+          _exit (0);
+        }
+      int status;
+      waitpid (pid, &status, 0);
+      if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        {
+          std::cerr << "resolution " << g_unitNames[r] << " failed" << std::endl;
+        }
+    }
+  return 0;
+}
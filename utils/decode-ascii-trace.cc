@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup utils
+ * Regenerate the ascii text of a binary trace written through
+ * AsciiTraceHelper::CreateBinaryFileStream.
+ *
+ * The program links every enabled module, so that the headers and
+ * trailers of the traced packets can be printed.
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "ns3/binary-trace-stream-wrapper.h"
+#include "ns3/command-line.h"
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string input;
+  std::string output;
+
+  CommandLine cmd;
+  cmd.Usage ("Regenerate the ascii text of a binary ascii trace.");
+  cmd.AddValue ("input", "the binary trace file", input);
+  cmd.AddValue ("output", "the ascii trace file to write (default: standard output)", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "No --input file given" << std::endl;
+      return 1;
+    }
+  std::ifstream is (input.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      std::cerr << "Unable to open " << input << std::endl;
+      return 1;
+    }
+
+  std::ofstream file;
+  std::ostream *os = &std::cout;
+  if (!output.empty ())
+    {
+      file.open (output.c_str ());
+      if (!file.is_open ())
+        {
+          std::cerr << "Unable to open " << output << std::endl;
+          return 1;
+        }
+      os = &file;
+    }
+
+  if (!BinaryTraceStreamWrapper::Decode (is, *os))
+    {
+      std::cerr << input << " is not a binary ascii trace, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}